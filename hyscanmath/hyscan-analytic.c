@@ -0,0 +1,491 @@
+/* hyscan-analytic.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+/**
+ * SECTION: hyscan-analytic
+ * @Short_description: класс расчёта аналитического сигнала
+ * @Title: HyScanAnalytic
+ *
+ * Класс предназначен для расчёта аналитического сигнала по действительным
+ * отсчётам. Действительная часть аналитического сигнала совпадает с входным
+ * сигналом, а мнимая часть является его преобразованием Гильберта. Модуль
+ * аналитического сигнала - огибающая, а аргумент - мгновенная фаза сигнала.
+ *
+ * Создание объекта производится с помощью функции #hyscan_analytic_new.
+ *
+ * Функция #hyscan_analytic_transform рассчитывает аналитический сигнал для
+ * строки целиком: спектр строки рассчитывается одним преобразованием Фурье,
+ * отрицательные частоты обнуляются, положительные удваиваются, после чего
+ * выполняется обратное преобразование. Размер преобразования выбирается
+ * функцией #hyscan_fft_get_transform_size, строка дополняется нулями.
+ *
+ * Функция #hyscan_analytic_process рассчитывает аналитический сигнал
+ * для потока данных, передаваемого частями произвольного размера. В этом
+ * случае используется КИХ фильтр, рассчитываемый с помощью окна Кайзера,
+ * а свёртка с ним выполняется в частотной области методом перекрытия с
+ * накоплением. Длина фильтра задаётся функцией
+ * #hyscan_analytic_set_filter_length: чем длиннее фильтр, тем ближе к
+ * нулевой частоте и к частоте Найквиста начинается рабочая полоса. Фильтр
+ * вносит задержку, которую можно узнать функцией #hyscan_analytic_get_delay.
+ * Число выходных отсчётов всегда равно числу входных. Сброс состояния
+ * производится функцией #hyscan_analytic_reset.
+ *
+ * В обоих случаях умножение спектра на маску совмещено с переходом от
+ * спектра действительного сигнала к спектру комплексного: результат прямого
+ * преобразования читается, а вход обратного преобразования записывается
+ * во внутреннем порядке библиотеки БПФ по заранее рассчитанным таблицам
+ * перестановок, поэтому дополнительных проходов для упорядочивания спектра
+ * не требуется.
+ */
+
+#include "hyscan-analytic.h"
+#include "hyscan-fft.h"
+#include "hyscan-fir-design.h"
+#include "pffft.h"
+#include <string.h>
+
+/* Длина фильтра по умолчанию. */
+#define HYSCAN_ANALYTIC_DEFAULT_TAPS   255
+
+/* Максимальная длина фильтра. */
+#define HYSCAN_ANALYTIC_MAX_TAPS       65535
+
+/* Подавление отрицательных частот фильтром, дБ. */
+#define HYSCAN_ANALYTIC_ATTENUATION    80.0
+
+/* План расчёта аналитического сигнала для одного размера преобразования. */
+typedef struct
+{
+  guint32                      fft_size;       /* Размер преобразования. */
+  PFFFT_Setup                 *real;           /* Прямое преобразование действительных данных. */
+  PFFFT_Setup                 *complex;        /* Обратное преобразование комплексных данных. */
+  guint32                     *real_order;     /* Позиции упорядоченного спектра действительных данных. */
+  guint32                     *complex_order;  /* Позиции упорядоченного спектра комплексных данных. */
+  HyScanComplexFloat          *mask;           /* Упорядоченная маска спектра с учётом нормировки. */
+  gfloat                      *input;          /* Входные данные. */
+  gfloat                      *spectrum;       /* Спектр действительных данных. */
+  gfloat                      *output;         /* Комплексный спектр и результат. */
+  gfloat                      *work;           /* Рабочий буфер. */
+} HyScanAnalyticPlan;
+
+struct _HyScanAnalyticPrivate
+{
+  HyScanAnalyticPlan          *line;           /* План для строк целиком. */
+  HyScanAnalyticPlan          *stream;         /* План для потока данных. */
+  guint32                      n_taps;         /* Длина фильтра для потока данных. */
+};
+
+static void                 hyscan_analytic_object_constructed (GObject                *object);
+static void                 hyscan_analytic_object_finalize    (GObject                *object);
+
+static HyScanAnalyticPlan * hyscan_analytic_plan_new           (guint32                 fft_size);
+
+static void                 hyscan_analytic_plan_free          (HyScanAnalyticPlan     *plan);
+
+static void                 hyscan_analytic_plan_execute       (HyScanAnalyticPlan     *plan);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanAnalytic, hyscan_analytic, G_TYPE_OBJECT)
+
+static void
+hyscan_analytic_class_init (HyScanAnalyticClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_analytic_object_constructed;
+  object_class->finalize = hyscan_analytic_object_finalize;
+}
+
+static void
+hyscan_analytic_init (HyScanAnalytic *analytic)
+{
+  analytic->priv = hyscan_analytic_get_instance_private (analytic);
+}
+
+static void
+hyscan_analytic_object_constructed (GObject *object)
+{
+  HyScanAnalytic *analytic = HYSCAN_ANALYTIC (object);
+
+  hyscan_analytic_set_filter_length (analytic, HYSCAN_ANALYTIC_DEFAULT_TAPS);
+}
+
+static void
+hyscan_analytic_object_finalize (GObject *object)
+{
+  HyScanAnalytic *analytic = HYSCAN_ANALYTIC (object);
+  HyScanAnalyticPrivate *priv = analytic->priv;
+
+  g_clear_pointer (&priv->line, hyscan_analytic_plan_free);
+  g_clear_pointer (&priv->stream, hyscan_analytic_plan_free);
+
+  G_OBJECT_CLASS (hyscan_analytic_parent_class)->finalize (object);
+}
+
+/* Функция создаёт план расчёта. Таблицы перестановок получаются
+ * упорядочиванием массива, каждый элемент которого равен своему индексу
+ * во внутреннем порядке библиотеки БПФ. */
+static HyScanAnalyticPlan *
+hyscan_analytic_plan_new (guint32 fft_size)
+{
+  HyScanAnalyticPlan *plan;
+  guint32 i;
+
+  plan = g_new0 (HyScanAnalyticPlan, 1);
+  plan->fft_size = fft_size;
+  plan->real = pffft_new_setup (fft_size, PFFFT_REAL);
+  plan->complex = pffft_new_setup (fft_size, PFFFT_COMPLEX);
+
+  if ((plan->real == NULL) || (plan->complex == NULL))
+    {
+      g_warning ("HyScanAnalytic: can't setup fft");
+      hyscan_analytic_plan_free (plan);
+      return NULL;
+    }
+
+  plan->input = pffft_aligned_malloc (fft_size * sizeof (gfloat));
+  plan->spectrum = pffft_aligned_malloc (fft_size * sizeof (gfloat));
+  plan->output = pffft_aligned_malloc (2 * fft_size * sizeof (gfloat));
+  plan->work = pffft_aligned_malloc (2 * fft_size * sizeof (gfloat));
+  plan->mask = g_new0 (HyScanComplexFloat, fft_size);
+
+  plan->real_order = g_new (guint32, fft_size);
+  plan->complex_order = g_new (guint32, 2 * fft_size);
+
+  for (i = 0; i < fft_size; i++)
+    plan->input[i] = i;
+  pffft_zreorder (plan->real, plan->input, plan->spectrum, PFFFT_FORWARD);
+  for (i = 0; i < fft_size; i++)
+    plan->real_order[i] = plan->spectrum[i];
+
+  for (i = 0; i < 2 * fft_size; i++)
+    plan->work[i] = i;
+  pffft_zreorder (plan->complex, plan->work, plan->output, PFFFT_FORWARD);
+  for (i = 0; i < 2 * fft_size; i++)
+    plan->complex_order[i] = plan->output[i];
+
+  return plan;
+}
+
+/* Функция освобождает план расчёта. */
+static void
+hyscan_analytic_plan_free (HyScanAnalyticPlan *plan)
+{
+  g_clear_pointer (&plan->real, pffft_destroy_setup);
+  g_clear_pointer (&plan->complex, pffft_destroy_setup);
+
+  pffft_aligned_free (plan->input);
+  pffft_aligned_free (plan->spectrum);
+  pffft_aligned_free (plan->output);
+  pffft_aligned_free (plan->work);
+
+  g_free (plan->mask);
+  g_free (plan->real_order);
+  g_free (plan->complex_order);
+  g_free (plan);
+}
+
+/* Функция рассчитывает аналитический сигнал для данных в буфере input.
+ * Спектр действительных данных X[k] для отрицательных частот равен
+ * комплексно сопряжённому спектру положительных частот, поэтому
+ * комплексный спектр результата Y[k] = X[k] * mask[k] и
+ * Y[N - k] = conj (X[k]) * mask[N - k] рассчитывается за один проход. */
+static void
+hyscan_analytic_plan_execute (HyScanAnalyticPlan *plan)
+{
+  const guint32 *ro = plan->real_order;
+  const guint32 *co = plan->complex_order;
+  const HyScanComplexFloat *mask = plan->mask;
+  const gfloat *x = plan->spectrum;
+  gfloat *y = plan->output;
+  guint32 n = plan->fft_size;
+  guint32 half = n / 2;
+  guint32 k;
+
+  pffft_transform (plan->real, plan->input, plan->spectrum, plan->work, PFFFT_FORWARD);
+
+  /* Нулевая частота и частота Найквиста. */
+  y[co[0]] = x[ro[0]] * mask[0].re;
+  y[co[1]] = x[ro[0]] * mask[0].im;
+  y[co[2 * half]] = x[ro[1]] * mask[half].re;
+  y[co[2 * half + 1]] = x[ro[1]] * mask[half].im;
+
+  for (k = 1; k < half; k++)
+    {
+      gfloat re = x[ro[2 * k]];
+      gfloat im = x[ro[2 * k + 1]];
+      const HyScanComplexFloat *mp = &mask[k];
+      const HyScanComplexFloat *mn = &mask[n - k];
+
+      y[co[2 * k]] = re * mp->re - im * mp->im;
+      y[co[2 * k + 1]] = re * mp->im + im * mp->re;
+      y[co[2 * (n - k)]] = re * mn->re + im * mn->im;
+      y[co[2 * (n - k) + 1]] = re * mn->im - im * mn->re;
+    }
+
+  pffft_transform (plan->complex, plan->output, plan->output, plan->work, PFFFT_BACKWARD);
+}
+
+/**
+ * hyscan_analytic_new:
+ *
+ * Функция создаёт новый объект #HyScanAnalytic.
+ *
+ * Returns: #HyScanAnalytic. Для удаления #g_object_unref.
+ */
+HyScanAnalytic *
+hyscan_analytic_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_ANALYTIC, NULL);
+}
+
+/**
+ * hyscan_analytic_transform:
+ * @analytic: указатель на #HyScanAnalytic
+ * @data: (array length=n_points) (transfer none): действительные данные
+ * @output: (out) (array length=n_points) (transfer none): буфер для результата
+ * @n_points: размер данных в точках
+ *
+ * Функция рассчитывает аналитический сигнал для строки данных целиком.
+ *
+ * Returns: %TRUE если расчёт выполнен, иначе %FALSE.
+ */
+gboolean
+hyscan_analytic_transform (HyScanAnalytic     *analytic,
+                           const gfloat       *data,
+                           HyScanComplexFloat *output,
+                           guint32             n_points)
+{
+  HyScanAnalyticPrivate *priv;
+  HyScanAnalyticPlan *plan;
+  guint32 fft_size;
+  guint32 k;
+
+  g_return_val_if_fail (HYSCAN_IS_ANALYTIC (analytic), FALSE);
+
+  priv = analytic->priv;
+
+  fft_size = hyscan_fft_get_transform_size (n_points);
+  if (fft_size == 0)
+    {
+      g_warning ("HyScanAnalytic: incorrect size fft");
+      return FALSE;
+    }
+
+  /* Маска обнуляет отрицательные частоты и удваивает положительные. */
+  if ((priv->line == NULL) || (priv->line->fft_size != fft_size))
+    {
+      g_clear_pointer (&priv->line, hyscan_analytic_plan_free);
+
+      priv->line = hyscan_analytic_plan_new (fft_size);
+      if (priv->line == NULL)
+        return FALSE;
+
+      priv->line->mask[0].re = 1.0 / fft_size;
+      priv->line->mask[fft_size / 2].re = 1.0 / fft_size;
+      for (k = 1; k < fft_size / 2; k++)
+        priv->line->mask[k].re = 2.0 / fft_size;
+    }
+
+  plan = priv->line;
+
+  memcpy (plan->input, data, n_points * sizeof (gfloat));
+  memset (plan->input + n_points, 0, (fft_size - n_points) * sizeof (gfloat));
+
+  hyscan_analytic_plan_execute (plan);
+
+  memcpy (output, plan->output, n_points * sizeof (HyScanComplexFloat));
+
+  return TRUE;
+}
+
+/**
+ * hyscan_analytic_set_filter_length:
+ * @analytic: указатель на #HyScanAnalytic
+ * @n_taps: длина фильтра
+ *
+ * Функция задаёт длину фильтра для расчёта аналитического сигнала потока
+ * данных и сбрасывает состояние потока. Чётная длина увеличивается на
+ * единицу. По умолчанию используется фильтр длиной 255 отсчётов, рабочая
+ * полоса которого составляет примерно от 0.02 до 0.48 частоты
+ * дискретизации.
+ *
+ * Returns: %TRUE если длина фильтра установлена, иначе %FALSE.
+ */
+gboolean
+hyscan_analytic_set_filter_length (HyScanAnalytic *analytic,
+                                   guint32         n_taps)
+{
+  HyScanAnalyticPrivate *priv;
+  HyScanAnalyticPlan *plan;
+  HyScanComplexFloat *h;
+  gdouble *lowpass;
+  guint32 center;
+  guint32 i;
+
+  g_return_val_if_fail (HYSCAN_IS_ANALYTIC (analytic), FALSE);
+
+  priv = analytic->priv;
+
+  n_taps |= 1;
+  if ((n_taps < 3) || (n_taps > HYSCAN_ANALYTIC_MAX_TAPS))
+    {
+      g_warning ("HyScanAnalytic: incorrect filter length");
+      return FALSE;
+    }
+
+  plan = hyscan_analytic_plan_new (hyscan_fft_get_transform_size (4 * n_taps));
+  if (plan == NULL)
+    return FALSE;
+
+  g_clear_pointer (&priv->stream, hyscan_analytic_plan_free);
+  priv->stream = plan;
+  priv->n_taps = n_taps;
+
+  /* Фильтр - полуполосный ФНЧ, сдвинутый на четверть частоты дискретизации.
+   * Коэффициенты с чётным смещением от центра, кроме центрального, равны
+   * нулю, а коэффициенты с нечётным смещением - мнимые. */
+  center = (n_taps - 1) / 2;
+  lowpass = hyscan_fir_design_lowpass (n_taps, 0.25, HYSCAN_ANALYTIC_ATTENUATION);
+  h = (HyScanComplexFloat *) plan->output;
+  memset (h, 0, plan->fft_size * sizeof (HyScanComplexFloat));
+
+  h[center].re = 1.0;
+  for (i = 1; i <= center; i += 2)
+    {
+      gdouble value = 2.0 * lowpass[center + i] * ((i % 4 == 1) ? 1.0 : -1.0);
+
+      h[center + i].im = value;
+      h[center - i].im = -value;
+    }
+
+  g_free (lowpass);
+
+  pffft_transform_ordered (plan->complex, plan->output, plan->output, plan->work, PFFFT_FORWARD);
+  for (i = 0; i < plan->fft_size; i++)
+    {
+      plan->mask[i].re = h[i].re / plan->fft_size;
+      plan->mask[i].im = h[i].im / plan->fft_size;
+    }
+
+  hyscan_analytic_reset (analytic);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_analytic_get_delay:
+ * @analytic: указатель на #HyScanAnalytic
+ *
+ * Функция возвращает задержку, вносимую фильтром при расчёте аналитического
+ * сигнала потока данных. Выходной отсчёт с номером n соответствует входному
+ * отсчёту с номером n - delay.
+ *
+ * Returns: Задержка в отсчётах.
+ */
+guint32
+hyscan_analytic_get_delay (HyScanAnalytic *analytic)
+{
+  g_return_val_if_fail (HYSCAN_IS_ANALYTIC (analytic), 0);
+
+  return (analytic->priv->n_taps - 1) / 2;
+}
+
+/**
+ * hyscan_analytic_process:
+ * @analytic: указатель на #HyScanAnalytic
+ * @data: (array length=n_points) (transfer none): действительные данные
+ * @output: (out) (array length=n_points) (transfer none): буфер для результата
+ * @n_points: размер данных в точках
+ *
+ * Функция рассчитывает аналитический сигнал для очередной части потока
+ * данных. Каждое преобразование обрабатывает последние n_taps - 1 отсчётов
+ * предыдущей части и до fft_size - n_taps + 1 новых отсчётов.
+ *
+ * Returns: %TRUE если расчёт выполнен, иначе %FALSE.
+ */
+gboolean
+hyscan_analytic_process (HyScanAnalytic     *analytic,
+                         const gfloat       *data,
+                         HyScanComplexFloat *output,
+                         guint32             n_points)
+{
+  HyScanAnalyticPlan *plan;
+  guint32 n_history;
+  guint32 hop;
+  guint32 offset;
+
+  g_return_val_if_fail (HYSCAN_IS_ANALYTIC (analytic), FALSE);
+
+  plan = analytic->priv->stream;
+  n_history = analytic->priv->n_taps - 1;
+  hop = plan->fft_size - n_history;
+
+  /* Перед новыми отсчётами в буфере хранятся последние отсчёты предыдущих
+   * данных. Если новых отсчётов меньше, чем помещается в буфер, буфер
+   * дополняется нулями: на результат в позициях новых отсчётов они не
+   * влияют. */
+  for (offset = 0; offset < n_points; offset += hop)
+    {
+      guint32 n = MIN (hop, n_points - offset);
+
+      memcpy (plan->input + n_history, data + offset, n * sizeof (gfloat));
+      memset (plan->input + n_history + n, 0, (hop - n) * sizeof (gfloat));
+
+      hyscan_analytic_plan_execute (plan);
+
+      memcpy (output + offset, (HyScanComplexFloat *) plan->output + n_history,
+              n * sizeof (HyScanComplexFloat));
+      memmove (plan->input, plan->input + n, n_history * sizeof (gfloat));
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_analytic_reset:
+ * @analytic: указатель на #HyScanAnalytic
+ *
+ * Функция сбрасывает состояние потока данных.
+ */
+void
+hyscan_analytic_reset (HyScanAnalytic *analytic)
+{
+  HyScanAnalyticPlan *plan;
+
+  g_return_if_fail (HYSCAN_IS_ANALYTIC (analytic));
+
+  plan = analytic->priv->stream;
+  memset (plan->input, 0, plan->fft_size * sizeof (gfloat));
+}
@@ -0,0 +1,96 @@
+/* hyscan-analytic.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_ANALYTIC_H__
+#define __HYSCAN_ANALYTIC_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_ANALYTIC             (hyscan_analytic_get_type ())
+#define HYSCAN_ANALYTIC(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_ANALYTIC, HyScanAnalytic))
+#define HYSCAN_IS_ANALYTIC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_ANALYTIC))
+#define HYSCAN_ANALYTIC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_ANALYTIC, HyScanAnalyticClass))
+#define HYSCAN_IS_ANALYTIC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_ANALYTIC))
+#define HYSCAN_ANALYTIC_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_ANALYTIC, HyScanAnalyticClass))
+
+typedef struct _HyScanAnalytic HyScanAnalytic;
+typedef struct _HyScanAnalyticPrivate HyScanAnalyticPrivate;
+typedef struct _HyScanAnalyticClass HyScanAnalyticClass;
+
+struct _HyScanAnalytic
+{
+  GObject parent_instance;
+
+  HyScanAnalyticPrivate *priv;
+};
+
+struct _HyScanAnalyticClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_analytic_get_type                (void);
+
+HYSCAN_API
+HyScanAnalytic *       hyscan_analytic_new                     (void);
+
+HYSCAN_API
+gboolean               hyscan_analytic_transform               (HyScanAnalytic           *analytic,
+                                                                const gfloat             *data,
+                                                                HyScanComplexFloat       *output,
+                                                                guint32                   n_points);
+
+HYSCAN_API
+gboolean               hyscan_analytic_set_filter_length       (HyScanAnalytic           *analytic,
+                                                                guint32                   n_taps);
+
+HYSCAN_API
+guint32                hyscan_analytic_get_delay               (HyScanAnalytic           *analytic);
+
+HYSCAN_API
+gboolean               hyscan_analytic_process                 (HyScanAnalytic           *analytic,
+                                                                const gfloat             *data,
+                                                                HyScanComplexFloat       *output,
+                                                                guint32                   n_points);
+
+HYSCAN_API
+void                   hyscan_analytic_reset                   (HyScanAnalytic           *analytic);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_ANALYTIC_H__ */
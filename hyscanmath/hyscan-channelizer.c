@@ -0,0 +1,669 @@
+/* hyscan-channelizer.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+/**
+ * SECTION: hyscan-channelizer
+ * @Short_description: класс разделения комплексных данных на частотные каналы
+ * @Title: HyScanChannelizer
+ *
+ * Класс предназначен для разделения комплексных данных на M частотных
+ * каналов с равномерно расположенными центральными частотами, например
+ * для выделения рабочих полос многочастотных гидролокаторов из общего
+ * потока данных АЦП. Данные каждого канала переносятся на нулевую частоту
+ * и прореживаются в M раз, т.е. частота дискретизации данных канала равна
+ * data_rate / M.
+ *
+ * Создание объекта производится с помощью функции #hyscan_channelizer_new.
+ * Число каналов и число коэффициентов фильтра на один канал задаются
+ * функцией #hyscan_channelizer_configure. Центральная частота канала k
+ * равна k * data_rate / M, для каналов с номерами больше M / 2 она
+ * отсчитывается в отрицательную сторону и может быть получена функцией
+ * #hyscan_channelizer_get_frequency.
+ *
+ * Разделение производится полифазным банком фильтров: входные отсчёты
+ * распределяются по M ветвям фильтра-прототипа, после чего выходные
+ * отсчёты всех каналов получаются M-точечным преобразованием Фурье
+ * результатов ветвей. Фильтр-прототип - фильтр нижних частот с окном
+ * Кайзера и частотой среза data_rate / (2 * M), подавление в полосе
+ * заграждения - 80 дБ. Ширина переходной полосы обратно пропорциональна
+ * числу коэффициентов на канал: при 16 коэффициентах полоса пропускания
+ * канала составляет около +/- 0.34 его частоты дискретизации.
+ *
+ * По умолчанию рассчитываются все каналы. Функцией
+ * #hyscan_channelizer_set_channels можно выбрать только нужные каналы,
+ * например два или три канала рабочих частот гидролокатора. Если число
+ * выбранных каналов мало, или число каналов не подходит для быстрого
+ * преобразования Фурье, выходные отсчёты выбранных каналов рассчитываются
+ * непосредственно, без расчёта остальных каналов.
+ *
+ * Обработка данных производится функцией #hyscan_channelizer_process.
+ * Состояние фильтра сохраняется между вызовами, поэтому данные можно
+ * передавать частями произвольного размера. Число выходных отсчётов для
+ * следующего вызова можно узнать функцией #hyscan_channelizer_get_output_size,
+ * а задержку, вносимую фильтром, - функцией #hyscan_channelizer_get_delay.
+ */
+
+#include "hyscan-channelizer.h"
+#include "hyscan-fir-design.h"
+#include "pffft.h"
+#include <string.h>
+#include <math.h>
+
+/* Максимальное число входных отсчётов, обрабатываемых за один проход. */
+#define HYSCAN_CHANNELIZER_CHUNK_SIZE  4096
+
+/* Число независимых сумм при расчёте ветвей фильтра. */
+#define HYSCAN_CHANNELIZER_LANES       8
+
+/* Подавление в полосе заграждения, дБ. */
+#define HYSCAN_CHANNELIZER_ATTENUATION 80.0
+
+/* Максимальное число каналов. */
+#define HYSCAN_CHANNELIZER_MAX_CHANNELS 1024
+
+/* Максимальное число коэффициентов фильтра на один канал. */
+#define HYSCAN_CHANNELIZER_MAX_TAPS    256
+
+struct _HyScanChannelizerPrivate
+{
+  guint                        n_channels;     /* Число каналов. */
+  guint                        length;         /* Длина фильтра-прототипа. */
+  gfloat                      *taps;           /* Коэффициенты фильтра-прототипа. */
+
+  gfloat                      *buffer;         /* Входные отсчёты. */
+  guint32                      n_points;       /* Число входных отсчётов в буфере. */
+
+  PFFFT_Setup                 *fft;            /* Параметры преобразования Фурье. */
+  gfloat                      *branches;       /* Результаты ветвей фильтра. */
+  gfloat                      *spectrum;       /* Спектр результатов ветвей. */
+  gfloat                      *work;           /* Рабочий буфер преобразования Фурье. */
+  guint32                     *order;          /* Позиции упорядоченного спектра. */
+
+  guint                       *channels;       /* Номера выбранных каналов. */
+  guint                        n_selected;     /* Число выбранных каналов. */
+  gboolean                     use_fft;        /* Признак расчёта каналов через БПФ. */
+  HyScanComplexFloat          *rotation;       /* Коррекция фазы каналов для БПФ. */
+  HyScanComplexFloat          *twiddles;       /* Коэффициенты прямого расчёта каналов. */
+};
+
+static void    hyscan_channelizer_object_finalize      (GObject                     *object);
+
+static void    hyscan_channelizer_clear                (HyScanChannelizerPrivate    *priv);
+
+static gboolean hyscan_channelizer_fft_size_valid      (guint                        size);
+
+static void    hyscan_channelizer_select               (HyScanChannelizerPrivate    *priv,
+                                                        const guint                 *channels,
+                                                        guint                        n_selected);
+
+static guint32 hyscan_channelizer_process_buffer       (HyScanChannelizerPrivate    *priv,
+                                                        HyScanComplexFloat *const   *output,
+                                                        guint32                      offset);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanChannelizer, hyscan_channelizer, G_TYPE_OBJECT)
+
+static void
+hyscan_channelizer_class_init (HyScanChannelizerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_channelizer_object_finalize;
+}
+
+static void
+hyscan_channelizer_init (HyScanChannelizer *channelizer)
+{
+  channelizer->priv = hyscan_channelizer_get_instance_private (channelizer);
+}
+
+static void
+hyscan_channelizer_object_finalize (GObject *object)
+{
+  HyScanChannelizer *channelizer = HYSCAN_CHANNELIZER (object);
+
+  hyscan_channelizer_clear (channelizer->priv);
+
+  G_OBJECT_CLASS (hyscan_channelizer_parent_class)->finalize (object);
+}
+
+/* Функция освобождает память, используемую объектом. */
+static void
+hyscan_channelizer_clear (HyScanChannelizerPrivate *priv)
+{
+  g_clear_pointer (&priv->fft, pffft_destroy_setup);
+
+  pffft_aligned_free (priv->branches);
+  pffft_aligned_free (priv->spectrum);
+  pffft_aligned_free (priv->work);
+  priv->branches = NULL;
+  priv->spectrum = NULL;
+  priv->work = NULL;
+
+  g_clear_pointer (&priv->taps, g_free);
+  g_clear_pointer (&priv->buffer, g_free);
+  g_clear_pointer (&priv->order, g_free);
+  g_clear_pointer (&priv->channels, g_free);
+  g_clear_pointer (&priv->rotation, g_free);
+  g_clear_pointer (&priv->twiddles, g_free);
+
+  priv->n_channels = 0;
+  priv->n_selected = 0;
+}
+
+/* Функция проверяет, что размер подходит для комплексного преобразования
+ * Фурье PFFFT: он должен быть кратен 16 и раскладываться на множители
+ * 2, 3 и 5. */
+static gboolean
+hyscan_channelizer_fft_size_valid (guint size)
+{
+  if ((size % 16) != 0)
+    return FALSE;
+
+  while ((size % 2) == 0)
+    size /= 2;
+  while ((size % 3) == 0)
+    size /= 3;
+  while ((size % 5) == 0)
+    size /= 5;
+
+  return (size == 1);
+}
+
+/* Функция выбирает каналы для расчёта и способ их расчёта. Преобразование
+ * Фурье требует порядка log2 (M) операций на канал, прямой расчёт - одной
+ * операции на канал и ветвь фильтра, поэтому преобразование Фурье
+ * используется, если число выбранных каналов больше log2 (M).
+ *
+ * Выходной отсчёт канала k равен сумме результатов ветвей u[j], умноженных
+ * на exp (-i * 2 * pi * k * (j + 1) / M). Через прямое преобразование
+ * Фурье эта сумма выражается как U[k] * exp (-i * 2 * pi * k / M). */
+static void
+hyscan_channelizer_select (HyScanChannelizerPrivate *priv,
+                           const guint              *channels,
+                           guint                     n_selected)
+{
+  guint n_channels = priv->n_channels;
+  guint s, j;
+
+  g_clear_pointer (&priv->channels, g_free);
+  g_clear_pointer (&priv->rotation, g_free);
+  g_clear_pointer (&priv->twiddles, g_free);
+
+  priv->n_selected = n_selected;
+  priv->channels = g_new (guint, n_selected);
+  for (s = 0; s < n_selected; s++)
+    priv->channels[s] = (channels != NULL) ? channels[s] : s;
+
+  priv->use_fft = (priv->fft != NULL) && (n_selected > g_bit_storage (n_channels));
+
+  if (priv->use_fft)
+    {
+      priv->rotation = g_new (HyScanComplexFloat, n_selected);
+      for (s = 0; s < n_selected; s++)
+        {
+          gdouble phase = -2.0 * G_PI * priv->channels[s] / n_channels;
+
+          priv->rotation[s].re = cos (phase);
+          priv->rotation[s].im = sin (phase);
+        }
+    }
+  else
+    {
+      priv->twiddles = g_new (HyScanComplexFloat, n_selected * n_channels);
+      for (s = 0; s < n_selected; s++)
+        {
+          HyScanComplexFloat *twiddles = priv->twiddles + s * n_channels;
+
+          for (j = 0; j < n_channels; j++)
+            {
+              guint64 index = ((guint64) priv->channels[s] * (j + 1)) % n_channels;
+              gdouble phase = -2.0 * G_PI * index / n_channels;
+
+              twiddles[j].re = cos (phase);
+              twiddles[j].im = sin (phase);
+            }
+        }
+    }
+}
+
+/* Функция рассчитывает выходные отсчёты выбранных каналов по накопленным
+ * входным отсчётам и удаляет из буфера отсчёты, которые больше не
+ * понадобятся. Выходной отсчёт рассчитывается для каждых M входных
+ * отсчётов по окну из length последних отсчётов.
+ *
+ * Коэффициенты фильтра-прототипа хранятся в обратном порядке и
+ * продублированы для действительной и мнимой частей, поэтому результат
+ * ветви j является суммой произведений отсчётов окна с номерами j, j + M,
+ * j + 2M и т.д. на соответствующие коэффициенты. Суммы рассчитываются
+ * группами по HYSCAN_CHANNELIZER_LANES ветвей, цикл по которым
+ * векторизуется. */
+static guint32
+hyscan_channelizer_process_buffer (HyScanChannelizerPrivate  *priv,
+                                   HyScanComplexFloat *const *output,
+                                   guint32                    offset)
+{
+  guint n_channels = priv->n_channels;
+  guint width = 2 * n_channels;
+  guint n_rows = priv->length / n_channels;
+  guint32 n_out = 0;
+  guint32 start;
+  guint s;
+
+  for (start = 0; start + priv->length <= priv->n_points; start += n_channels)
+    {
+      const gfloat *x = priv->buffer + 2 * start;
+      gfloat *u = priv->branches;
+      guint i, l, r;
+
+      /* Ветви фильтра. */
+      for (i = 0; i + HYSCAN_CHANNELIZER_LANES <= width; i += HYSCAN_CHANNELIZER_LANES)
+        {
+          gfloat acc[HYSCAN_CHANNELIZER_LANES] = {0.0f};
+
+          for (r = 0; r < n_rows; r++)
+            {
+              const gfloat *taps = priv->taps + r * width + i;
+              const gfloat *data = x + r * width + i;
+
+              for (l = 0; l < HYSCAN_CHANNELIZER_LANES; l++)
+                acc[l] += taps[l] * data[l];
+            }
+
+          for (l = 0; l < HYSCAN_CHANNELIZER_LANES; l++)
+            u[i + l] = acc[l];
+        }
+
+      for (; i < width; i++)
+        {
+          gfloat acc = 0.0f;
+
+          for (r = 0; r < n_rows; r++)
+            acc += priv->taps[r * width + i] * x[r * width + i];
+
+          u[i] = acc;
+        }
+
+      /* Выходные отсчёты каналов. */
+      if (priv->use_fft)
+        {
+          pffft_transform (priv->fft, u, priv->spectrum, priv->work, PFFFT_FORWARD);
+
+          for (s = 0; s < priv->n_selected; s++)
+            {
+              guint k = priv->channels[s];
+              gfloat re = priv->spectrum[priv->order[2 * k]];
+              gfloat im = priv->spectrum[priv->order[2 * k + 1]];
+              HyScanComplexFloat *rotation = &priv->rotation[s];
+              HyScanComplexFloat *out = &output[s][offset + n_out];
+
+              out->re = re * rotation->re - im * rotation->im;
+              out->im = re * rotation->im + im * rotation->re;
+            }
+        }
+      else
+        {
+          for (s = 0; s < priv->n_selected; s++)
+            {
+              const HyScanComplexFloat *twiddles = priv->twiddles + s * n_channels;
+              gfloat re = 0.0f;
+              gfloat im = 0.0f;
+              guint j;
+
+              for (j = 0; j < n_channels; j++)
+                {
+                  re += u[2 * j] * twiddles[j].re - u[2 * j + 1] * twiddles[j].im;
+                  im += u[2 * j] * twiddles[j].im + u[2 * j + 1] * twiddles[j].re;
+                }
+
+              output[s][offset + n_out].re = re;
+              output[s][offset + n_out].im = im;
+            }
+        }
+
+      n_out++;
+    }
+
+  /* Удаляем использованные отсчёты. */
+  memmove (priv->buffer, priv->buffer + 2 * start, 2 * (priv->n_points - start) * sizeof (gfloat));
+  priv->n_points -= start;
+
+  return n_out;
+}
+
+/**
+ * hyscan_channelizer_new:
+ *
+ * Функция создаёт новый объект #HyScanChannelizer.
+ *
+ * Returns: #HyScanChannelizer. Для удаления #g_object_unref.
+ */
+HyScanChannelizer *
+hyscan_channelizer_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_CHANNELIZER, NULL);
+}
+
+/**
+ * hyscan_channelizer_configure:
+ * @channelizer: указатель на #HyScanChannelizer
+ * @n_channels: число каналов
+ * @n_taps: число коэффициентов фильтра на один канал
+ *
+ * Функция задаёт число каналов и длину фильтра-прототипа, равную
+ * n_channels * n_taps, и сбрасывает состояние объекта. Число каналов
+ * должно быть от 2 до 1024, число коэффициентов на канал - от 2 до 256.
+ * Преобразование Фурье используется, если число каналов кратно 16 и
+ * раскладывается на множители 2, 3 и 5. После настройки выбраны все каналы.
+ *
+ * Returns: %TRUE если параметры установлены, иначе %FALSE.
+ */
+gboolean
+hyscan_channelizer_configure (HyScanChannelizer *channelizer,
+                              guint              n_channels,
+                              guint              n_taps)
+{
+  HyScanChannelizerPrivate *priv;
+  gdouble *h;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), FALSE);
+
+  priv = channelizer->priv;
+
+  if ((n_channels < 2) || (n_channels > HYSCAN_CHANNELIZER_MAX_CHANNELS))
+    {
+      g_warning ("HyScanChannelizer: incorrect number of channels %u", n_channels);
+      return FALSE;
+    }
+
+  if ((n_taps < 2) || (n_taps > HYSCAN_CHANNELIZER_MAX_TAPS))
+    {
+      g_warning ("HyScanChannelizer: incorrect number of taps %u", n_taps);
+      return FALSE;
+    }
+
+  hyscan_channelizer_clear (priv);
+
+  priv->n_channels = n_channels;
+  priv->length = n_channels * n_taps;
+
+  /* Фильтр-прототип в обратном порядке, коэффициенты продублированы для
+   * действительной и мнимой частей отсчётов. */
+  h = hyscan_fir_design_lowpass (priv->length, 0.5 / n_channels, HYSCAN_CHANNELIZER_ATTENUATION);
+  priv->taps = g_new (gfloat, 2 * priv->length);
+  for (i = 0; i < priv->length; i++)
+    {
+      priv->taps[2 * i] = h[priv->length - 1 - i];
+      priv->taps[2 * i + 1] = h[priv->length - 1 - i];
+    }
+  g_free (h);
+
+  priv->buffer = g_new (gfloat, 2 * (priv->length + HYSCAN_CHANNELIZER_CHUNK_SIZE));
+  priv->branches = pffft_aligned_malloc (2 * n_channels * sizeof (gfloat));
+
+  if (hyscan_channelizer_fft_size_valid (n_channels))
+    {
+      priv->fft = pffft_new_setup (n_channels, PFFFT_COMPLEX);
+      priv->spectrum = pffft_aligned_malloc (2 * n_channels * sizeof (gfloat));
+      priv->work = pffft_aligned_malloc (2 * n_channels * sizeof (gfloat));
+
+      /* Позиции отсчётов упорядоченного спектра во внутреннем порядке PFFFT. */
+      priv->order = g_new (guint32, 2 * n_channels);
+      for (i = 0; i < 2 * n_channels; i++)
+        priv->work[i] = i;
+      pffft_zreorder (priv->fft, priv->work, priv->spectrum, PFFFT_FORWARD);
+      for (i = 0; i < 2 * n_channels; i++)
+        priv->order[i] = priv->spectrum[i];
+    }
+
+  hyscan_channelizer_select (priv, NULL, n_channels);
+  hyscan_channelizer_reset (channelizer);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_channelizer_set_channels:
+ * @channelizer: указатель на #HyScanChannelizer
+ * @channels: (array length=n_channels) (nullable): номера каналов
+ * @n_channels: число каналов
+ *
+ * Функция выбирает каналы, для которых рассчитываются выходные отсчёты.
+ * Результаты записываются в выходные буферы в порядке перечисления каналов.
+ * Если channels равен NULL, выбираются все каналы. Состояние фильтра при
+ * этом не изменяется.
+ *
+ * Returns: %TRUE если каналы выбраны, иначе %FALSE.
+ */
+gboolean
+hyscan_channelizer_set_channels (HyScanChannelizer *channelizer,
+                                 const guint       *channels,
+                                 guint              n_channels)
+{
+  HyScanChannelizerPrivate *priv;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), FALSE);
+
+  priv = channelizer->priv;
+
+  if (priv->n_channels == 0)
+    {
+      g_warning ("HyScanChannelizer: channelizer not configured");
+      return FALSE;
+    }
+
+  if (channels == NULL)
+    {
+      hyscan_channelizer_select (priv, NULL, priv->n_channels);
+      return TRUE;
+    }
+
+  if (n_channels == 0)
+    {
+      g_warning ("HyScanChannelizer: no channels selected");
+      return FALSE;
+    }
+
+  for (i = 0; i < n_channels; i++)
+    {
+      if (channels[i] >= priv->n_channels)
+        {
+          g_warning ("HyScanChannelizer: incorrect channel %u", channels[i]);
+          return FALSE;
+        }
+    }
+
+  hyscan_channelizer_select (priv, channels, n_channels);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_channelizer_get_frequency:
+ * @channelizer: указатель на #HyScanChannelizer
+ * @channel: номер канала
+ * @data_rate: частота дискретизации входных данных, Гц
+ *
+ * Функция возвращает центральную частоту канала относительно нулевой
+ * частоты входных данных.
+ *
+ * Returns: Центральная частота канала, Гц.
+ */
+gdouble
+hyscan_channelizer_get_frequency (HyScanChannelizer *channelizer,
+                                  guint              channel,
+                                  gdouble            data_rate)
+{
+  guint n_channels;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), 0.0);
+
+  n_channels = channelizer->priv->n_channels;
+  if (channel >= n_channels)
+    return 0.0;
+
+  if (2 * channel > n_channels)
+    return ((gdouble) channel - n_channels) * data_rate / n_channels;
+
+  return (gdouble) channel * data_rate / n_channels;
+}
+
+/**
+ * hyscan_channelizer_get_delay:
+ * @channelizer: указатель на #HyScanChannelizer
+ *
+ * Функция возвращает задержку, вносимую фильтром. Выходной отсчёт канала
+ * с номером m соответствует моменту времени (m - delay) / data_rate от
+ * начала входных данных, где data_rate - частота дискретизации канала.
+ *
+ * Returns: Задержка в отсчётах каналов.
+ */
+gdouble
+hyscan_channelizer_get_delay (HyScanChannelizer *channelizer)
+{
+  HyScanChannelizerPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), 0.0);
+
+  priv = channelizer->priv;
+  if (priv->n_channels == 0)
+    return 0.0;
+
+  return (priv->length - 1) / (2.0 * priv->n_channels);
+}
+
+/**
+ * hyscan_channelizer_get_output_size:
+ * @channelizer: указатель на #HyScanChannelizer
+ * @n_points: число входных отсчётов
+ *
+ * Функция возвращает число выходных отсчётов каждого канала, которое будет
+ * рассчитано при следующем вызове функции #hyscan_channelizer_process
+ * для n_points входных отсчётов.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_channelizer_get_output_size (HyScanChannelizer *channelizer,
+                                    guint32            n_points)
+{
+  HyScanChannelizerPrivate *priv;
+  guint64 total;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), 0);
+
+  priv = channelizer->priv;
+  if (priv->n_channels == 0)
+    return 0;
+
+  total = (guint64) priv->n_points + n_points;
+  if (total < priv->length)
+    return 0;
+
+  return (total - priv->length) / priv->n_channels + 1;
+}
+
+/**
+ * hyscan_channelizer_process:
+ * @channelizer: указатель на #HyScanChannelizer
+ * @input: (array length=n_points) входные отсчёты
+ * @n_points: число входных отсчётов
+ * @output: (array) (transfer none): массив указателей на буферы выбранных каналов
+ *
+ * Функция разделяет на каналы очередную часть комплексных данных. Число
+ * буферов для результата должно быть равно числу выбранных каналов, а
+ * размер каждого из них - не меньше значения, возвращаемого функцией
+ * #hyscan_channelizer_get_output_size.
+ *
+ * Returns: Число выходных отсчётов каждого канала.
+ */
+guint32
+hyscan_channelizer_process (HyScanChannelizer         *channelizer,
+                            const HyScanComplexFloat  *input,
+                            guint32                    n_points,
+                            HyScanComplexFloat *const *output)
+{
+  HyScanChannelizerPrivate *priv;
+  guint32 n_out = 0;
+  guint32 offset;
+
+  g_return_val_if_fail (HYSCAN_IS_CHANNELIZER (channelizer), 0);
+
+  priv = channelizer->priv;
+
+  if (priv->n_channels == 0)
+    {
+      g_warning ("HyScanChannelizer: channelizer not configured");
+      return 0;
+    }
+
+  for (offset = 0; offset < n_points; offset += HYSCAN_CHANNELIZER_CHUNK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_CHANNELIZER_CHUNK_SIZE, n_points - offset);
+
+      memcpy (priv->buffer + 2 * priv->n_points, input + offset, n * sizeof (HyScanComplexFloat));
+      priv->n_points += n;
+
+      n_out += hyscan_channelizer_process_buffer (priv, output, n_out);
+    }
+
+  return n_out;
+}
+
+/**
+ * hyscan_channelizer_reset:
+ * @channelizer: указатель на #HyScanChannelizer
+ *
+ * Функция сбрасывает состояние фильтра. Следующий вызов функции обработки
+ * обрабатывает данные как новый поток.
+ */
+void
+hyscan_channelizer_reset (HyScanChannelizer *channelizer)
+{
+  HyScanChannelizerPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_CHANNELIZER (channelizer));
+
+  priv = channelizer->priv;
+
+  if (priv->n_channels == 0)
+    return;
+
+  /* История фильтра заполняется нулями, поэтому первый выходной отсчёт
+   * соответствует первому входному отсчёту. */
+  memset (priv->buffer, 0, 2 * (priv->length - 1) * sizeof (gfloat));
+  priv->n_points = priv->length - 1;
+}
@@ -0,0 +1,105 @@
+/* hyscan-channelizer.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_CHANNELIZER_H__
+#define __HYSCAN_CHANNELIZER_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_CHANNELIZER             (hyscan_channelizer_get_type ())
+#define HYSCAN_CHANNELIZER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_CHANNELIZER, HyScanChannelizer))
+#define HYSCAN_IS_CHANNELIZER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_CHANNELIZER))
+#define HYSCAN_CHANNELIZER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_CHANNELIZER, HyScanChannelizerClass))
+#define HYSCAN_IS_CHANNELIZER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_CHANNELIZER))
+#define HYSCAN_CHANNELIZER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_CHANNELIZER, HyScanChannelizerClass))
+
+typedef struct _HyScanChannelizer HyScanChannelizer;
+typedef struct _HyScanChannelizerPrivate HyScanChannelizerPrivate;
+typedef struct _HyScanChannelizerClass HyScanChannelizerClass;
+
+struct _HyScanChannelizer
+{
+  GObject parent_instance;
+
+  HyScanChannelizerPrivate *priv;
+};
+
+struct _HyScanChannelizerClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_channelizer_get_type             (void);
+
+HYSCAN_API
+HyScanChannelizer *    hyscan_channelizer_new                  (void);
+
+HYSCAN_API
+gboolean               hyscan_channelizer_configure            (HyScanChannelizer         *channelizer,
+                                                                guint                      n_channels,
+                                                                guint                      n_taps);
+
+HYSCAN_API
+gboolean               hyscan_channelizer_set_channels         (HyScanChannelizer         *channelizer,
+                                                                const guint               *channels,
+                                                                guint                      n_channels);
+
+HYSCAN_API
+gdouble                hyscan_channelizer_get_frequency        (HyScanChannelizer         *channelizer,
+                                                                guint                      channel,
+                                                                gdouble                    data_rate);
+
+HYSCAN_API
+gdouble                hyscan_channelizer_get_delay            (HyScanChannelizer         *channelizer);
+
+HYSCAN_API
+guint32                hyscan_channelizer_get_output_size      (HyScanChannelizer         *channelizer,
+                                                                guint32                    n_points);
+
+HYSCAN_API
+guint32                hyscan_channelizer_process              (HyScanChannelizer         *channelizer,
+                                                                const HyScanComplexFloat  *input,
+                                                                guint32                    n_points,
+                                                                HyScanComplexFloat *const *output);
+
+HYSCAN_API
+void                   hyscan_channelizer_reset                (HyScanChannelizer         *channelizer);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CHANNELIZER_H__ */
@@ -0,0 +1,579 @@
+/* hyscan-convolution-2d.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-convolution-2d
+ * @Short_description: класс двумерной свёртки данных
+ * @Title: HyScanConvolution2D
+ *
+ * Класс HyScanConvolution2D используется для выполнения двумерной свёртки
+ * или корреляции изображения (например, водопада гидролокатора) с ядром.
+ * Изображение и ядро задаются действительными числами и располагаются в
+ * памяти по строкам.
+ *
+ * Объект для выполнения свёртки создаётся функцией #hyscan_convolution_2d_new.
+ * Ядро свёртки задаётся функцией #hyscan_convolution_2d_set_kernel. При этом
+ * вычисляется его двумерный спектр, который затем используется для всех
+ * фрагментов всех изображений.
+ *
+ * Свёртка выполняется по схеме "overlap-save": изображение разбивается на
+ * фрагменты, для каждого из которых выполняется двумерное FFT
+ * преобразование, перемножение со спектром ядра и обратное преобразование.
+ * Размер фрагмента выбирается по размеру ядра так, чтобы число операций на
+ * один отсчёт результата было минимальным (см.
+ * #hyscan_convolution_2d_get_tile_size). Два соседних фрагмента
+ * обрабатываются одним комплексным преобразованием: один из них помещается
+ * в действительную часть, а другой в мнимую. Фрагменты обрабатываются
+ * параллельно, если библиотека собрана с поддержкой OpenMP.
+ *
+ * Функция #hyscan_convolution_2d_convolve выполняет свёртку. Результат
+ * имеет размер исходного изображения, центр ядра - отсчёт (width / 2,
+ * height / 2). За пределами изображения данные считаются нулевыми.
+ *
+ * Вычислительная сложность не зависит от размера ядра так сильно, как при
+ * прямом вычислении свёртки, поэтому для ядер размером больше 15x15
+ * отсчётов такой способ значительно быстрее.
+ *
+ * HyScanConvolution2D не поддерживает работу в многопоточном режиме.
+ */
+
+#include "hyscan-convolution-2d.h"
+#include "hyscan-convolution.h"
+
+#include <math.h>
+#include <string.h>
+#include "pffft.h"
+
+#ifdef HYSCAN_OPEN_MP
+#include <omp.h>
+#endif
+
+/* Максимальный размер фрагмента изображения. */
+#define HYSCAN_CONVOLUTION_2D_MAX_TILE_SIZE    1024
+
+struct _HyScanConvolution2DPrivate
+{
+  PFFFT_Setup                 *fft_width;      /* Коэффициенты преобразования строк фрагмента. */
+  PFFFT_Setup                 *fft_height;     /* Коэффициенты преобразования столбцов фрагмента. */
+  guint32                      tile_width;     /* Ширина фрагмента. */
+  guint32                      tile_height;    /* Высота фрагмента. */
+
+  HyScanComplexFloat          *spectrum;       /* Спектр ядра свёртки. */
+  guint32                      kernel_width;   /* Ширина ядра свёртки. */
+  guint32                      kernel_height;  /* Высота ядра свёртки. */
+  guint32                      center_x;       /* Смещение центра ядра по горизонтали. */
+  guint32                      center_y;       /* Смещение центра ядра по вертикали. */
+
+  HyScanComplexFloat          *buffers;        /* Буферы для обработки фрагментов. */
+  guint32                      buffer_size;    /* Размер буфера одного потока. */
+  gint                         n_buffers;      /* Число буферов. */
+};
+
+static void      hyscan_convolution_2d_object_finalize    (GObject                       *object);
+
+static void      hyscan_convolution_2d_clear              (HyScanConvolution2DPrivate    *priv);
+
+static guint32   hyscan_convolution_2d_get_optimal_size   (guint32                        kernel_size);
+
+static void      hyscan_convolution_2d_forward            (HyScanConvolution2DPrivate    *priv,
+                                                           HyScanComplexFloat            *tile,
+                                                           HyScanComplexFloat            *transposed,
+                                                           HyScanComplexFloat            *work);
+
+static void      hyscan_convolution_2d_process            (HyScanConvolution2DPrivate    *priv,
+                                                           HyScanComplexFloat            *buffer,
+                                                           const gfloat                  *input,
+                                                           gfloat                        *output,
+                                                           guint32                        width,
+                                                           guint32                        height,
+                                                           guint                          n_tiles_x,
+                                                           guint                          tile1,
+                                                           guint                          tile2);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanConvolution2D, hyscan_convolution_2d, G_TYPE_OBJECT);
+
+static void
+hyscan_convolution_2d_class_init (HyScanConvolution2DClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_convolution_2d_object_finalize;
+}
+
+static void
+hyscan_convolution_2d_init (HyScanConvolution2D *convolution)
+{
+  convolution->priv = hyscan_convolution_2d_get_instance_private (convolution);
+}
+
+static void
+hyscan_convolution_2d_object_finalize (GObject *object)
+{
+  HyScanConvolution2D *convolution = HYSCAN_CONVOLUTION_2D (object);
+
+  hyscan_convolution_2d_clear (convolution->priv);
+
+  G_OBJECT_CLASS (hyscan_convolution_2d_parent_class)->finalize (object);
+}
+
+/* Функция освобождает ядро свёртки и буферы. */
+static void
+hyscan_convolution_2d_clear (HyScanConvolution2DPrivate *priv)
+{
+  if (priv->fft_width != NULL)
+    pffft_destroy_setup (priv->fft_width);
+  if (priv->fft_height != NULL)
+    pffft_destroy_setup (priv->fft_height);
+
+  pffft_aligned_free (priv->spectrum);
+  pffft_aligned_free (priv->buffers);
+
+  priv->fft_width = NULL;
+  priv->fft_height = NULL;
+  priv->spectrum = NULL;
+  priv->buffers = NULL;
+  priv->n_buffers = 0;
+}
+
+/* Функция выбирает размер фрагмента по одному измерению. Для фрагмента
+ * размером N и ядра размером M число операций на один отсчёт результата
+ * пропорционально N * log2 (N) / (N - M + 1). */
+static guint32
+hyscan_convolution_2d_get_optimal_size (guint32 kernel_size)
+{
+  guint32 best_size = 0;
+  gdouble best_cost = G_MAXDOUBLE;
+  guint32 size;
+
+  for (size = hyscan_convolution_get_fft_size (kernel_size + 1);
+       size != 0;
+       size = hyscan_convolution_get_fft_size (size + 1))
+    {
+      gdouble cost = size * log2 (size) / (size - kernel_size + 1);
+
+      if ((size > HYSCAN_CONVOLUTION_2D_MAX_TILE_SIZE) && (best_size != 0))
+        break;
+
+      if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_size = size;
+        }
+    }
+
+  return best_size;
+}
+
+/* Функция выполняет прямое двумерное преобразование Фурье фрагмента.
+ * Строки преобразуются с упорядочиванием результата, затем фрагмент
+ * транспонируется и преобразуются его столбцы. Спектры столбцов остаются
+ * во внутреннем порядке PFFFT и располагаются в transposed подряд. */
+static void
+hyscan_convolution_2d_forward (HyScanConvolution2DPrivate *priv,
+                               HyScanComplexFloat         *tile,
+                               HyScanComplexFloat         *transposed,
+                               HyScanComplexFloat         *work)
+{
+  guint32 tile_width = priv->tile_width;
+  guint32 tile_height = priv->tile_height;
+  guint32 i, j;
+
+  for (i = 0; i < tile_height; i++)
+    {
+      pffft_transform_ordered (priv->fft_width,
+                               (const gfloat*) (tile + i * tile_width),
+                               (gfloat*) (tile + i * tile_width),
+                               (gfloat*) work,
+                               PFFFT_FORWARD);
+    }
+
+  for (i = 0; i < tile_height; i++)
+    for (j = 0; j < tile_width; j++)
+      transposed[j * tile_height + i] = tile[i * tile_width + j];
+
+  for (j = 0; j < tile_width; j++)
+    {
+      pffft_transform (priv->fft_height,
+                       (const gfloat*) (transposed + j * tile_height),
+                       (gfloat*) (transposed + j * tile_height),
+                       (gfloat*) work,
+                       PFFFT_FORWARD);
+    }
+}
+
+/* Функция выполняет свёртку одного или двух фрагментов изображения. Второй
+ * фрагмент помещается в мнимую часть данных. Так как ядро действительное,
+ * результаты свёртки обоих фрагментов не смешиваются. */
+static void
+hyscan_convolution_2d_process (HyScanConvolution2DPrivate *priv,
+                               HyScanComplexFloat         *buffer,
+                               const gfloat               *input,
+                               gfloat                     *output,
+                               guint32                     width,
+                               guint32                     height,
+                               guint                       n_tiles_x,
+                               guint                       tile1,
+                               guint                       tile2)
+{
+  guint32 tile_width = priv->tile_width;
+  guint32 tile_height = priv->tile_height;
+  guint32 valid_width = tile_width - priv->kernel_width + 1;
+  guint32 valid_height = tile_height - priv->kernel_height + 1;
+  guint32 tile_size = tile_width * tile_height;
+
+  HyScanComplexFloat *tile = buffer;
+  HyScanComplexFloat *transposed = tile + tile_size;
+  HyScanComplexFloat *column = transposed + tile_size;
+  HyScanComplexFloat *work = column + tile_height;
+
+  gint64 origin_x[2], origin_y[2];
+  guint n_tiles;
+  guint32 i, j;
+  guint k;
+
+  n_tiles = (tile2 == G_MAXUINT) ? 1 : 2;
+  origin_x[0] = (tile1 % n_tiles_x) * valid_width;
+  origin_y[0] = (tile1 / n_tiles_x) * valid_height;
+  origin_x[1] = (tile2 % n_tiles_x) * valid_width;
+  origin_y[1] = (tile2 / n_tiles_x) * valid_height;
+
+  /* Копируем данные фрагментов с учётом перекрытия. */
+  memset (tile, 0, tile_size * sizeof (HyScanComplexFloat));
+  for (k = 0; k < n_tiles; k++)
+    {
+      gint64 start_x = origin_x[k] + priv->center_x - (priv->kernel_width - 1);
+      gint64 start_y = origin_y[k] + priv->center_y - (priv->kernel_height - 1);
+
+      for (i = 0; i < tile_height; i++)
+        {
+          gint64 y = start_y + i;
+          gfloat *values;
+
+          if ((y < 0) || (y >= height))
+            continue;
+
+          values = (k == 0) ? &tile[i * tile_width].re : &tile[i * tile_width].im;
+          for (j = 0; j < tile_width; j++)
+            {
+              gint64 x = start_x + j;
+
+              if ((x >= 0) && (x < width))
+                values[2 * j] = input[y * width + x];
+            }
+        }
+    }
+
+  hyscan_convolution_2d_forward (priv, tile, transposed, work);
+
+  /* Перемножение со спектром ядра и обратное преобразование столбцов. */
+  for (j = 0; j < tile_width; j++)
+    {
+      memset (column, 0, tile_height * sizeof (HyScanComplexFloat));
+      pffft_zconvolve_accumulate (priv->fft_height,
+                                  (const gfloat*) (transposed + j * tile_height),
+                                  (const gfloat*) (priv->spectrum + j * tile_height),
+                                  (gfloat*) column,
+                                  1.0f / tile_size);
+
+      pffft_transform (priv->fft_height,
+                       (const gfloat*) column,
+                       (gfloat*) (transposed + j * tile_height),
+                       (gfloat*) work,
+                       PFFFT_BACKWARD);
+    }
+
+  /* Обратное преобразование строк. Нужны только строки, начиная с
+   * kernel_height - 1. */
+  for (i = priv->kernel_height - 1; i < tile_height; i++)
+    {
+      for (j = 0; j < tile_width; j++)
+        tile[i * tile_width + j] = transposed[j * tile_height + i];
+
+      pffft_transform_ordered (priv->fft_width,
+                               (const gfloat*) (tile + i * tile_width),
+                               (gfloat*) (tile + i * tile_width),
+                               (gfloat*) work,
+                               PFFFT_BACKWARD);
+    }
+
+  /* Копируем результат. */
+  for (k = 0; k < n_tiles; k++)
+    {
+      guint32 n_rows = MIN (valid_height, height - origin_y[k]);
+      guint32 n_columns = MIN (valid_width, width - origin_x[k]);
+
+      for (i = 0; i < n_rows; i++)
+        {
+          const HyScanComplexFloat *src = tile + (i + priv->kernel_height - 1) * tile_width + priv->kernel_width - 1;
+          gfloat *dst = output + (origin_y[k] + i) * width + origin_x[k];
+
+          if (k == 0)
+            {
+              for (j = 0; j < n_columns; j++)
+                dst[j] = src[j].re;
+            }
+          else
+            {
+              for (j = 0; j < n_columns; j++)
+                dst[j] = src[j].im;
+            }
+        }
+    }
+}
+
+/**
+ * hyscan_convolution_2d_new:
+ *
+ * Функция создаёт новый объект #HyScanConvolution2D.
+ *
+ * Returns: #HyScanConvolution2D. Для удаления #g_object_unref.
+ */
+HyScanConvolution2D *
+hyscan_convolution_2d_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_CONVOLUTION_2D, NULL);
+}
+
+/**
+ * hyscan_convolution_2d_set_kernel:
+ * @convolution: указатель на #HyScanConvolution2D
+ * @kernel: (nullable) (transfer none): ядро свёртки размером width * height
+ * @width: ширина ядра
+ * @height: высота ядра
+ * @correlation: выполнять корреляцию вместо свёртки
+ *
+ * Функция задаёт ядро свёртки. Если ядро установлено в NULL, свёртка
+ * отключается.
+ *
+ * Если @correlation равен %TRUE, выполняется корреляция: значение
+ * результата в точке (x, y) равно сумме произведений ядра и участка
+ * изображения, центр которого совпадает с (x, y). Такой режим используется
+ * для поиска объектов по шаблону.
+ *
+ * Returns: %TRUE если ядро установлено, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_2d_set_kernel (HyScanConvolution2D *convolution,
+                                  const gfloat        *kernel,
+                                  guint32              width,
+                                  guint32              height,
+                                  gboolean             correlation)
+{
+  HyScanConvolution2DPrivate *priv;
+  HyScanComplexFloat *tile;
+  HyScanComplexFloat *work;
+  guint32 tile_width;
+  guint32 tile_height;
+  guint32 i, j;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_2D (convolution), FALSE);
+
+  priv = convolution->priv;
+
+  hyscan_convolution_2d_clear (priv);
+
+  if (kernel == NULL)
+    return TRUE;
+
+  if ((width == 0) || (height == 0))
+    {
+      g_warning ("HyScanConvolution2D: wrong kernel size %ux%u", width, height);
+      return FALSE;
+    }
+
+  tile_width = hyscan_convolution_2d_get_optimal_size (width);
+  tile_height = hyscan_convolution_2d_get_optimal_size (height);
+  if ((tile_width == 0) || (tile_height == 0))
+    {
+      g_warning ("HyScanConvolution2D: kernel size %ux%u is too big", width, height);
+      return FALSE;
+    }
+
+  priv->fft_width = pffft_new_setup (tile_width, PFFFT_COMPLEX);
+  priv->fft_height = pffft_new_setup (tile_height, PFFFT_COMPLEX);
+  if ((priv->fft_width == NULL) || (priv->fft_height == NULL))
+    {
+      hyscan_convolution_2d_clear (priv);
+      return FALSE;
+    }
+
+  priv->tile_width = tile_width;
+  priv->tile_height = tile_height;
+  priv->kernel_width = width;
+  priv->kernel_height = height;
+  priv->center_x = width / 2;
+  priv->center_y = height / 2;
+
+  /* Буфер одного потока: фрагмент, транспонированный фрагмент, столбец
+   * и рабочий буфер преобразования. */
+  priv->buffer_size = 2 * tile_width * tile_height + tile_height + MAX (tile_width, tile_height);
+
+  /* Ядро располагается в начале фрагмента. Для корреляции ядро
+   * отражается, а его центр смещается так, чтобы он совпадал с центром
+   * исходного ядра. */
+  tile = pffft_aligned_malloc (tile_width * tile_height * sizeof (HyScanComplexFloat));
+  work = pffft_aligned_malloc (MAX (tile_width, tile_height) * sizeof (HyScanComplexFloat));
+  priv->spectrum = pffft_aligned_malloc (tile_width * tile_height * sizeof (HyScanComplexFloat));
+  memset (tile, 0, tile_width * tile_height * sizeof (HyScanComplexFloat));
+
+  for (i = 0; i < height; i++)
+    for (j = 0; j < width; j++)
+      {
+        if (correlation)
+          tile[(height - 1 - i) * tile_width + (width - 1 - j)].re = kernel[i * width + j];
+        else
+          tile[i * tile_width + j].re = kernel[i * width + j];
+      }
+
+  if (correlation)
+    {
+      priv->center_x = width - 1 - width / 2;
+      priv->center_y = height - 1 - height / 2;
+    }
+
+  hyscan_convolution_2d_forward (priv, tile, priv->spectrum, work);
+
+  pffft_aligned_free (tile);
+  pffft_aligned_free (work);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_convolution_2d_get_tile_size:
+ * @convolution: указатель на #HyScanConvolution2D
+ * @width: (out) (optional): ширина фрагмента
+ * @height: (out) (optional): высота фрагмента
+ *
+ * Функция возвращает размер фрагмента изображения, выбранный для текущего
+ * ядра свёртки. Если ядро не задано, возвращается нулевой размер.
+ */
+void
+hyscan_convolution_2d_get_tile_size (HyScanConvolution2D *convolution,
+                                     guint32             *width,
+                                     guint32             *height)
+{
+  HyScanConvolution2DPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_CONVOLUTION_2D (convolution));
+
+  priv = convolution->priv;
+
+  if (width != NULL)
+    *width = (priv->spectrum != NULL) ? priv->tile_width : 0;
+  if (height != NULL)
+    *height = (priv->spectrum != NULL) ? priv->tile_height : 0;
+}
+
+/**
+ * hyscan_convolution_2d_convolve:
+ * @convolution: указатель на #HyScanConvolution2D
+ * @input: (transfer none): изображение размером width * height
+ * @output: (out) (transfer none): буфер для результата размером width * height
+ * @width: ширина изображения
+ * @height: высота изображения
+ *
+ * Функция выполняет свёртку изображения с ядром. Массивы input и output не
+ * должны пересекаться.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_2d_convolve (HyScanConvolution2D *convolution,
+                                const gfloat        *input,
+                                gfloat              *output,
+                                guint32              width,
+                                guint32              height)
+{
+  HyScanConvolution2DPrivate *priv;
+  guint n_tiles_x;
+  guint n_tiles_y;
+  gint n_jobs;
+  gint n_threads;
+  gint i;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_2D (convolution), FALSE);
+  g_return_val_if_fail ((input != NULL) && (output != NULL), FALSE);
+  g_return_val_if_fail (input != output, FALSE);
+
+  priv = convolution->priv;
+
+  if (priv->spectrum == NULL)
+    return FALSE;
+
+  if ((width == 0) || (height == 0))
+    return TRUE;
+
+  n_tiles_x = (width + priv->tile_width - priv->kernel_width) / (priv->tile_width - priv->kernel_width + 1);
+  n_tiles_y = (height + priv->tile_height - priv->kernel_height) / (priv->tile_height - priv->kernel_height + 1);
+
+  /* Каждое задание обрабатывает пару фрагментов. */
+  n_jobs = (n_tiles_x * n_tiles_y + 1) / 2;
+
+  /* Буферы для каждого потока. */
+  n_threads = 1;
+#ifdef HYSCAN_OPEN_MP
+  n_threads = omp_get_max_threads ();
+#endif
+
+  if (priv->n_buffers < n_threads)
+    {
+      pffft_aligned_free (priv->buffers);
+      priv->buffers = pffft_aligned_malloc (n_threads * priv->buffer_size * sizeof (HyScanComplexFloat));
+      priv->n_buffers = n_threads;
+    }
+
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_jobs; i++)
+    {
+      guint tile1 = 2 * i;
+      guint tile2 = 2 * i + 1;
+      gint thread = 0;
+
+#ifdef HYSCAN_OPEN_MP
+      thread = omp_get_thread_num ();
+#endif
+
+      if (tile2 >= n_tiles_x * n_tiles_y)
+        tile2 = G_MAXUINT;
+
+      hyscan_convolution_2d_process (priv, priv->buffers + thread * priv->buffer_size,
+                                     input, output, width, height,
+                                     n_tiles_x, tile1, tile2);
+    }
+
+  return TRUE;
+}
@@ -0,0 +1,93 @@
+/* hyscan-convolution-2d.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_CONVOLUTION_2D_H__
+#define __HYSCAN_CONVOLUTION_2D_H__
+
+#include <glib-object.h>
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_CONVOLUTION_2D             (hyscan_convolution_2d_get_type ())
+#define HYSCAN_CONVOLUTION_2D(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_CONVOLUTION_2D, HyScanConvolution2D))
+#define HYSCAN_IS_CONVOLUTION_2D(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_CONVOLUTION_2D))
+#define HYSCAN_CONVOLUTION_2D_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_CONVOLUTION_2D, HyScanConvolution2DClass))
+#define HYSCAN_IS_CONVOLUTION_2D_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_CONVOLUTION_2D))
+#define HYSCAN_CONVOLUTION_2D_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_CONVOLUTION_2D, HyScanConvolution2DClass))
+
+typedef struct _HyScanConvolution2D HyScanConvolution2D;
+typedef struct _HyScanConvolution2DPrivate HyScanConvolution2DPrivate;
+typedef struct _HyScanConvolution2DClass HyScanConvolution2DClass;
+
+struct _HyScanConvolution2D
+{
+  GObject parent_instance;
+
+  HyScanConvolution2DPrivate *priv;
+};
+
+struct _HyScanConvolution2DClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                     hyscan_convolution_2d_get_type           (void);
+
+HYSCAN_API
+HyScanConvolution2D *     hyscan_convolution_2d_new                (void);
+
+HYSCAN_API
+gboolean                  hyscan_convolution_2d_set_kernel         (HyScanConvolution2D       *convolution,
+                                                                    const gfloat              *kernel,
+                                                                    guint32                    width,
+                                                                    guint32                    height,
+                                                                    gboolean                   correlation);
+
+HYSCAN_API
+void                      hyscan_convolution_2d_get_tile_size      (HyScanConvolution2D       *convolution,
+                                                                    guint32                   *width,
+                                                                    guint32                   *height);
+
+HYSCAN_API
+gboolean                  hyscan_convolution_2d_convolve           (HyScanConvolution2D       *convolution,
+                                                                    const gfloat              *input,
+                                                                    gfloat                    *output,
+                                                                    guint32                    width,
+                                                                    guint32                    height);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CONVOLUTION_2D_H__ */
@@ -0,0 +1,457 @@
+/* hyscan-convolution-image.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+
+/**
+ * SECTION: hyscan-convolution-image
+ * @Short_description: образ для свёртки
+ * @Title: HyScanConvolutionImage
+ *
+ * Класс HyScanConvolutionImage хранит образ для свёртки, подготовленный
+ * для использования классом #HyScanConvolution. Образ создаётся функциями
+ * #hyscan_convolution_image_new_td и #hyscan_convolution_image_new_fd и
+ * не изменяется после создания, поэтому один объект можно использовать в
+ * нескольких объектах свёртки одновременно (см. #hyscan_convolution_set_image).
+ *
+ * Образ во временной области не преобразуется при создании: прямое
+ * преобразование Фурье выполняется при первой свёртке с ним. Преобразование
+ * можно выполнить заранее функцией #hyscan_convolution_image_prepare, а
+ * проверить его готовность - функцией #hyscan_convolution_image_is_prepared.
+ *
+ * Объект HyScanConvolutionImage можно использовать из нескольких потоков.
+ */
+
+#include "hyscan-convolution-plan.h"
+#include "hyscan-fft-size.h"
+
+#include <string.h>
+
+typedef enum
+{
+  HYSCAN_CONVOLUTION_IMAGE_TD,
+  HYSCAN_CONVOLUTION_IMAGE_FD
+} HyScanConvolutionImageType;
+
+struct _HyScanConvolutionImagePrivate
+{
+  HyScanConvolutionImageType   type;           /* Тип образа. */
+  HyScanComplexFloat          *image;          /* Образ во временной области. */
+  guint32                      n_points;       /* Размер образа в точках. */
+  guint32                      max_fft_size;   /* Максимальный размер преобразования Фурье. */
+  guint32                      fft_size;       /* Размер преобразования Фурье для длинных строк. */
+
+  GMutex                       lock;           /* Блокировка списка планов. */
+  GHashTable                  *plans;          /* Планы свёртки для разных размеров FFT. */
+  HyScanConvolutionPlan       *plan;           /* План свёртки для длинных строк. */
+};
+
+static void      hyscan_convolution_image_object_finalize  (GObject                       *object);
+
+static HyScanConvolutionImage *
+                 hyscan_convolution_image_new              (HyScanConvolutionImageType     type,
+                                                            const HyScanComplexFloat      *image,
+                                                            guint32                        n_points,
+                                                            guint32                        max_fft_size);
+
+static HyScanConvolutionPlan *
+                 hyscan_convolution_image_get_default_plan (HyScanConvolutionImagePrivate *priv);
+
+static void      hyscan_convolution_image_prepare_run      (gpointer                       data,
+                                                            gpointer                       user_data);
+
+static GThreadPool *
+                 hyscan_convolution_image_get_pool         (void);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanConvolutionImage, hyscan_convolution_image, G_TYPE_OBJECT);
+
+static void
+hyscan_convolution_image_class_init (HyScanConvolutionImageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS( klass );
+
+  object_class->finalize = hyscan_convolution_image_object_finalize;
+}
+
+static void
+hyscan_convolution_image_init (HyScanConvolutionImage *image)
+{
+  image->priv = hyscan_convolution_image_get_instance_private (image);
+
+  g_mutex_init (&image->priv->lock);
+  image->priv->plans = g_hash_table_new_full (NULL, NULL, NULL, hyscan_convolution_plan_free);
+}
+
+static void
+hyscan_convolution_image_object_finalize (GObject *object)
+{
+  HyScanConvolutionImage *image = HYSCAN_CONVOLUTION_IMAGE (object);
+  HyScanConvolutionImagePrivate *priv = image->priv;
+
+  g_hash_table_unref (priv->plans);
+  g_free (priv->image);
+
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_convolution_image_parent_class)->finalize (object);
+}
+
+/* Функция создаёт образ для свёртки. */
+static HyScanConvolutionImage *
+hyscan_convolution_image_new (HyScanConvolutionImageType  type,
+                              const HyScanComplexFloat   *image,
+                              guint32                     n_points,
+                              guint32                     max_fft_size)
+{
+  HyScanConvolutionImage *fft_image;
+  HyScanConvolutionImagePrivate *priv;
+  HyScanConvolutionPlan *plan;
+  guint32 fft_size;
+
+  /* Для образа в частотной области размер образа должен быть точно равен
+   * размеру FFT преобразования. Размер FFT преобразования для образа во
+   * временной области выбирается отдельно для каждой длины строки
+   * (см. hyscan_convolution_get_optimal_fft_size). */
+  if (type == HYSCAN_CONVOLUTION_IMAGE_FD)
+    {
+      fft_size = hyscan_fft_size_ceil (n_points);
+      if (fft_size == 0)
+        {
+          g_warning ("HyScanConvolutionImage: fft size too big");
+          return NULL;
+        }
+      else if (n_points != fft_size)
+        {
+          g_warning ("HyScanConvolutionImage: image size mismatch with fft size");
+          return NULL;
+        }
+    }
+  else
+    {
+      fft_size = hyscan_convolution_plan_optimal_size (n_points, 0, max_fft_size, NULL);
+    }
+
+  fft_image = g_object_new (HYSCAN_TYPE_CONVOLUTION_IMAGE, NULL);
+  priv = fft_image->priv;
+
+  priv->type = type;
+  priv->n_points = n_points;
+  priv->max_fft_size = hyscan_fft_size_floor (max_fft_size);
+  priv->fft_size = fft_size;
+
+  /* Образ во временной области только копируется, его преобразование
+   * выполняется при первом использовании или в фоновом потоке (см.
+   * hyscan_convolution_image_get_default_plan). */
+  if (type == HYSCAN_CONVOLUTION_IMAGE_TD)
+    {
+      priv->image = g_new (HyScanComplexFloat, n_points);
+      memcpy (priv->image, image, n_points * sizeof(HyScanComplexFloat));
+
+      return fft_image;
+    }
+
+  /* Спектр образа в частотной области используется сразу. */
+  plan = hyscan_convolution_plan_new (image, n_points, fft_size, TRUE);
+  if (plan == NULL)
+    {
+      g_warning ("HyScanConvolutionImage: can't setup fft");
+      g_object_unref (fft_image);
+      return NULL;
+    }
+
+  g_hash_table_insert (priv->plans, GUINT_TO_POINTER (fft_size), plan);
+  priv->plan = plan;
+
+  return fft_image;
+}
+
+/* Функция возвращает план свёртки для длинных строк. План образа во
+ * временной области создаётся при первом обращении. Функцию можно
+ * вызывать из нескольких потоков одновременно. */
+static HyScanConvolutionPlan *
+hyscan_convolution_image_get_default_plan (HyScanConvolutionImagePrivate *priv)
+{
+  HyScanConvolutionPlan *plan;
+
+  plan = g_atomic_pointer_get (&priv->plan);
+  if (plan != NULL)
+    return plan;
+
+  g_mutex_lock (&priv->lock);
+
+  plan = priv->plan;
+  if (plan == NULL)
+    {
+      plan = hyscan_convolution_plan_new (priv->image, priv->n_points, priv->fft_size, FALSE);
+      if (plan != NULL)
+        {
+          g_hash_table_insert (priv->plans, GUINT_TO_POINTER (priv->fft_size), plan);
+          g_atomic_pointer_set (&priv->plan, plan);
+        }
+      else
+        {
+          g_warning ("HyScanConvolutionImage: can't setup fft");
+        }
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  return plan;
+}
+
+/* Функция подготавливает образ в фоновом потоке. Образ передаётся по
+ * слабой ссылке: если до начала подготовки образ был заменён и удалён,
+ * подготовка не выполняется. */
+static void
+hyscan_convolution_image_prepare_run (gpointer data,
+                                      gpointer user_data)
+{
+  GWeakRef *ref = data;
+  HyScanConvolutionImage *image;
+
+  image = g_weak_ref_get (ref);
+  if (image != NULL)
+    {
+      hyscan_convolution_image_get_default_plan (image->priv);
+      g_object_unref (image);
+    }
+
+  g_weak_ref_clear (ref);
+  g_free (ref);
+}
+
+/* Функция возвращает пул потоков для фоновой подготовки образов. Пул
+ * общий для всех объектов и создаётся при первом обращении. */
+static GThreadPool *
+hyscan_convolution_image_get_pool (void)
+{
+  static gsize pool = 0;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (hyscan_convolution_image_prepare_run, NULL,
+                                    g_get_num_processors (), FALSE, NULL);
+      g_once_init_leave (&pool, (gsize) new_pool);
+    }
+
+  return (GThreadPool *) pool;
+}
+
+/* Функция возвращает план свёртки для строки указанного размера. Для образа
+ * во временной области план выбирается по оценке вычислительных затрат и
+ * создаётся один раз при первом обращении. */
+HyScanConvolutionPlan *
+hyscan_convolution_image_get_plan (HyScanConvolutionImage *image,
+                                   guint32                 line_size)
+{
+  HyScanConvolutionImagePrivate *priv = image->priv;
+  HyScanConvolutionPlan *plan;
+  guint32 fft_size;
+
+  if (priv->type == HYSCAN_CONVOLUTION_IMAGE_FD)
+    return priv->plan;
+
+  fft_size = hyscan_convolution_plan_optimal_size (priv->n_points, line_size, priv->max_fft_size, NULL);
+  if (fft_size == priv->fft_size)
+    return hyscan_convolution_image_get_default_plan (priv);
+
+  /* Если выигрыш от отдельного плана невелик, используем план для длинных
+   * строк. Это ограничивает число планов при переменной длине строк. */
+  if (hyscan_convolution_plan_cost (priv->n_points, line_size, priv->fft_size, NULL, NULL) <
+      1.1 * hyscan_convolution_plan_cost (priv->n_points, line_size, fft_size, NULL, NULL))
+    {
+      return hyscan_convolution_image_get_default_plan (priv);
+    }
+
+  g_mutex_lock (&priv->lock);
+
+  plan = g_hash_table_lookup (priv->plans, GUINT_TO_POINTER (fft_size));
+  if (plan == NULL)
+    {
+      plan = hyscan_convolution_plan_new (priv->image, priv->n_points, fft_size, FALSE);
+      if (plan != NULL)
+        g_hash_table_insert (priv->plans, GUINT_TO_POINTER (fft_size), plan);
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  if (plan == NULL)
+    plan = hyscan_convolution_image_get_default_plan (priv);
+
+  return plan;
+}
+
+/* Функция ставит подготовку образа в очередь общего пула потоков. Пул
+ * удерживает только слабую ссылку на образ. */
+void
+hyscan_convolution_image_prepare_background (HyScanConvolutionImage *image)
+{
+  GWeakRef *ref;
+
+  if (g_atomic_pointer_get (&image->priv->plan) != NULL)
+    return;
+
+  ref = g_new (GWeakRef, 1);
+  g_weak_ref_init (ref, image);
+  g_thread_pool_push (hyscan_convolution_image_get_pool (), ref, NULL);
+}
+
+/**
+ * hyscan_convolution_image_new_td:
+ * @image: (array length=n_points) (transfer none): образ для свёртки
+ * @n_points: размер образа в точках
+ * @max_fft_size: максимальный размер FFT преобразования или 0
+ *
+ * Функция создаёт образ для свёртки по образу во временной области. При
+ * создании отсчёты образа только копируются. Преобразование в частотную
+ * область выполняется при первой свёртке, вызове функции
+ * #hyscan_convolution_image_prepare или в фоновом потоке (см.
+ * #hyscan_convolution_set_background_fft). Образ не изменяется после
+ * создания, поэтому один объект можно использовать в нескольких объектах
+ * #HyScanConvolution.
+ *
+ * Параметр @max_fft_size имеет тот же смысл, что и в функции
+ * #hyscan_convolution_set_max_fft_size. Если он равен 0, используется
+ * значение по умолчанию.
+ *
+ * Returns: (nullable): #HyScanConvolutionImage или NULL. Для удаления #g_object_unref.
+ */
+HyScanConvolutionImage *
+hyscan_convolution_image_new_td (const HyScanComplexFloat *image,
+                                 guint32                   n_points,
+                                 guint32                   max_fft_size)
+{
+  g_return_val_if_fail (image != NULL, NULL);
+  g_return_val_if_fail (n_points > 0, NULL);
+
+  if (max_fft_size == 0)
+    max_fft_size = HYSCAN_CONVOLUTION_DEFAULT_MAX_FFT_SIZE;
+
+  return hyscan_convolution_image_new (HYSCAN_CONVOLUTION_IMAGE_TD, image, n_points, max_fft_size);
+}
+
+/**
+ * hyscan_convolution_image_new_fd:
+ * @image: (array length=n_points) (transfer none): образ для свёртки
+ * @n_points: размер образа в точках
+ *
+ * Функция создаёт образ для свёртки по образу в частотной области. Размер
+ * образа должен быть равен допустимому размеру FFT преобразования
+ * (см. #hyscan_convolution_get_fft_size).
+ *
+ * Returns: (nullable): #HyScanConvolutionImage или NULL. Для удаления #g_object_unref.
+ */
+HyScanConvolutionImage *
+hyscan_convolution_image_new_fd (const HyScanComplexFloat *image,
+                                 guint32                   n_points)
+{
+  g_return_val_if_fail (image != NULL, NULL);
+  g_return_val_if_fail (n_points > 0, NULL);
+
+  return hyscan_convolution_image_new (HYSCAN_CONVOLUTION_IMAGE_FD, image, n_points, 0);
+}
+
+/**
+ * hyscan_convolution_image_get_fft_size:
+ * @image: указатель на #HyScanConvolutionImage
+ *
+ * Функция возвращает размер FFT преобразования, используемый образом при
+ * свёртке длинных строк. Для коротких строк образ во временной области
+ * может использовать преобразование меньшего размера.
+ *
+ * Returns: Размер FFT преобразования.
+ */
+guint32
+hyscan_convolution_image_get_fft_size (HyScanConvolutionImage *image)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_IMAGE (image), 0);
+
+  return image->priv->fft_size;
+}
+
+/**
+ * hyscan_convolution_image_get_n_points:
+ * @image: указатель на #HyScanConvolutionImage
+ *
+ * Функция возвращает размер образа в точках.
+ *
+ * Returns: Размер образа в точках.
+ */
+guint32
+hyscan_convolution_image_get_n_points (HyScanConvolutionImage *image)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_IMAGE (image), 0);
+
+  return image->priv->n_points;
+}
+
+/**
+ * hyscan_convolution_image_prepare:
+ * @image: указатель на #HyScanConvolutionImage
+ *
+ * Функция выполняет прямое преобразование Фурье образа для свёртки длинных
+ * строк. Обычно образ во временной области преобразуется при первой
+ * свёртке, эта функция позволяет выполнить преобразование заранее, в том
+ * числе из другого потока.
+ *
+ * Returns: %TRUE если образ подготовлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_image_prepare (HyScanConvolutionImage *image)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_IMAGE (image), FALSE);
+
+  return hyscan_convolution_image_get_default_plan (image->priv) != NULL;
+}
+
+/**
+ * hyscan_convolution_image_is_prepared:
+ * @image: указатель на #HyScanConvolutionImage
+ *
+ * Функция проверяет, выполнено ли прямое преобразование Фурье образа для
+ * свёртки длинных строк, например после подготовки образа в фоновом потоке
+ * (см. #hyscan_convolution_set_background_fft). Образ в частотной области
+ * подготовлен всегда.
+ *
+ * Returns: %TRUE если образ подготовлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_image_is_prepared (HyScanConvolutionImage *image)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION_IMAGE (image), FALSE);
+
+  return g_atomic_pointer_get (&image->priv->plan) != NULL;
+}
@@ -0,0 +1,93 @@
+/* hyscan-convolution-image.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_CONVOLUTION_IMAGE_H__
+#define __HYSCAN_CONVOLUTION_IMAGE_H__
+
+#include <glib-object.h>
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_CONVOLUTION_IMAGE             (hyscan_convolution_image_get_type ())
+#define HYSCAN_CONVOLUTION_IMAGE(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_CONVOLUTION_IMAGE, HyScanConvolutionImage))
+#define HYSCAN_IS_CONVOLUTION_IMAGE(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_CONVOLUTION_IMAGE))
+#define HYSCAN_CONVOLUTION_IMAGE_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_CONVOLUTION_IMAGE, HyScanConvolutionImageClass))
+#define HYSCAN_IS_CONVOLUTION_IMAGE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_CONVOLUTION_IMAGE))
+#define HYSCAN_CONVOLUTION_IMAGE_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_CONVOLUTION_IMAGE, HyScanConvolutionImageClass))
+
+typedef struct _HyScanConvolutionImage HyScanConvolutionImage;
+typedef struct _HyScanConvolutionImagePrivate HyScanConvolutionImagePrivate;
+typedef struct _HyScanConvolutionImageClass HyScanConvolutionImageClass;
+
+struct _HyScanConvolutionImage
+{
+  GObject parent_instance;
+
+  HyScanConvolutionImagePrivate *priv;
+};
+
+struct _HyScanConvolutionImageClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                    hyscan_convolution_image_get_type       (void);
+
+HYSCAN_API
+HyScanConvolutionImage * hyscan_convolution_image_new_td         (const HyScanComplexFloat  *image,
+                                                                  guint32                    n_points,
+                                                                  guint32                    max_fft_size);
+
+HYSCAN_API
+HyScanConvolutionImage * hyscan_convolution_image_new_fd         (const HyScanComplexFloat  *image,
+                                                                  guint32                    n_points);
+
+HYSCAN_API
+guint32                  hyscan_convolution_image_get_fft_size   (HyScanConvolutionImage    *image);
+
+HYSCAN_API
+guint32                  hyscan_convolution_image_get_n_points   (HyScanConvolutionImage    *image);
+
+HYSCAN_API
+gboolean                 hyscan_convolution_image_prepare        (HyScanConvolutionImage    *image);
+
+HYSCAN_API
+gboolean                 hyscan_convolution_image_is_prepared    (HyScanConvolutionImage    *image);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CONVOLUTION_IMAGE_H__ */
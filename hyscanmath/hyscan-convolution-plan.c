@@ -0,0 +1,341 @@
+/* hyscan-convolution-plan.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+
+#include "hyscan-convolution-plan.h"
+#include "hyscan-fft-size.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Функция создаёт план свёртки для FFT преобразования указанного размера.
+ * Образ во временной области разбивается на части по оценке вычислительных
+ * затрат, а спектр образа в частотной области занимает весь блок. */
+HyScanConvolutionPlan *
+hyscan_convolution_plan_new (const HyScanComplexFloat *image,
+                             guint32                   n_points,
+                             guint32                   fft_size,
+                             gboolean                  frequency_domain)
+{
+  HyScanConvolutionPlan *plan;
+  HyScanComplexFloat *image_buff;
+  HyScanComplexFloat *work_buff;
+  PFFFT_Setup *fft;
+  guint32 hop_size;
+  guint32 n_parts;
+  guint32 i, j;
+
+  /* Параметры преобразования Фурье. */
+  fft = pffft_new_setup (fft_size, PFFFT_COMPLEX);
+  if (fft == NULL)
+    return NULL;
+
+  /* Образ в частотной области занимает весь блок, поэтому для него
+   * используется шаг в половину FFT преобразования. */
+  if (frequency_domain)
+    {
+      hop_size = fft_size / 2;
+      n_parts = 1;
+    }
+  else
+    {
+      hyscan_convolution_plan_cost (n_points, 0, fft_size, &hop_size, &n_parts);
+    }
+
+  plan = g_slice_new0 (HyScanConvolutionPlan);
+  g_mutex_init (&plan->lock);
+
+  plan->fft = fft;
+  plan->fft_size = fft_size;
+  plan->hop_size = hop_size;
+  plan->n_parts = n_parts;
+  plan->parts = pffft_aligned_malloc (n_parts * fft_size * sizeof(HyScanComplexFloat));
+
+  /* Коэффициент масштабирования свёртки. */
+  plan->scale = 1.0 / ((gfloat) fft_size * (gfloat) n_points);
+
+  image_buff = pffft_aligned_malloc (fft_size * sizeof(HyScanComplexFloat));
+  work_buff = pffft_aligned_malloc (fft_size * sizeof(HyScanComplexFloat));
+
+  /* Подготавливаем образ во временной области к свёртке и
+   * делаем его комплексно сопряжённым. Если образ разбит на части,
+   * размер каждой части равен шагу между блоками данных и каждая
+   * часть преобразуется отдельно. */
+  if (!frequency_domain)
+    {
+      guint32 part_size = (n_parts > 1) ? hop_size : n_points;
+
+      for (i = 0; i < n_parts; i++)
+        {
+          guint32 part_offset = i * part_size;
+          guint32 used_size = MIN ((n_points - part_offset), part_size);
+
+          memset (image_buff, 0, fft_size * sizeof(HyScanComplexFloat));
+          memcpy (image_buff, image + part_offset, used_size * sizeof(HyScanComplexFloat));
+
+          pffft_transform_ordered (fft,
+                                   (const gfloat*) image_buff,
+                                   (gfloat*) image_buff,
+                                   (gfloat*) work_buff,
+                                   PFFFT_FORWARD);
+
+          for (j = 0; j < fft_size; j++)
+            image_buff[j].im = -image_buff[j].im;
+
+          pffft_zreorder (fft,
+                          (const gfloat*) image_buff,
+                          (gfloat*) (plan->parts + i * fft_size),
+                          PFFFT_BACKWARD);
+        }
+    }
+
+  /* Образ в частотной области преобразуем ко внутреннему представлению PFFFT. */
+  else
+    {
+      memcpy (image_buff, image, fft_size * sizeof(HyScanComplexFloat));
+      pffft_zreorder (fft,
+                      (const gfloat*) image_buff,
+                      (gfloat*) plan->parts,
+                      PFFFT_BACKWARD);
+    }
+
+  pffft_aligned_free (image_buff);
+  pffft_aligned_free (work_buff);
+
+  return plan;
+}
+
+/* Функция освобождает память, занятую планом свёртки. */
+void
+hyscan_convolution_plan_free (gpointer data)
+{
+  HyScanConvolutionPlan *plan = data;
+
+  pffft_aligned_free (plan->parts);
+  pffft_aligned_free (plan->ordered_parts);
+  pffft_destroy_setup (plan->fft);
+  g_mutex_clear (&plan->lock);
+
+  g_slice_free (HyScanConvolutionPlan, plan);
+}
+
+/* Функция оценивает число операций на один отсчёт результата при свёртке
+ * строки размером line_size с образом размером image_size, используя FFT
+ * преобразование размером fft_size. Если line_size равен нулю, оценка
+ * выполняется для бесконечно длинной строки.
+ *
+ * Каждый блок требует прямого и обратного преобразования Фурье (около
+ * 5 * N * log2 (N) операций каждое) и перемножения спектров со всеми
+ * частями образа (8 * N операций на часть). Если образ помещается в блок,
+ * шаг между блоками равен N - M + 1, где M - размер образа. Иначе образ
+ * разбивается на части размером N / 2 и шаг равен N / 2. Шаг округляется
+ * до кратного 4 отсчётам, чтобы начало каждого блока было выровнено для
+ * SIMD инструкций. */
+gdouble
+hyscan_convolution_plan_cost (guint32  image_size,
+                              guint32  line_size,
+                              guint32  fft_size,
+                              guint32 *hop_size,
+                              guint32 *n_parts)
+{
+  gdouble fft_cost;
+  gdouble n_blocks;
+  gdouble n_fft;
+  guint32 hop;
+  guint32 parts;
+
+  if ((image_size + 3) <= fft_size)
+    {
+      hop = ((fft_size - image_size + 1) / 4) * 4;
+      parts = 1;
+    }
+  else
+    {
+      hop = fft_size / 2;
+      parts = image_size / hop;
+      if (image_size % hop)
+        parts += 1;
+    }
+
+  if (hop_size != NULL)
+    *hop_size = hop;
+  if (n_parts != NULL)
+    *n_parts = parts;
+
+  fft_cost = 5.0 * fft_size * log2 ((gdouble) fft_size);
+
+  /* Для бесконечно длинной строки число блоков прямого и обратного
+   * преобразований одинаково. */
+  if (line_size == 0)
+    return (2.0 * fft_cost + 8.0 * fft_size * parts) / hop;
+
+  n_fft = (line_size + hop - 1) / hop;
+  n_blocks = n_fft + parts - 1;
+
+  return (n_blocks * fft_cost + n_fft * (fft_cost + 8.0 * fft_size * parts)) / line_size;
+}
+
+/* Функция выбирает размер FFT преобразования, при котором оценка
+ * вычислительных затрат минимальна (см. hyscan_convolution_plan_cost). */
+guint32
+hyscan_convolution_plan_optimal_size (guint32  image_size,
+                                      guint32  line_size,
+                                      guint32  max_fft_size,
+                                      guint32 *hop_size)
+{
+  const guint32 *fft_sizes;
+  gdouble min_cost = G_MAXDOUBLE;
+  guint32 fft_size;
+  guint n_sizes;
+  guint i;
+
+  fft_sizes = hyscan_fft_size_list (&n_sizes);
+  fft_size = fft_sizes[0];
+  max_fft_size = hyscan_fft_size_floor (max_fft_size);
+
+  for (i = 0; (i < n_sizes) && (fft_sizes[i] <= max_fft_size); i++)
+    {
+      gdouble cost = hyscan_convolution_plan_cost (image_size, line_size, fft_sizes[i], NULL, NULL);
+
+      if (cost < min_cost)
+        {
+          min_cost = cost;
+          fft_size = fft_sizes[i];
+        }
+    }
+
+  if (hop_size != NULL)
+    hyscan_convolution_plan_cost (image_size, line_size, fft_size, hop_size, NULL);
+
+  return fft_size;
+}
+
+/* Функция возвращает части образа в обычном порядке (см. pffft_zreorder).
+ * Преобразование выполняется один раз при первом обращении. */
+const HyScanComplexFloat *
+hyscan_convolution_plan_get_ordered (HyScanConvolutionPlan *plan)
+{
+  HyScanComplexFloat *ordered_parts;
+  guint32 i;
+
+  g_mutex_lock (&plan->lock);
+
+  if (plan->ordered_parts == NULL)
+    {
+      ordered_parts = pffft_aligned_malloc (plan->n_parts * plan->fft_size * sizeof(HyScanComplexFloat));
+      for (i = 0; i < plan->n_parts; i++)
+        {
+          pffft_zreorder (plan->fft,
+                          (const gfloat*) (plan->parts + i * plan->fft_size),
+                          (gfloat*) (ordered_parts + i * plan->fft_size),
+                          PFFFT_FORWARD);
+        }
+
+      plan->ordered_parts = ordered_parts;
+    }
+
+  ordered_parts = plan->ordered_parts;
+
+  g_mutex_unlock (&plan->lock);
+
+  return ordered_parts;
+}
+
+/* Функция определяет положение полосы пропускания маски, подавляющей
+ * наложение спектров при децимации. Ширина полосы равна fft_size / decimation
+ * отсчётов, а её положение выбирается так, чтобы в неё попадала максимальная
+ * энергия образа. Результат запоминается для последующих вызовов. */
+guint32
+hyscan_convolution_plan_get_mask_start (HyScanConvolutionPlan *plan,
+                                        guint                  decimation)
+{
+  const HyScanComplexFloat *ordered_parts;
+  gdouble *energy;
+  gdouble band_energy;
+  gdouble max_energy;
+  guint32 mask_start;
+  guint32 band_size;
+  guint32 i, j;
+
+  g_mutex_lock (&plan->lock);
+  if (plan->mask_decimation == decimation)
+    {
+      mask_start = plan->mask_start;
+      g_mutex_unlock (&plan->lock);
+
+      return mask_start;
+    }
+  g_mutex_unlock (&plan->lock);
+
+  ordered_parts = hyscan_convolution_plan_get_ordered (plan);
+
+  /* Энергия образа на каждой частоте. */
+  energy = g_new0 (gdouble, plan->fft_size);
+  for (i = 0; i < plan->n_parts; i++)
+    {
+      const HyScanComplexFloat *part = ordered_parts + i * plan->fft_size;
+
+      for (j = 0; j < plan->fft_size; j++)
+        energy[j] += part[j].re * part[j].re + part[j].im * part[j].im;
+    }
+
+  /* Ищем положение полосы с максимальной энергией, полоса может
+   * переходить через границу спектра. */
+  band_size = plan->fft_size / decimation;
+  band_energy = 0.0;
+  for (j = 0; j < band_size; j++)
+    band_energy += energy[j];
+
+  max_energy = band_energy;
+  mask_start = 0;
+  for (j = 1; j < plan->fft_size; j++)
+    {
+      band_energy += energy[(j + band_size - 1) % plan->fft_size] - energy[j - 1];
+      if (band_energy > max_energy)
+        {
+          max_energy = band_energy;
+          mask_start = j;
+        }
+    }
+
+  g_free (energy);
+
+  g_mutex_lock (&plan->lock);
+  plan->mask_decimation = decimation;
+  plan->mask_start = mask_start;
+  g_mutex_unlock (&plan->lock);
+
+  return mask_start;
+}
@@ -0,0 +1,100 @@
+/* hyscan-convolution-plan.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+
+/* Внутренние функции, общие для классов HyScanConvolution и
+ * HyScanConvolutionImage: план свёртки (разбиение данных и образа на блоки
+ * для FFT преобразования определённого размера) и доступ к планам образа. */
+
+#ifndef __HYSCAN_CONVOLUTION_PLAN_H__
+#define __HYSCAN_CONVOLUTION_PLAN_H__
+
+#include "hyscan-convolution-image.h"
+#include "pffft.h"
+
+G_BEGIN_DECLS
+
+/* Максимальный размер FFT преобразования по умолчанию. */
+#define HYSCAN_CONVOLUTION_DEFAULT_MAX_FFT_SIZE   65536
+
+typedef struct _HyScanConvolutionPlan HyScanConvolutionPlan;
+
+struct _HyScanConvolutionPlan
+{
+  PFFFT_Setup                 *fft;            /* Коэффициенты преобразования Фурье. */
+  guint32                      fft_size;       /* Размер преобразования Фурье. */
+  guint32                      hop_size;       /* Шаг между блоками данных. */
+
+  HyScanComplexFloat          *parts;          /* Части образа в частотной области. */
+  guint32                      n_parts;        /* Число частей образа. */
+  gfloat                       scale;          /* Коэффициент масштабирования свёртки. */
+
+  GMutex                       lock;           /* Блокировка вспомогательных данных. */
+  HyScanComplexFloat          *ordered_parts;  /* Части образа в обычном порядке. */
+  guint                        mask_decimation;/* Коэффициент децимации для маски образа. */
+  guint32                      mask_start;     /* Начальный индекс полосы пропускания маски. */
+};
+
+HyScanConvolutionPlan *    hyscan_convolution_plan_new                 (const HyScanComplexFloat      *image,
+                                                                        guint32                        n_points,
+                                                                        guint32                        fft_size,
+                                                                        gboolean                       frequency_domain);
+
+void                       hyscan_convolution_plan_free                (gpointer                       data);
+
+gdouble                    hyscan_convolution_plan_cost                (guint32                        image_size,
+                                                                        guint32                        line_size,
+                                                                        guint32                        fft_size,
+                                                                        guint32                       *hop_size,
+                                                                        guint32                       *n_parts);
+
+guint32                    hyscan_convolution_plan_optimal_size        (guint32                        image_size,
+                                                                        guint32                        line_size,
+                                                                        guint32                        max_fft_size,
+                                                                        guint32                       *hop_size);
+
+const HyScanComplexFloat * hyscan_convolution_plan_get_ordered         (HyScanConvolutionPlan         *plan);
+
+guint32                    hyscan_convolution_plan_get_mask_start      (HyScanConvolutionPlan         *plan,
+                                                                        guint                          decimation);
+
+HyScanConvolutionPlan *    hyscan_convolution_image_get_plan           (HyScanConvolutionImage        *image,
+                                                                        guint32                        line_size);
+
+void                       hyscan_convolution_image_prepare_background (HyScanConvolutionImage        *image);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CONVOLUTION_PLAN_H__ */
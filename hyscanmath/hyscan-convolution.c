@@ -50,58 +50,113 @@
  * работы с объектом.
  *
  * Образ свёртки в частотной области должен иметь определённый размер. Функция
+ * #hyscan_convolution_get_fft_size возвращает допустимый размер.
  *
+ * Класс поддерживает установку сразу нескольких образов. Каждый образ
+ * использует собственный размер FFT преобразования, поэтому свёртка с
+ * коротким образом выполняется преобразованием небольшого размера, даже
+ * если в этом же объекте установлен длинный образ.
  *
- * Класс поддерживает установку сразу нескольких образов, при условии что они
- * имеют одинаковый размер. Определяющим является размер для образа с номером 0.
+ * Для образов во временной области размер FFT преобразования и шаг между
+ * блоками данных выбираются по длине образа и строки данных так, чтобы
+ * число операций на один отсчёт результата было минимальным (см.
+ * #hyscan_convolution_get_optimal_fft_size). Для короткого образа размером M
+ * обычно используется преобразование размером N, значительно большим 2M,
+ * и шаг N - M + 1.
+ *
+ * Размер FFT преобразования ограничен значением, задаваемым функцией
+ * #hyscan_convolution_set_max_fft_size. Если образ не помещается в такое
+ * преобразование, он разбивается на несколько частей одинакового размера,
+ * а свёртка выполняется по схеме "overlap-save" с линией задержки в
+ * частотной области: спектр каждого блока данных используется всеми
+ * частями образа. Таким образом размер образа ограничен только объёмом
+ * памяти, а размер FFT преобразования остаётся небольшим.
+ *
+ * Образ во временной области не преобразуется при установке: прямое
+ * преобразование Фурье выполняется при первой свёртке с ним, поэтому
+ * установка образа не задерживает поток, в котором она выполняется, а
+ * образы, которые не используются, не преобразуются вовсе. Преобразование
+ * можно выполнить заранее функцией #hyscan_convolution_image_prepare или
+ * в фоновом потоке (см. #hyscan_convolution_set_background_fft).
+ *
+ * Образ в частотной области можно подготовить заранее в виде объекта
+ * #HyScanConvolutionImage и использовать его в нескольких объектах свёртки
+ * одновременно (см. #hyscan_convolution_set_image). Такой образ не
+ * изменяется после создания, а его установка не требует ни выделения
+ * памяти, ни вычислений.
  *
  * Функция #hyscan_convolution_convolve выполняет свертку данных.
  *
- * HyScanConvolution не поддерживает работу в многопоточном режиме.
+ * Для оценки задержки между сигналами предназначена функция
+ * #hyscan_convolution_find_peaks. Она находит наибольшие пики амплитуды
+ * свёртки с уточнением их положения между отсчётами, не сохраняя результат
+ * свёртки целиком. Функция #hyscan_convolution_find_peaks_batch выполняет
+ * такой поиск для нескольких строк за один вызов.
+ *
+ * Для данных с движущегося носителя предназначен банк образов ЛЧМ сигнала
+ * с различными доплеровскими сдвигами (#hyscan_convolution_set_doppler_bank).
+ * Функция #hyscan_convolution_convolve_bank выполняет свёртку со всеми
+ * образами банка, используя одно прямое преобразование Фурье данных, и
+ * возвращает карту задержка-доплер или наибольшую амплитуду для каждого
+ * отсчёта.
+ *
+ * Функции #hyscan_convolution_convolve_async и
+ * #hyscan_convolution_convolve_finish позволяют выполнить свёртку в
+ * отдельном потоке, не блокируя поток получения данных. Задания
+ * выполняются в порядке поступления, а размер очереди ограничен (см.
+ * #hyscan_convolution_set_queue_depth). Если очередь заполнена, задание не
+ * принимается.
+ *
+ * Для действительных данных (без квадратурной демодуляции) предназначена функция
+ * #hyscan_convolution_convolve_real. Она использует FFT преобразование
+ * действительных данных, что вдвое уменьшает объём обрабатываемых данных
+ * и число операций прямого преобразования.
+ *
+ * Если нужна только амплитуда результата, используются функции
+ * #hyscan_convolution_convolve_amplitude и #hyscan_convolution_convolve_db.
+ * Они вычисляют огибающую сразу после обратного преобразования и не
+ * записывают комплексный результат свёртки.
+ *
+ * Если нужна только часть результата, например в пределах строба дальности
+ * около ожидаемого эхосигнала, используется функция
+ * #hyscan_convolution_convolve_gated. Она выполняет преобразования Фурье
+ * только для блоков данных, влияющих на заданные интервалы (#HyScanConvolutionGate),
+ * и может обработать несколько интервалов за один вызов.
+ *
+ * HyScanConvolution не поддерживает работу в многопоточном режиме, за
+ * исключением асинхронных заданий, которые используют собственные буферы. Объект
+ * #HyScanConvolutionImage можно использовать из нескольких потоков.
  */
 
 #include "hyscan-convolution.h"
+#include "hyscan-convolution-plan.h"
+#include "hyscan-signal.h"
+#include "hyscan-fft-size.h"
 
 #include <math.h>
 #include <string.h>
-#include "pffft.h"
 
 #ifdef HYSCAN_OPEN_MP
 #include <omp.h>
 #endif
 
-typedef enum
-{
-  HYSCAN_CONVOLUTION_IMAGE_TD,
-  HYSCAN_CONVOLUTION_IMAGE_FD
-} HyScanConvolutionImageType;
-
-/* Таблица доспустимых размеров FFT преобразований. */
-static guint
-fft_sizes[] = {32, 64, 96, 128, 160, 192, 256, 288, 320, 384, 480, 512, 576, 640, 768,
-               800, 864, 960, 1024, 1152, 1280, 1440, 1536, 1600, 1728, 1920, 2048, 2304,
-               2400, 2560, 2592, 2880, 3072, 3200, 3456, 3840, 4000, 4096, 4320, 4608,
-               4800, 5120, 5184, 5760, 6144, 6400, 6912, 7200, 7680, 7776, 8000, 8192,
-               8640, 9216, 9600, 10240, 10368, 11520, 12000, 12288, 12800, 12960, 13824,
-               14400, 15360, 15552, 16000, 16384, 17280, 18432, 19200, 20000, 20480, 20736,
-               21600, 23040, 23328, 24000, 24576, 25600, 25920, 27648, 28800, 30720, 31104,
-               32000, 32768, 34560, 36000, 36864, 38400, 38880, 40000, 40960, 41472, 43200,
-               46080, 46656, 48000, 49152, 51200, 51840, 55296, 57600, 60000, 61440, 62208,
-               64000, 64800, 65536, 69120, 69984, 72000, 73728, 76800, 77760, 80000, 81920,
-               82944, 86400, 92160, 93312, 96000, 98304, 100000, 102400, 103680, 108000,
-               110592, 115200, 116640, 120000, 122880, 124416, 128000, 129600, 131072,
-               138240, 139968, 144000, 147456, 153600, 155520, 160000, 163840, 165888,
-               172800, 180000, 184320, 186624, 192000, 194400, 196608, 200000, 204800,
-               207360, 209952, 216000, 221184, 230400, 233280, 240000, 245760, 248832,
-               256000, 259200, 262144, 276480, 279936, 288000, 294912, 300000, 307200,
-               311040, 320000, 324000, 327680, 331776, 345600, 349920, 360000, 368640,
-               373248, 384000, 388800, 393216, 400000, 409600, 414720, 419904, 432000,
-               442368, 460800, 466560, 480000, 491520, 497664, 500000, 512000, 518400,
-               524288, 540000, 552960, 559872, 576000, 583200, 589824, 600000, 614400,
-               622080, 629856, 640000, 648000, 655360, 663552, 691200, 699840, 720000,
-               737280, 746496, 768000, 777600, 786432, 800000, 819200, 829440, 839808,
-               864000, 884736, 900000, 921600, 933120, 960000, 972000, 983040, 995328,
-               1000000, 1024000, 1036800, 1048576};
+/* Проверка выравнивания данных для SIMD инструкций библиотеки pffft. */
+#define HYSCAN_CONVOLUTION_IS_ALIGNED(ptr)  ((((gsize) (ptr)) & 0xF) == 0)
+
+/* Максимальное число асинхронных заданий в очереди по умолчанию. */
+#define HYSCAN_CONVOLUTION_DEFAULT_QUEUE_DEPTH    4
+
+/* Асинхронное задание свёртки. */
+typedef struct
+{
+  HyScanConvolutionImage      *image;          /* Образ для свёртки. */
+  const HyScanComplexFloat    *data;           /* Данные для свёртки. */
+  HyScanComplexFloat          *output;         /* Буфер для результата свёртки. */
+  guint32                      n_points;       /* Размер данных в точках. */
+  gfloat                       scale;          /* Коэффициент масштабирования свёртки. */
+  GAsyncReadyCallback          callback;       /* Функция, вызываемая по завершении свёртки. */
+  gpointer                     user_data;      /* Пользовательские данные для функции callback. */
+} HyScanConvolutionJob;
 
 /* Внутренние данные объекта. */
 struct _HyScanConvolutionPrivate
@@ -111,23 +166,98 @@ struct _HyScanConvolutionPrivate
   HyScanComplexFloat          *wbuff;          /* Буфер для обработки данных. */
   guint32                      max_points;     /* Максимальное число точек помещающихся в буферах. */
 
-  PFFFT_Setup                 *fft;            /* Коэффициенты преобразования Фурье. */
-  guint32                      fft_size;       /* Размер преобразования Фурье. */
-  gfloat                       fft_scale;      /* Коэффициент масштабирования свёртки. */
+  GHashTable                  *setups;         /* Вспомогательные коэффициенты преобразований Фурье. */
+  guint32                      max_fft_size;   /* Максимальный размер преобразования Фурье. */
   GHashTable                  *fft_images;     /* Образы для свёртки. */
-};
-
-static void      hyscan_convolution_object_constructed   (GObject                    *object);
-static void      hyscan_convolution_object_finalize      (GObject                    *object);
+  gboolean                     background;     /* Подготовка образов в фоновом потоке. */
 
-static void      hyscan_convolution_realloc_buffers      (HyScanConvolutionPrivate   *priv,
-                                                          guint32                     n_points);
+  GThreadPool                 *pool;           /* Поток выполнения асинхронных заданий. */
+  HyScanConvolution           *worker;         /* Объект свёртки для асинхронных заданий. */
+  GMutex                       queue_lock;     /* Блокировка очереди заданий. */
+  guint                        queue_depth;    /* Максимальное число заданий в очереди. */
+  guint                        n_queued;       /* Текущее число заданий в очереди. */
+};
 
-static gboolean  hyscan_convolution_set_image            (HyScanConvolutionPrivate   *priv,
-                                                          guint                       index,
-                                                          HyScanConvolutionImageType  type,
-                                                          const HyScanComplexFloat   *image,
-                                                          guint32                     n_points);
+static void      hyscan_convolution_object_constructed    (GObject                       *object);
+static void      hyscan_convolution_object_finalize       (GObject                       *object);
+
+static void      hyscan_convolution_realloc_buffers       (HyScanConvolutionPrivate      *priv,
+                                                           guint32                        n_points);
+
+static PFFFT_Setup *
+                 hyscan_convolution_get_setup             (HyScanConvolutionPrivate      *priv,
+                                                           guint32                        fft_size,
+                                                           pffft_transform_t              transform);
+
+static HyScanConvolutionPlan *
+                 hyscan_convolution_lookup                (HyScanConvolutionPrivate      *priv,
+                                                           guint                          index,
+                                                           guint32                        n_points);
+
+static guint32   hyscan_convolution_forward               (HyScanConvolutionPrivate      *priv,
+                                                           HyScanConvolutionPlan         *plan,
+                                                           const HyScanComplexFloat      *data,
+                                                           guint32                        n_points);
+
+static void      hyscan_convolution_multiply              (HyScanConvolutionPrivate      *priv,
+                                                           HyScanConvolutionPlan         *plan,
+                                                           guint32                        block,
+                                                           HyScanComplexFloat            *spectrum,
+                                                           gfloat                         scale);
+
+static gboolean  hyscan_convolution_convolve_complex      (HyScanConvolutionPrivate      *priv,
+                                                           guint                          index,
+                                                           const HyScanComplexFloat      *data,
+                                                           HyScanComplexFloat            *output,
+                                                           guint32                        n_points,
+                                                           gfloat                         scale);
+
+static gboolean  hyscan_convolution_convolve_envelope     (HyScanConvolutionPrivate      *priv,
+                                                           guint                          index,
+                                                           const HyScanComplexFloat      *data,
+                                                           gfloat                        *output,
+                                                           guint32                        n_points,
+                                                           gfloat                         scale,
+                                                           gboolean                       db,
+                                                           gfloat                         floor_db);
+
+static void      hyscan_convolution_real_accumulate       (const gfloat                  *spectrum,
+                                                           const HyScanComplexFloat      *image,
+                                                           HyScanComplexFloat            *result,
+                                                           guint32                        fft_size,
+                                                           gfloat                         scale);
+
+static void      hyscan_convolution_peak_interpolate      (gfloat                         a,
+                                                           gfloat                         b,
+                                                           gfloat                         c,
+                                                           HyScanConvolutionPeakInterpolation interpolation,
+                                                           gdouble                       *delta,
+                                                           gfloat                        *amplitude);
+
+static void      hyscan_convolution_peak_insert           (HyScanConvolutionPeak         *peaks,
+                                                           guint                         *n_found,
+                                                           guint                          n_peaks,
+                                                           gdouble                        offset,
+                                                           gfloat                         amplitude);
+
+static gboolean  hyscan_convolution_peaks                 (HyScanConvolutionPrivate      *priv,
+                                                           guint                          index,
+                                                           const HyScanComplexFloat      *data,
+                                                           guint32                        n_points,
+                                                           gfloat                         scale,
+                                                           HyScanConvolutionPeakInterpolation interpolation,
+                                                           HyScanConvolutionPeak         *peaks,
+                                                           guint                          n_peaks,
+                                                           guint                         *n_found);
+
+static void      hyscan_convolution_job_free              (gpointer                       data);
+
+static void      hyscan_convolution_job_run               (gpointer                       data,
+                                                           gpointer                       user_data);
+
+static void      hyscan_convolution_job_ready             (GObject                       *source,
+                                                           GAsyncResult                  *result,
+                                                           gpointer                       user_data);
 
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanConvolution, hyscan_convolution, G_TYPE_OBJECT);
 
@@ -152,7 +282,12 @@ hyscan_convolution_object_constructed (GObject *object)
   HyScanConvolution *convolution = HYSCAN_CONVOLUTION (object);
   HyScanConvolutionPrivate *priv = convolution->priv;
 
-  priv->fft_images = g_hash_table_new_full (NULL, NULL, NULL, pffft_aligned_free);
+  priv->max_fft_size = HYSCAN_CONVOLUTION_DEFAULT_MAX_FFT_SIZE;
+  priv->fft_images = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  priv->setups = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) pffft_destroy_setup);
+
+  g_mutex_init (&priv->queue_lock);
+  priv->queue_depth = HYSCAN_CONVOLUTION_DEFAULT_QUEUE_DEPTH;
 }
 
 static void
@@ -161,12 +296,21 @@ hyscan_convolution_object_finalize (GObject *object)
   HyScanConvolution *convolution = HYSCAN_CONVOLUTION (object);
   HyScanConvolutionPrivate *priv = convolution->priv;
 
+  /* Каждое задание удерживает ссылку на объект, поэтому к этому моменту
+   * очередь пуста. Поток может ещё не завершить освобождение последнего
+   * задания, поэтому его окончания не ждём. */
+  if (priv->pool != NULL)
+    g_thread_pool_free (priv->pool, FALSE, FALSE);
+  g_clear_object (&priv->worker);
+
+  g_mutex_clear (&priv->queue_lock);
+
   pffft_aligned_free (priv->ibuff);
   pffft_aligned_free (priv->obuff);
   pffft_aligned_free (priv->wbuff);
 
   g_hash_table_unref (priv->fft_images);
-  g_clear_pointer (&priv->fft, pffft_destroy_setup);
+  g_hash_table_unref (priv->setups);
 
   G_OBJECT_CLASS (hyscan_convolution_parent_class)->finalize (object);
 }
@@ -188,126 +332,621 @@ hyscan_convolution_realloc_buffers (HyScanConvolutionPrivate *priv,
     }
 }
 
-/* Функция задаёт образ для свёртки. */
-static gboolean
-hyscan_convolution_set_image (HyScanConvolutionPrivate   *priv,
-                              guint                       index,
-                              HyScanConvolutionImageType  type,
-                              const HyScanComplexFloat   *image,
-                              guint32                     n_points)
-{
-  HyScanComplexFloat *fft_image;
-  guint32 conv_size;
-  guint32 fft_size;
-  guint32 i;
+/* Функция возвращает коэффициенты преобразования Фурье указанного размера
+ * и типа. Коэффициенты создаются один раз при первом обращении. */
+static PFFFT_Setup *
+hyscan_convolution_get_setup (HyScanConvolutionPrivate *priv,
+                              guint32                   fft_size,
+                              pffft_transform_t         transform)
+{
+  PFFFT_Setup *setup;
+  gpointer key;
 
-  /* Очищаем текущий образ. */
-  if (index == 0)
-    g_hash_table_remove_all (priv->fft_images);
-  else
-    g_hash_table_remove (priv->fft_images, GINT_TO_POINTER (index));
+  key = GUINT_TO_POINTER (2 * fft_size + ((transform == PFFFT_REAL) ? 1 : 0));
+  setup = g_hash_table_lookup (priv->setups, key);
+  if (setup == NULL)
+    {
+      setup = pffft_new_setup (fft_size, transform);
+      if (setup != NULL)
+        g_hash_table_insert (priv->setups, key, setup);
+    }
 
-  /* Пользователь отменил свёртку. */
-  if (image == NULL)
-    return TRUE;
+  return setup;
+}
+
+/* Функция возвращает план свёртки с образом указанного номера для строки
+ * размером n_points. */
+static HyScanConvolutionPlan *
+hyscan_convolution_lookup (HyScanConvolutionPrivate *priv,
+                           guint                     index,
+                           guint32                   n_points)
+{
+  HyScanConvolutionImage *image;
+
+  image = g_hash_table_lookup (priv->fft_images, GINT_TO_POINTER (index));
 
-  /* Ищем оптимальный размер свёртки для библиотеки pffft (см. pffft.h).
-   * Для образа во временной области размер FFT преобразования увеличиваем в
-   * два раза. А для частотной области размер образа должен быть точно равен
-   * размеру FFT преобразования. */
-  conv_size = (type == HYSCAN_CONVOLUTION_IMAGE_TD) ? 2 * n_points : n_points;
-  fft_size = hyscan_convolution_get_fft_size (conv_size);
-  if (fft_size == 0)
+  return (image != NULL) ? hyscan_convolution_image_get_plan (image, n_points) : NULL;
+}
+
+/* Функция выполняет прямое преобразование Фурье всех блоков данных,
+ * необходимых для свёртки с образом. Функция возвращает число блоков
+ * результата.
+ *
+ * Свертка выполняется блоками по fft_size элементов, при этом каждый
+ * следующий блок смещен относительно предыдущего на hop_size элементов
+ * (см. hyscan_convolution_plan_cost). Над входными данными производится прямое преобразование
+ * Фурье с сохранением результата в obuff, но уже без перекрытия, т.е.
+ * с шагом fft_size. Затем производится перемножение
+ * ("свертка") с нужным образом и обратное преобразование Фурье. Так как
+ * операции над блоками происходят независимо друг от друга этот процесс
+ * можно выполнять параллельно, что и производится за счет использования
+ * библиотеки OpenMP.
+ *
+ * Если образ разбит на части, результат для блока с номером i является
+ * суммой произведений спектров блоков данных с номерами i + j и частей
+ * образа с номерами j. Спектры блоков данных при этом вычисляются один
+ * раз и используются всеми частями образа ("линия задержки" в частотной
+ * области). */
+static guint32
+hyscan_convolution_forward (HyScanConvolutionPrivate      *priv,
+                            HyScanConvolutionPlan         *plan,
+                            const HyScanComplexFloat      *data,
+                            guint32                        n_points)
+{
+  guint32 full_size;
+  guint32 hop_size;
+  guint32 staged;
+  gint32 n_direct;
+  gint32 n_blocks;
+  gint32 n_fft;
+  gint32 i;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
+
+  /* Число блоков преобразования Фурье над одной строкой. */
+  n_fft = (n_points / hop_size);
+  if (n_points % hop_size)
+    n_fft += 1;
+
+  /* Число блоков входных данных с учётом частей образа. */
+  n_blocks = n_fft + plan->n_parts - 1;
+
+  /* Обновляем буферы. */
+  hyscan_convolution_realloc_buffers (priv, n_blocks * full_size);
+
+  /* Если данные пользователя выровнены, полные блоки преобразуются прямо
+   * из его буфера. Во входной буфер копируется только конец строки, который
+   * необходимо дополнить нулями. */
+  n_direct = 0;
+  if (HYSCAN_CONVOLUTION_IS_ALIGNED (data) && (n_points >= full_size))
+    n_direct = (n_points - full_size) / hop_size + 1;
+
+  /* Остальные блоки формируются во входном буфере: копируем в него конец
+   * данных и зануляем буфер до конца последнего блока. Блок с номером
+   * n_direct начинается с начала буфера. */
+  if (n_direct < n_blocks)
     {
-      g_warning ("HyScanConvolution: fft size too big");
-      return FALSE;
+      guint32 staged_end = (n_blocks - n_direct - 1) * hop_size + full_size;
+
+      staged = n_points - n_direct * hop_size;
+
+      memcpy (priv->ibuff,
+              data + n_direct * hop_size,
+              staged * sizeof(HyScanComplexFloat));
+
+      if (staged_end > staged)
+        {
+          memset (priv->ibuff + staged,
+                  0,
+                  (staged_end - staged) * sizeof(HyScanComplexFloat));
+        }
     }
-  else if ((type == HYSCAN_CONVOLUTION_IMAGE_FD) && (conv_size != fft_size))
+
+  /* Прямое преобразование Фурье. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_blocks; i++)
     {
-      g_warning ("HyScanConvolution: image size mismatch with fft size");
-      return FALSE;
+      const HyScanComplexFloat *block;
+
+      if (i < n_direct)
+        block = data + i * hop_size;
+      else
+        block = priv->ibuff + (i - n_direct) * hop_size;
+
+      pffft_transform (plan->fft,
+                       (const gfloat*) block,
+                       (gfloat*) (priv->obuff + (i * full_size)),
+                       (gfloat*) (priv->wbuff + (i * full_size)),
+                       PFFFT_FORWARD);
     }
 
-  /* Параметры преобразования Фурье. */
-  if (index == 0)
+  return n_fft;
+}
+
+/* Функция вычисляет спектр блока результата, для которого первый спектр
+ * блока входных данных находится в obuff под номером block. Спектр
+ * представлен во внутреннем порядке PFFFT. */
+static void
+hyscan_convolution_multiply (HyScanConvolutionPrivate      *priv,
+                             HyScanConvolutionPlan         *plan,
+                             guint32                        block,
+                             HyScanComplexFloat            *spectrum,
+                             gfloat                         scale)
+{
+  guint32 full_size = plan->fft_size;
+  guint32 i;
+
+  /* Обнуляем буфер результата, т.к. функция zconvolve_accumulate добавляет
+   * полученный результат к значениям в этом буфере (нам это не нужно). */
+  memset (spectrum, 0, full_size * sizeof(HyScanComplexFloat));
+
+  /* Выполняем свёртку со всеми частями образа. */
+  for (i = 0; i < plan->n_parts; i++)
     {
-      if (priv->fft_size != fft_size)
-        {
-          g_clear_pointer (&priv->fft, pffft_destroy_setup);
+      pffft_zconvolve_accumulate (plan->fft,
+                                  (const gfloat*) (priv->obuff + (block + i) * full_size),
+                                  (const gfloat*) (plan->parts + i * full_size),
+                                  (gfloat*) spectrum,
+                                  scale * plan->scale);
+    }
+}
 
-          priv->fft = pffft_new_setup (fft_size, PFFFT_COMPLEX);
-          if (priv->fft == NULL)
-            {
-              g_warning ("HyScanConvolution: can't setup fft");
-              return FALSE;
-            }
+/* Функция выполняет свёртку комплексных данных. Массивы data и output
+ * могут совпадать, т.к. входные данные используются только при прямом
+ * преобразовании Фурье. */
+static gboolean
+hyscan_convolution_convolve_complex (HyScanConvolutionPrivate *priv,
+                                     guint                     index,
+                                     const HyScanComplexFloat *data,
+                                     HyScanComplexFloat       *output,
+                                     guint32                   n_points,
+                                     gfloat                    scale)
+{
+  HyScanConvolutionPlan *plan;
+
+  guint32 full_size;
+  guint32 hop_size;
+  gint32 n_fft;
+  gint32 i;
+
+  /* Образ свёртки. */
+  plan = hyscan_convolution_lookup (priv, index, n_points);
+  if (plan == NULL)
+    return FALSE;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
+
+  /* Прямое преобразование Фурье. */
+  n_fft = hyscan_convolution_forward (priv, plan, data, n_points);
+
+  /* Свёртка и обратное преобразование Фурье. Результат каждого блока
+   * помещается в wbuff, в нём нам нужны только первые hop_size
+   * элементов. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_fft; i++)
+    {
+      guint32 offset = i * full_size;
+      guint32 used_size = MIN ((n_points - i * hop_size), hop_size);
+
+      /* Выполняем свёртку. Спектры блоков данных в obuff не изменяются,
+       * т.к. используются соседними блоками. */
+      hyscan_convolution_multiply (priv, plan, i, priv->wbuff + offset, scale);
+
+      /* Выполняем обратное преобразование Фурье. Спектр находится во
+       * внутреннем порядке PFFFT, поэтому используется неупорядоченное
+       * преобразование, результат которого во временной области
+       * представлен в обычном порядке. */
+      pffft_transform (plan->fft,
+                       (gfloat*) (priv->wbuff + offset),
+                       (gfloat*) (priv->wbuff + offset),
+                       (gfloat*) (priv->ibuff + offset),
+                       PFFFT_BACKWARD);
+
+      /* Копируем результат в буфер пользователя. */
+      memcpy (output + i * hop_size,
+              priv->wbuff + offset,
+              used_size * sizeof (HyScanComplexFloat));
+    }
+
+  return TRUE;
+}
+
+/* Функция выполняет свёртку и вычисляет огибающую результата. Огибающая
+ * вычисляется сразу после обратного преобразования Фурье каждого блока, без
+ * записи комплексного результата в буфер пользователя. */
+static gboolean
+hyscan_convolution_convolve_envelope (HyScanConvolutionPrivate *priv,
+                                      guint                     index,
+                                      const HyScanComplexFloat *data,
+                                      gfloat                   *output,
+                                      guint32                   n_points,
+                                      gfloat                    scale,
+                                      gboolean                  db,
+                                      gfloat                    floor_db)
+{
+  HyScanConvolutionPlan *plan;
+
+  guint32 full_size;
+  guint32 hop_size;
+  gint32 n_fft;
+  gint32 i;
+
+  /* Образ свёртки. */
+  plan = hyscan_convolution_lookup (priv, index, n_points);
+  if (plan == NULL)
+    return FALSE;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
 
-          priv->fft_size = fft_size;
+  /* Прямое преобразование Фурье. */
+  n_fft = hyscan_convolution_forward (priv, plan, data, n_points);
+
+  /* Свёртка, обратное преобразование Фурье и вычисление огибающей. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_fft; i++)
+    {
+      HyScanComplexFloat *block = priv->ibuff + i * full_size;
+      gfloat *envelope = output + i * hop_size;
+      guint32 used_size = MIN ((n_points - i * hop_size), hop_size);
+      guint32 j;
+
+      hyscan_convolution_multiply (priv, plan, i, block, scale);
 
-          /* Обновляем буферы. */
-          hyscan_convolution_realloc_buffers (priv, 16 * priv->fft_size);
+      pffft_transform (plan->fft,
+                       (gfloat*) block,
+                       (gfloat*) block,
+                       (gfloat*) (priv->wbuff + i * full_size),
+                       PFFFT_BACKWARD);
 
-          /* Коэффициент масштабирования свёртки. */
-          priv->fft_scale = 1.0 / ((gfloat) priv->fft_size * (gfloat) n_points);
+      /* Амплитуда в дБ вычисляется по мощности, без извлечения корня. */
+      if (db)
+        {
+          for (j = 0; j < used_size; j++)
+            {
+              gfloat power = block[j].re * block[j].re + block[j].im * block[j].im;
+              gfloat level = (power > 0.0f) ? 10.0f * log10f (power) : floor_db;
+
+              envelope[j] = MAX (level, floor_db);
+            }
+        }
+      else
+        {
+          for (j = 0; j < used_size; j++)
+            envelope[j] = sqrtf (block[j].re * block[j].re + block[j].im * block[j].im);
         }
     }
-  else if (priv->fft_size != fft_size)
+
+  return TRUE;
+}
+
+/* Функция добавляет к результату произведение спектра действительных данных
+ * и образа свёртки. Спектр действительных данных задан в упакованном виде
+ * (см. pffft.h): первая пара содержит отсчёты нулевой частоты и частоты
+ * Найквиста, далее следуют отсчёты положительных частот. Отсчёты
+ * отрицательных частот восстанавливаются из условия сопряжённой симметрии.
+ * Образ и результат представлены в обычном порядке. */
+static void
+hyscan_convolution_real_accumulate (const gfloat             *spectrum,
+                                    const HyScanComplexFloat *image,
+                                    HyScanComplexFloat       *result,
+                                    guint32                   fft_size,
+                                    gfloat                    scale)
+{
+  const HyScanComplexFloat *half = (const HyScanComplexFloat *) spectrum;
+  guint32 half_size = fft_size / 2;
+  guint32 i;
+
+  /* Нулевая частота и частота Найквиста. */
+  result[0].re += scale * spectrum[0] * image[0].re;
+  result[0].im += scale * spectrum[0] * image[0].im;
+  result[half_size].re += scale * spectrum[1] * image[half_size].re;
+  result[half_size].im += scale * spectrum[1] * image[half_size].im;
+
+  for (i = 1; i < half_size; i++)
     {
-      g_warning ("HyScanConvolution: fft size mismatch");
-      return FALSE;
+      guint32 k = fft_size - i;
+      gfloat re = scale * half[i].re;
+      gfloat im = scale * half[i].im;
+
+      /* Положительные частоты. */
+      result[i].re += re * image[i].re - im * image[i].im;
+      result[i].im += re * image[i].im + im * image[i].re;
+
+      /* Отрицательные частоты. */
+      result[k].re += re * image[k].re + im * image[k].im;
+      result[k].im += re * image[k].im - im * image[k].re;
     }
+}
+
+/* Функция уточняет положение и амплитуду пика по трём соседним отсчётам
+ * амплитуды a, b, c, где b - максимальный отсчёт. */
+static void
+hyscan_convolution_peak_interpolate (gfloat                              a,
+                                     gfloat                              b,
+                                     gfloat                              c,
+                                     HyScanConvolutionPeakInterpolation  interpolation,
+                                     gdouble                            *delta,
+                                     gfloat                             *amplitude)
+{
+  gdouble denom;
+  gdouble shift;
 
-  /* Буфер для образа в частотной области. */
-  fft_image = pffft_aligned_malloc (priv->fft_size * sizeof(HyScanComplexFloat));
+  *delta = 0.0;
+  *amplitude = b;
 
-  /* Подготавливаем образ во временной области к свёртке и
-   * делаем его комплексно сопряжённым. */
-  if (type == HYSCAN_CONVOLUTION_IMAGE_TD)
+  /* Гауссиана соответствует параболе для логарифма амплитуды. */
+  if ((interpolation == HYSCAN_CONVOLUTION_PEAK_GAUSSIAN) && (a > 0.0f) && (c > 0.0f))
     {
-      HyScanComplexFloat *image_buff;
+      gdouble la = log (a);
+      gdouble lb = log (b);
+      gdouble lc = log (c);
 
-      image_buff = pffft_aligned_malloc (priv->fft_size * sizeof(HyScanComplexFloat));
-      memset (image_buff, 0, priv->fft_size * sizeof(HyScanComplexFloat));
-      memcpy (image_buff, image, n_points * sizeof(HyScanComplexFloat));
+      denom = la - 2.0 * lb + lc;
+      if (denom >= 0.0)
+        return;
 
-      pffft_transform_ordered (priv->fft,
-                               (const gfloat*) image_buff,
-                               (gfloat*) image_buff,
-                               (gfloat*) priv->wbuff,
-                               PFFFT_FORWARD);
+      shift = CLAMP (0.5 * (la - lc) / denom, -0.5, 0.5);
+      *delta = shift;
+      *amplitude = exp (lb - 0.25 * (la - lc) * shift);
+
+      return;
+    }
+
+  denom = a - 2.0 * b + c;
+  if (denom >= 0.0)
+    return;
+
+  shift = CLAMP (0.5 * (a - c) / denom, -0.5, 0.5);
+  *delta = shift;
+  *amplitude = b - 0.25 * (a - c) * shift;
+}
+
+/* Функция добавляет пик в список, упорядоченный по убыванию амплитуды. Если
+ * список заполнен, пик с наименьшей амплитудой отбрасывается. */
+static void
+hyscan_convolution_peak_insert (HyScanConvolutionPeak *peaks,
+                                guint                 *n_found,
+                                guint                  n_peaks,
+                                gdouble                offset,
+                                gfloat                 amplitude)
+{
+  guint i;
+
+  if ((*n_found == n_peaks) && (peaks[n_peaks - 1].amplitude >= amplitude))
+    return;
+
+  if (*n_found < n_peaks)
+    *n_found += 1;
+
+  for (i = *n_found - 1; (i > 0) && (peaks[i - 1].amplitude < amplitude); i--)
+    peaks[i] = peaks[i - 1];
+
+  peaks[i].offset = offset;
+  peaks[i].amplitude = amplitude;
+}
+
+/* Функция ищет пики амплитуды результата свёртки. Пики ищутся сразу после
+ * обратного преобразования Фурье каждого блока, поэтому результат свёртки
+ * целиком не сохраняется. Для каждого блока запоминаются наибольшие пики
+ * внутри блока и амплитуды двух крайних отсчётов с каждой стороны. Пики на
+ * границах блоков проверяются после обработки всех блоков. */
+static gboolean
+hyscan_convolution_peaks (HyScanConvolutionPrivate           *priv,
+                          guint                               index,
+                          const HyScanComplexFloat           *data,
+                          guint32                             n_points,
+                          gfloat                              scale,
+                          HyScanConvolutionPeakInterpolation  interpolation,
+                          HyScanConvolutionPeak              *peaks,
+                          guint                               n_peaks,
+                          guint                              *n_found)
+{
+  HyScanConvolutionPlan *plan;
+  HyScanConvolutionPeak *block_peaks;
+  guint *block_found;
+  gfloat *edges;
 
-      for (i = 0; i < priv->fft_size; i++)
-        image_buff[i].im = -image_buff[i].im;
+  guint32 full_size;
+  guint32 hop_size;
+  gint32 n_fft;
+  gint32 i;
+
+  *n_found = 0;
+
+  plan = hyscan_convolution_lookup (priv, index, n_points);
+  if (plan == NULL)
+    return FALSE;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
+
+  n_fft = hyscan_convolution_forward (priv, plan, data, n_points);
+
+  block_peaks = g_new (HyScanConvolutionPeak, n_fft * n_peaks);
+  block_found = g_new0 (guint, n_fft);
+  edges = g_new (gfloat, 4 * n_fft);
+
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_fft; i++)
+    {
+      HyScanComplexFloat *block = priv->wbuff + i * full_size;
+      guint32 used_size = MIN ((n_points - i * hop_size), hop_size);
+      gfloat a, b, c;
+      guint32 j;
+
+      hyscan_convolution_multiply (priv, plan, i, block, scale);
+
+      pffft_transform (plan->fft,
+                       (gfloat*) block,
+                       (gfloat*) block,
+                       (gfloat*) (priv->ibuff + i * full_size),
+                       PFFFT_BACKWARD);
+
+      /* Амплитуды крайних отсчётов блока. */
+      a = sqrtf (block[0].re * block[0].re + block[0].im * block[0].im);
+      b = a;
+      if (used_size > 1)
+        b = sqrtf (block[1].re * block[1].re + block[1].im * block[1].im);
+
+      edges[4 * i + 0] = a;
+      edges[4 * i + 1] = b;
+
+      /* Пики внутри блока. */
+      for (j = 1; j + 1 < used_size; j++)
+        {
+          c = sqrtf (block[j + 1].re * block[j + 1].re + block[j + 1].im * block[j + 1].im);
 
-      pffft_zreorder (priv->fft,
-                      (const gfloat*) image_buff,
-                      (gfloat*) fft_image,
-                      PFFFT_BACKWARD);
+          if ((b > a) && (b >= c))
+            {
+              gdouble delta;
+              gfloat amplitude;
+
+              hyscan_convolution_peak_interpolate (a, b, c, interpolation, &delta, &amplitude);
+              hyscan_convolution_peak_insert (block_peaks + i * n_peaks, &block_found[i], n_peaks,
+                                              i * hop_size + j + delta, amplitude);
+            }
+
+          a = b;
+          b = c;
+        }
 
-      pffft_aligned_free (image_buff);
+      edges[4 * i + 2] = (used_size > 1) ? a : b;
+      edges[4 * i + 3] = b;
     }
 
-  /* Образ в частотной области преобразуем ко внутреннему представлению PFFFT. */
-  else
+  /* Объединяем пики всех блоков. */
+  for (i = 0; i < n_fft; i++)
     {
-      HyScanComplexFloat *image_buff;
+      guint32 used_size = MIN ((n_points - i * hop_size), hop_size);
+      guint32 k;
+
+      for (k = 0; k < block_found[i]; k++)
+        {
+          hyscan_convolution_peak_insert (peaks, n_found, n_peaks,
+                                          block_peaks[i * n_peaks + k].offset,
+                                          block_peaks[i * n_peaks + k].amplitude);
+        }
+
+      /* Пики на границах блоков. Крайние отсчёты строки не проверяются. */
+      for (k = 0; k < 2; k++)
+        {
+          guint32 position;
+          gfloat a, b, c;
+
+          if ((k == 1) && (used_size == 1))
+            break;
 
-      image_buff = pffft_aligned_malloc (priv->fft_size * sizeof(HyScanComplexFloat));
+          position = i * hop_size + ((k == 0) ? 0 : used_size - 1);
+          if ((position == 0) || (position + 1 >= n_points))
+            continue;
+
+          /* Соседние отсчёты находятся либо в этом же блоке, либо среди
+           * крайних отсчётов соседнего блока. */
+          if (k == 0)
+            {
+              a = edges[4 * (i - 1) + 3];
+              b = edges[4 * i + 0];
+              c = edges[4 * i + 1];
+            }
+          else
+            {
+              a = edges[4 * i + 2];
+              b = edges[4 * i + 3];
+              c = edges[4 * (i + 1) + 0];
+            }
 
-      memcpy (image_buff, image, n_points * sizeof(HyScanComplexFloat));
-      pffft_zreorder (priv->fft,
-                      (const gfloat*) image_buff,
-                      (gfloat*) fft_image,
-                      PFFFT_BACKWARD);
+          if ((b > a) && (b >= c))
+            {
+              gdouble delta;
+              gfloat amplitude;
 
-      pffft_aligned_free (image_buff);
+              hyscan_convolution_peak_interpolate (a, b, c, interpolation, &delta, &amplitude);
+              hyscan_convolution_peak_insert (peaks, n_found, n_peaks, position + delta, amplitude);
+            }
+        }
     }
 
-  g_hash_table_insert (priv->fft_images, GINT_TO_POINTER (index), fft_image);
+  g_free (block_peaks);
+  g_free (block_found);
+  g_free (edges);
 
   return TRUE;
 }
 
+/* Функция освобождает асинхронное задание свёртки. */
+static void
+hyscan_convolution_job_free (gpointer data)
+{
+  HyScanConvolutionJob *job = data;
+
+  g_object_unref (job->image);
+  g_slice_free (HyScanConvolutionJob, job);
+}
+
+/* Функция выполняет асинхронное задание свёртки. Задания выполняются в
+ * одном потоке в порядке их постановки в очередь. Свёртка производится
+ * вспомогательным объектом, поэтому буферы основного объекта в потоке
+ * не используются. */
+static void
+hyscan_convolution_job_run (gpointer data,
+                            gpointer user_data)
+{
+  GTask *task = data;
+  HyScanConvolution *worker = user_data;
+  HyScanConvolutionJob *job = g_task_get_task_data (task);
+  gboolean status = FALSE;
+
+  if (!g_task_return_error_if_cancelled (task))
+    {
+      hyscan_convolution_set_image (worker, 0, job->image);
+      status = hyscan_convolution_convolve_out (worker, 0, job->data, job->output,
+                                                job->n_points, job->scale);
+      hyscan_convolution_set_image (worker, 0, NULL);
+    }
+
+  if (status)
+    {
+      g_task_return_boolean (task, TRUE);
+    }
+  else if (!g_task_had_error (task))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                               "HyScanConvolution: convolution failed");
+    }
+
+  g_object_unref (task);
+}
+
+/* Функция освобождает место в очереди и передаёт результат задания
+ * пользователю. Вызывается в контексте, активном при постановке задания. */
+static void
+hyscan_convolution_job_ready (GObject      *source,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  HyScanConvolution *convolution = HYSCAN_CONVOLUTION (source);
+  HyScanConvolutionPrivate *priv = convolution->priv;
+  HyScanConvolutionJob *job = g_task_get_task_data (G_TASK (result));
+
+  g_mutex_lock (&priv->queue_lock);
+  priv->n_queued -= 1;
+  g_mutex_unlock (&priv->queue_lock);
+
+  if (job->callback != NULL)
+    job->callback (source, result, job->user_data);
+}
+
 /**
  * hyscan_convolution_new:
  *
@@ -334,105 +973,1087 @@ hyscan_convolution_new (void)
 guint32
 hyscan_convolution_get_fft_size (guint32 fft_size)
 {
-  guint i;
-
-  for (i = 0; i < G_N_ELEMENTS (fft_sizes); i++)
-    {
-      if (fft_sizes[i] >= fft_size)
-        return fft_sizes[i];
-    }
-
-  return 0;
+  return hyscan_fft_size_ceil (fft_size);
 }
 
 /**
- * hyscan_convolution_set_image_td:
- * @convolution: указатель на #HyScanConvolution
- * @index: номер образа сигнала
- * @image: (nullable) (array length=n_points) (transfer none): образ для свёртки
- * @n_points: размер образа в точках
+ * hyscan_convolution_get_optimal_fft_size:
+ * @image_size: размер образа в точках
+ * @line_size: размер строки данных в точках или 0
+ * @max_fft_size: максимальный размер FFT преобразования
+ * @hop_size: (out) (optional): шаг между блоками данных
  *
- * Функция задаёт образ для свёртки во временной области. Если образ установлен
- * в NULL, свёртка отключается.
+ * Функция выбирает размер FFT преобразования, при котором свёртка строки
+ * размером @line_size с образом размером @image_size требует наименьшего
+ * числа операций на один отсчёт результата. Если @line_size равен 0,
+ * размер выбирается для бесконечно длинной строки.
  *
- * При установке образа с номером 0, остальные образы обнуляются. Их необходимо
- * задать заново и их размер должен совпадать с нулевым образом.
+ * Если образ помещается в блок, между соседними блоками данных
+ * используется шаг N - M + 1, где N - размер FFT преобразования, а M -
+ * размер образа. Поэтому для коротких образов большой размер FFT
+ * преобразования обычно выгоднее. Если образ не помещается в блок, он
+ * разбивается на части и используется шаг N / 2.
  *
- * Returns: %TRUE если образ для свёртки установлен, иначе %FALSE.
+ * Returns: Размер FFT преобразования.
  */
-gboolean
-hyscan_convolution_set_image_td (HyScanConvolution        *convolution,
-                                 guint                     index,
-                                 const HyScanComplexFloat *image,
-                                 guint32                   n_points)
+guint32
+hyscan_convolution_get_optimal_fft_size (guint32  image_size,
+                                         guint32  line_size,
+                                         guint32  max_fft_size,
+                                         guint32 *hop_size)
 {
-  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
-
-  return hyscan_convolution_set_image (convolution->priv,
-                                       index,
-                                       HYSCAN_CONVOLUTION_IMAGE_TD,
-                                       image,
-                                       n_points);
+  return hyscan_convolution_plan_optimal_size (image_size, line_size, max_fft_size, hop_size);
 }
 
 /**
- * hyscan_convolution_set_image_fd:
+ * hyscan_convolution_set_max_fft_size:
  * @convolution: указатель на #HyScanConvolution
- * @index: номер образа сигнала
- * @image: (nullable) (array length=n_points) (transfer none): образ для свёртки
- * @n_points: размер образа в точках
+ * @fft_size: максимальный размер FFT преобразования
  *
- * Функция задаёт образ для свёртки в частотной области. Если образ установлен
- * в NULL, свёртка отключается.
+ * Функция задаёт максимальный размер FFT преобразования, используемый для
+ * образов во временной области. Размер, выбираемый для каждой строки
+ * (см. #hyscan_convolution_get_optimal_fft_size), не превышает этого
+ * значения. Образы, которые не помещаются в такое преобразование,
+ * разбиваются на части. Размер округляется в меньшую
+ * сторону до допустимого (см. #hyscan_convolution_get_fft_size).
  *
- * При установке образа с номером 0, остальные образы обнуляются. Их необходимо
- * задать заново и их размер должен совпадать с нулевым образом.
+ * По умолчанию максимальный размер равен 65536. Небольшие размеры
+ * уменьшают задержку и объём используемой памяти, но увеличивают число
+ * частей для длинных образов.
  *
- * Returns: %TRUE если образ для свёртки установлен, иначе %FALSE.
+ * Все установленные образы удаляются, их необходимо задать заново.
  */
-gboolean
-hyscan_convolution_set_image_fd (HyScanConvolution        *convolution,
-                                 guint                     index,
-                                 const HyScanComplexFloat *image,
-                                 guint32                   n_points)
+void
+hyscan_convolution_set_max_fft_size (HyScanConvolution *convolution,
+                                     guint32            fft_size)
 {
+  HyScanConvolutionPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_CONVOLUTION (convolution));
+
+  priv = convolution->priv;
+
+  priv->max_fft_size = hyscan_fft_size_floor (fft_size);
+
+  g_hash_table_remove_all (priv->fft_images);
+}
+
+/**
+ * hyscan_convolution_set_background_fft:
+ * @convolution: указатель на #HyScanConvolution
+ * @background: подготавливать образы в фоновом потоке
+ *
+ * Функция включает подготовку образов в фоновом потоке. По умолчанию образ
+ * во временной области преобразуется при первой свёртке с ним. Если
+ * фоновая подготовка включена, образы, устанавливаемые функциями
+ * #hyscan_convolution_set_image и #hyscan_convolution_set_image_td,
+ * передаются в общий пул потоков и преобразуются в нём. Образ, который
+ * был заменён до начала преобразования, не преобразуется.
+ */
+void
+hyscan_convolution_set_background_fft (HyScanConvolution *convolution,
+                                       gboolean           background)
+{
+  g_return_if_fail (HYSCAN_IS_CONVOLUTION (convolution));
+
+  convolution->priv->background = background;
+}
+
+/**
+ * hyscan_convolution_set_image:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @image: (nullable) (transfer none): образ для свёртки
+ *
+ * Функция задаёт образ для свёртки, подготовленный заранее. Объект
+ * сохраняет ссылку на образ без копирования данных. Если образ
+ * установлен в NULL, свёртка отключается.
+ *
+ * Образы с разными номерами независимы друг от друга и могут иметь разный
+ * размер FFT преобразования. В отличие от функций
+ * #hyscan_convolution_set_image_td и #hyscan_convolution_set_image_fd,
+ * установка образа с номером 0 не удаляет остальные образы.
+ *
+ * Returns: %TRUE если образ для свёртки установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_set_image (HyScanConvolution      *convolution,
+                              guint                   index,
+                              HyScanConvolutionImage *image)
+{
+  HyScanConvolutionPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail ((image == NULL) || HYSCAN_IS_CONVOLUTION_IMAGE (image), FALSE);
+
+  priv = convolution->priv;
+
+  /* Пользователь отменил свёртку. */
+  if (image == NULL)
+    {
+      g_hash_table_remove (priv->fft_images, GINT_TO_POINTER (index));
+      return TRUE;
+    }
+
+  g_hash_table_insert (priv->fft_images, GINT_TO_POINTER (index), g_object_ref (image));
+
+  if (priv->background)
+    hyscan_convolution_image_prepare_background (image);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_convolution_set_image_td:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @image: (nullable) (array length=n_points) (transfer none): образ для свёртки
+ * @n_points: размер образа в точках
+ *
+ * Функция задаёт образ для свёртки во временной области. Если образ установлен
+ * в NULL, свёртка отключается.
+ *
+ * При установке образа с номером 0, остальные образы обнуляются. Их необходимо
+ * задать заново. Размер FFT преобразования выбирается для каждого образа
+ * отдельно.
+ *
+ * Размер образа во временной области не ограничен: длинные образы
+ * разбиваются на части (см. #hyscan_convolution_set_max_fft_size).
+ *
+ * Returns: %TRUE если образ для свёртки установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_set_image_td (HyScanConvolution        *convolution,
+                                 guint                     index,
+                                 const HyScanComplexFloat *image,
+                                 guint32                   n_points)
+{
+  HyScanConvolutionImage *fft_image;
+  gboolean status;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  /* Очищаем текущий образ. */
+  if (index == 0)
+    g_hash_table_remove_all (convolution->priv->fft_images);
+
+  if (image == NULL)
+    return hyscan_convolution_set_image (convolution, index, NULL);
+
+  fft_image = hyscan_convolution_image_new_td (image, n_points,
+                                               convolution->priv->max_fft_size);
+  if (fft_image == NULL)
+    {
+      hyscan_convolution_set_image (convolution, index, NULL);
+      return FALSE;
+    }
+
+  status = hyscan_convolution_set_image (convolution, index, fft_image);
+  g_object_unref (fft_image);
+
+  return status;
+}
+
+/**
+ * hyscan_convolution_set_image_fd:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @image: (nullable) (array length=n_points) (transfer none): образ для свёртки
+ * @n_points: размер образа в точках
+ *
+ * Функция задаёт образ для свёртки в частотной области. Если образ установлен
+ * в NULL, свёртка отключается.
+ *
+ * При установке образа с номером 0, остальные образы обнуляются. Их необходимо
+ * задать заново. Размер FFT преобразования выбирается для каждого образа
+ * отдельно.
+ *
+ * Returns: %TRUE если образ для свёртки установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_set_image_fd (HyScanConvolution        *convolution,
+                                 guint                     index,
+                                 const HyScanComplexFloat *image,
+                                 guint32                   n_points)
+{
+  HyScanConvolutionImage *fft_image;
+  gboolean status;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  /* Очищаем текущий образ. */
+  if (index == 0)
+    g_hash_table_remove_all (convolution->priv->fft_images);
+
+  if (image == NULL)
+    return hyscan_convolution_set_image (convolution, index, NULL);
+
+  fft_image = hyscan_convolution_image_new_fd (image, n_points);
+  if (fft_image == NULL)
+    {
+      hyscan_convolution_set_image (convolution, index, NULL);
+      return FALSE;
+    }
+
+  status = hyscan_convolution_set_image (convolution, index, fft_image);
+  g_object_unref (fft_image);
+
+  return status;
+}
+
+/**
+ * hyscan_convolution_convolve:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку данных с образом. Результат свёртки помещается
+ * во входной массив. При свёртке производится автоматическое нормирование
+ * на размер образа свёртки. Пользователь может указать дополнительный
+ * коэффициент на который будут домножены данные после свёртки.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve (HyScanConvolution  *convolution,
+                             guint               index,
+                             HyScanComplexFloat *data,
+                             guint32             n_points,
+                             gfloat              scale)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  return hyscan_convolution_convolve_complex (convolution->priv, index,
+                                              data, data, n_points, scale);
+}
+
+/**
+ * hyscan_convolution_convolve_out:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @output: (out) (array length=n_points) (transfer none): буфер для результата свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку данных с образом и помещает результат в массив
+ * output. Входные данные не изменяются. Нормирование производится так же,
+ * как и в функции #hyscan_convolution_convolve.
+ *
+ * Если адрес массива data выровнен на границу 16 байт, полные блоки данных
+ * преобразуются прямо из него, а во внутренний буфер копируется только
+ * последний неполный блок. Функция g_malloc такого выравнивания не
+ * гарантирует, поэтому выровненный буфер следует выделять функцией
+ * pffft_aligned_malloc или использовать данные #HyScanBuffer. Невыровненные
+ * данные копируются во внутренний буфер целиком, результат свёртки от
+ * выравнивания не зависит.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_out (HyScanConvolution        *convolution,
+                                 guint                     index,
+                                 const HyScanComplexFloat *data,
+                                 HyScanComplexFloat       *output,
+                                 guint32                   n_points,
+                                 gfloat                    scale)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  return hyscan_convolution_convolve_complex (convolution->priv, index,
+                                              data, output, n_points, scale);
+}
+
+/**
+ * hyscan_convolution_convolve_gated:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @n_points: размер данных в точках
+ * @gates: (array length=n_gates) (transfer none): интервалы результата
+ * @n_gates: число интервалов
+ * @output: (out) (transfer none): буфер для результата свёртки
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку данных с образом только в заданных интервалах
+ * результата. Прямое и обратное преобразования Фурье выполняются только
+ * для блоков данных, от которых зависят отсчёты этих интервалов, поэтому
+ * вычисление узкого интервала значительно быстрее свёртки всей строки.
+ *
+ * Результаты для всех интервалов записываются в массив output подряд, в
+ * порядке их следования в массиве gates. Размер массива output должен быть
+ * не меньше суммарной длины интервалов. Интервалы могут перекрываться.
+ * Значения результата совпадают с соответствующими отсчётами функции
+ * #hyscan_convolution_convolve.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_gated (HyScanConvolution           *convolution,
+                                   guint                        index,
+                                   const HyScanComplexFloat    *data,
+                                   guint32                      n_points,
+                                   const HyScanConvolutionGate *gates,
+                                   guint                        n_gates,
+                                   HyScanComplexFloat          *output,
+                                   gfloat                       scale)
+{
+  HyScanConvolutionPrivate *priv;
+  HyScanConvolutionPlan *plan;
+
+  gint32 *in_slots;
+  gint32 *out_slots;
+  gint32 *in_list;
+  gint32 *out_list;
+  guint32 max_gate;
+  guint32 full_size;
+  guint32 hop_size;
+  gint32 n_fft;
+  gint32 n_blocks;
+  gint32 n_in;
+  gint32 n_out;
+  gint32 i;
+  guint32 j;
+  guint n;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (gates != NULL, FALSE);
+  g_return_val_if_fail (output != NULL, FALSE);
+
+  priv = convolution->priv;
+
+  /* Проверяем интервалы. */
+  max_gate = 0;
+  for (n = 0; n < n_gates; n++)
+    {
+      if ((gates[n].start >= gates[n].end) || (gates[n].end > n_points))
+        {
+          g_warning ("HyScanConvolution: wrong gate %u [%u, %u)",
+                     n, gates[n].start, gates[n].end);
+          return FALSE;
+        }
+
+      max_gate = MAX (max_gate, gates[n].end - gates[n].start);
+    }
+
+  if (n_gates == 0)
+    return TRUE;
+
+  /* Размер преобразования выбирается по длине самого большого интервала,
+   * а не всей строки. */
+  plan = hyscan_convolution_lookup (priv, index, max_gate);
+  if (plan == NULL)
+    return FALSE;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
+
+  n_fft = (n_points / hop_size);
+  if (n_points % hop_size)
+    n_fft += 1;
+
+  n_blocks = n_fft + plan->n_parts - 1;
+
+  /* Отмечаем блоки результата, попадающие в интервалы, и блоки входных
+   * данных, от которых они зависят. */
+  out_slots = g_new (gint32, n_fft);
+  in_slots = g_new (gint32, n_blocks);
+
+  for (i = 0; i < n_fft; i++)
+    out_slots[i] = -1;
+  for (i = 0; i < n_blocks; i++)
+    in_slots[i] = -1;
+
+  for (n = 0; n < n_gates; n++)
+    {
+      for (j = gates[n].start / hop_size; j <= (gates[n].end - 1) / hop_size; j++)
+        out_slots[j] = 0;
+    }
+
+  for (i = 0; i < n_fft; i++)
+    {
+      if (out_slots[i] == 0)
+        memset (in_slots + i, 0, plan->n_parts * sizeof (gint32));
+    }
+
+  /* Нумеруем отмеченные блоки подряд. Буферы содержат только эти блоки, при
+   * этом блоки входных данных одного блока результата идут подряд, т.к.
+   * отмечены все они. */
+  out_list = g_new (gint32, n_fft);
+  in_list = g_new (gint32, n_blocks);
+
+  for (i = 0, n_out = 0; i < n_fft; i++)
+    {
+      if (out_slots[i] == 0)
+        {
+          out_list[n_out] = i;
+          out_slots[i] = n_out++;
+        }
+    }
+
+  for (i = 0, n_in = 0; i < n_blocks; i++)
+    {
+      if (in_slots[i] == 0)
+        {
+          in_list[n_in] = i;
+          in_slots[i] = n_in++;
+        }
+    }
+
+  hyscan_convolution_realloc_buffers (priv, n_in * full_size);
+
+  /* Прямое преобразование Фурье нужных блоков. Полные блоки выровненных
+   * данных преобразуются прямо из буфера пользователя, остальные копируются
+   * во входной буфер и дополняются нулями. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_in; i++)
+    {
+      const HyScanComplexFloat *block;
+      guint32 offset = i * full_size;
+      guint32 first = in_list[i] * hop_size;
+
+      if (HYSCAN_CONVOLUTION_IS_ALIGNED (data) && (first + full_size <= n_points))
+        {
+          block = data + first;
+        }
+      else
+        {
+          guint32 size = (first < n_points) ? MIN (n_points - first, full_size) : 0;
+
+          if (size > 0)
+            memcpy (priv->ibuff + offset, data + first, size * sizeof (HyScanComplexFloat));
+          memset (priv->ibuff + offset + size, 0, (full_size - size) * sizeof (HyScanComplexFloat));
+          block = priv->ibuff + offset;
+        }
+
+      pffft_transform (plan->fft,
+                       (const gfloat*) block,
+                       (gfloat*) (priv->obuff + offset),
+                       (gfloat*) (priv->wbuff + offset),
+                       PFFFT_FORWARD);
+    }
+
+  /* Свёртка и обратное преобразование Фурье нужных блоков. Результат
+   * каждого блока остаётся в wbuff. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_out; i++)
+    {
+      guint32 offset = i * full_size;
+
+      hyscan_convolution_multiply (priv, plan, in_slots[out_list[i]], priv->wbuff + offset, scale);
+
+      pffft_transform (plan->fft,
+                       (gfloat*) (priv->wbuff + offset),
+                       (gfloat*) (priv->wbuff + offset),
+                       (gfloat*) (priv->ibuff + offset),
+                       PFFFT_BACKWARD);
+    }
+
+  /* Копируем интервалы в буфер пользователя. */
+  for (n = 0; n < n_gates; n++)
+    {
+      j = gates[n].start;
+      while (j < gates[n].end)
+        {
+          guint32 block = j / hop_size;
+          guint32 shift = j % hop_size;
+          guint32 size = MIN (hop_size - shift, gates[n].end - j);
+
+          memcpy (output,
+                  priv->wbuff + out_slots[block] * full_size + shift,
+                  size * sizeof (HyScanComplexFloat));
+
+          output += size;
+          j += size;
+        }
+    }
+
+  g_free (out_slots);
+  g_free (in_slots);
+  g_free (out_list);
+  g_free (in_list);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_convolution_find_peaks:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ * @interpolation: способ уточнения положения пика
+ * @peaks: (out) (array length=n_peaks) (transfer none): буфер для пиков
+ * @n_peaks: максимальное число пиков
+ * @n_found: (out): число найденных пиков
+ *
+ * Функция выполняет свёртку (взаимную корреляцию) данных с образом и
+ * находит n_peaks локальных максимумов амплитуды результата с наибольшими
+ * значениями. Положение и амплитуда каждого пика уточняются между отсчётами
+ * по трём соседним отсчётам. Пики записываются в массив peaks в порядке
+ * убывания амплитуды. Нормирование амплитуды производится так же, как и в
+ * функции #hyscan_convolution_convolve_amplitude.
+ *
+ * Пики ищутся сразу после обратного преобразования Фурье каждого блока,
+ * поэтому результат свёртки целиком не вычисляется. Для оценки задержки
+ * между каналами данные одного канала задаются образом, а другого
+ * передаются в функцию.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_find_peaks (HyScanConvolution                  *convolution,
+                               guint                               index,
+                               const HyScanComplexFloat           *data,
+                               guint32                             n_points,
+                               gfloat                              scale,
+                               HyScanConvolutionPeakInterpolation  interpolation,
+                               HyScanConvolutionPeak              *peaks,
+                               guint                               n_peaks,
+                               guint                              *n_found)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail ((peaks != NULL) && (n_peaks > 0), FALSE);
+  g_return_val_if_fail (n_found != NULL, FALSE);
+
+  return hyscan_convolution_peaks (convolution->priv, index, data, n_points, scale,
+                                   interpolation, peaks, n_peaks, n_found);
+}
+
+/**
+ * hyscan_convolution_find_peaks_batch:
+ * @convolution: указатель на #HyScanConvolution
+ * @indexes: (array length=n_lines) (transfer none): номера образов для каждой строки
+ * @data: (array length=n_lines) (transfer none): строки данных для свёртки
+ * @n_lines: число строк
+ * @n_points: размер каждой строки в точках
+ * @scale: коэффициент масштабирования
+ * @interpolation: способ уточнения положения пика
+ * @peaks: (out) (transfer none): буфер для пиков размером n_lines * n_peaks
+ * @n_peaks: максимальное число пиков для одной строки
+ * @n_found: (out) (array length=n_lines) (transfer none): число найденных пиков для каждой строки
+ *
+ * Функция находит пики результата свёртки для нескольких строк данных, см.
+ * #hyscan_convolution_find_peaks. Строка с номером i свёртывается с образом
+ * indexes[i], её пики записываются в массив peaks начиная с индекса
+ * i * n_peaks. Буферы преобразования Фурье используются всеми строками,
+ * поэтому пакетная обработка не требует дополнительной памяти.
+ *
+ * Returns: %TRUE если свёртка выполнена для всех строк, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_find_peaks_batch (HyScanConvolution                  *convolution,
+                                     const guint                        *indexes,
+                                     const HyScanComplexFloat * const   *data,
+                                     guint                               n_lines,
+                                     guint32                             n_points,
+                                     gfloat                              scale,
+                                     HyScanConvolutionPeakInterpolation  interpolation,
+                                     HyScanConvolutionPeak              *peaks,
+                                     guint                               n_peaks,
+                                     guint                              *n_found)
+{
+  gboolean status = TRUE;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail ((indexes != NULL) && (data != NULL), FALSE);
+  g_return_val_if_fail ((peaks != NULL) && (n_peaks > 0), FALSE);
+  g_return_val_if_fail (n_found != NULL, FALSE);
+
+  for (i = 0; i < n_lines; i++)
+    {
+      if (!hyscan_convolution_peaks (convolution->priv, indexes[i], data[i], n_points, scale,
+                                     interpolation, peaks + i * n_peaks, n_peaks, &n_found[i]))
+        {
+          status = FALSE;
+        }
+    }
+
+  return status;
+}
+
+/**
+ * hyscan_convolution_set_doppler_bank:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер первого образа банка
+ * @discretization: частота дискретизации сигнала, Гц
+ * @start_frequency: начальная частота ЛЧМ сигнала, Гц
+ * @end_frequency: конечная частота ЛЧМ сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @dopplers: (array length=n_dopplers) (transfer none): коэффициенты доплеровского сжатия
+ * @n_dopplers: число образов в банке
+ *
+ * Функция задаёт банк образов ЛЧМ сигнала для различных доплеровских
+ * сдвигов (см. #hyscan_signal_image_lfm_doppler). Образы устанавливаются
+ * с номерами от index до index + n_dopplers - 1. Все образы дополняются
+ * нулями до одинакового размера, поэтому используют одинаковое разбиение
+ * на блоки и могут обрабатываться функцией
+ * #hyscan_convolution_convolve_bank. Амплитуда свёртки с каждым образом
+ * нормируется на его размер без учёта дополнения.
+ *
+ * Returns: %TRUE если банк образов установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_set_doppler_bank (HyScanConvolution *convolution,
+                                     guint              index,
+                                     gdouble            discretization,
+                                     gdouble            start_frequency,
+                                     gdouble            end_frequency,
+                                     gdouble            duration,
+                                     const gdouble     *dopplers,
+                                     guint              n_dopplers)
+{
+  HyScanComplexFloat *image;
+  guint32 *sizes;
+  guint32 max_size;
+  gboolean status = TRUE;
+  guint i;
+
   g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail ((dopplers != NULL) && (n_dopplers > 0), FALSE);
+
+  sizes = g_new (guint32, n_dopplers);
+
+  max_size = 0;
+  for (i = 0; i < n_dopplers; i++)
+    {
+      if (dopplers[i] <= 0.0)
+        {
+          g_warning ("HyScanConvolution: wrong doppler factor %f", dopplers[i]);
+          n_dopplers = i;
+          status = FALSE;
+          break;
+        }
+
+      sizes[i] = hyscan_signal_fill_lfm_doppler (discretization,
+                                                 start_frequency, end_frequency,
+                                                 duration, dopplers[i], NULL, 0);
+      max_size = MAX (max_size, sizes[i]);
+    }
+
+  /* Образы рассчитываются сразу в буфер размером с наибольший из них и
+   * дополняются нулями. Результат свёртки нормируется на размер образа,
+   * поэтому отсчёты масштабируются так, чтобы нормирование соответствовало
+   * исходному размеру образа. */
+  image = pffft_aligned_malloc (max_size * sizeof(HyScanComplexFloat));
+  for (i = 0; (i < n_dopplers) && status; i++)
+    {
+      gfloat norm = (gfloat) max_size / sizes[i];
+      guint32 j;
+
+      hyscan_signal_fill_lfm_doppler (discretization,
+                                      start_frequency, end_frequency,
+                                      duration, dopplers[i], image, max_size);
+
+      for (j = 0; j < sizes[i]; j++)
+        {
+          image[j].re *= norm;
+          image[j].im *= norm;
+        }
+
+      if (!hyscan_convolution_set_image_td (convolution, index + i, image, max_size))
+        status = FALSE;
+    }
+
+  pffft_aligned_free (image);
+  g_free (sizes);
 
-  return hyscan_convolution_set_image (convolution->priv,
-                                       index,
-                                       HYSCAN_CONVOLUTION_IMAGE_FD,
-                                       image,
-                                       n_points);
+  return status;
 }
 
 /**
- * hyscan_convolution_convolve:
+ * hyscan_convolution_convolve_bank:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер первого образа банка
+ * @n_images: число образов в банке
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ * @map: (out) (nullable) (transfer none): буфер для карты задержка-доплер размером n_images * n_points
+ * @amplitude: (out) (nullable) (array length=n_points) (transfer none): буфер для наибольшей амплитуды
+ * @best: (out) (nullable) (array length=n_points) (transfer none): буфер для номера образа с наибольшей амплитудой
+ *
+ * Функция выполняет свёртку данных со всеми образами банка с номерами от
+ * index до index + n_images - 1. Прямое преобразование Фурье данных
+ * выполняется один раз и используется всеми образами.
+ *
+ * В массив map записывается амплитуда свёртки с каждым образом: строка с
+ * номером k содержит n_points отсчётов свёртки с образом index + k. В
+ * массивы amplitude и best записываются наибольшая по всем образам
+ * амплитуда для каждого отсчёта и номер образа (от 0 до n_images - 1), на
+ * котором она достигается. Любой из выходных массивов может быть NULL.
+ *
+ * Все образы банка должны иметь одинаковый размер во временной области
+ * (см. #hyscan_convolution_set_doppler_bank).
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_bank (HyScanConvolution        *convolution,
+                                  guint                     index,
+                                  guint                     n_images,
+                                  const HyScanComplexFloat *data,
+                                  guint32                   n_points,
+                                  gfloat                    scale,
+                                  gfloat                   *map,
+                                  gfloat                   *amplitude,
+                                  guint                    *best)
+{
+  HyScanConvolutionPrivate *priv;
+  HyScanConvolutionPlan **plans;
+  gfloat *max_amplitude;
+
+  guint32 full_size;
+  guint32 hop_size;
+  gint32 n_fft;
+  gint32 i;
+  guint k;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (n_images > 0, FALSE);
+
+  priv = convolution->priv;
+
+  /* Все образы банка должны использовать одинаковое разбиение на блоки,
+   * иначе спектры блоков данных нельзя использовать совместно. */
+  plans = g_new (HyScanConvolutionPlan *, n_images);
+  for (k = 0; k < n_images; k++)
+    {
+      plans[k] = hyscan_convolution_lookup (priv, index + k, n_points);
+      if ((plans[k] == NULL) ||
+          (plans[k]->fft_size != plans[0]->fft_size) ||
+          (plans[k]->hop_size != plans[0]->hop_size) ||
+          (plans[k]->n_parts != plans[0]->n_parts))
+        {
+          if (plans[k] != NULL)
+            g_warning ("HyScanConvolution: image %u doesn't match the bank", index + k);
+
+          g_free (plans);
+          return FALSE;
+        }
+    }
+
+  full_size = plans[0]->fft_size;
+  hop_size = plans[0]->hop_size;
+
+  /* Наибольшая амплитуда нужна для выбора образа, даже если пользователь
+   * её не запрашивает. */
+  max_amplitude = amplitude;
+  if ((max_amplitude == NULL) && (best != NULL))
+    max_amplitude = g_new (gfloat, n_points);
+
+  /* Прямое преобразование Фурье выполняется один раз для всех образов. */
+  n_fft = hyscan_convolution_forward (priv, plans[0], data, n_points);
+
+  /* Блоки данных обрабатываются параллельно, для каждого блока выполняется
+   * свёртка со всеми образами банка. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for private (k)
+#endif
+  for (i = 0; i < n_fft; i++)
+    {
+      HyScanComplexFloat *block = priv->wbuff + i * full_size;
+      guint32 offset = i * hop_size;
+      guint32 used_size = MIN ((n_points - offset), hop_size);
+      guint32 j;
+
+      for (k = 0; k < n_images; k++)
+        {
+          hyscan_convolution_multiply (priv, plans[k], i, block, scale);
+
+          pffft_transform (plans[k]->fft,
+                           (gfloat*) block,
+                           (gfloat*) block,
+                           (gfloat*) (priv->ibuff + i * full_size),
+                           PFFFT_BACKWARD);
+
+          for (j = 0; j < used_size; j++)
+            {
+              gfloat value = sqrtf (block[j].re * block[j].re + block[j].im * block[j].im);
+
+              if (map != NULL)
+                map[k * n_points + offset + j] = value;
+
+              if (max_amplitude == NULL)
+                continue;
+
+              if ((k == 0) || (value > max_amplitude[offset + j]))
+                {
+                  max_amplitude[offset + j] = value;
+                  if (best != NULL)
+                    best[offset + j] = k;
+                }
+            }
+        }
+    }
+
+  if (max_amplitude != amplitude)
+    g_free (max_amplitude);
+  g_free (plans);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_convolution_set_queue_depth:
+ * @convolution: указатель на #HyScanConvolution
+ * @depth: максимальное число заданий в очереди
+ *
+ * Функция задаёт максимальное число асинхронных заданий свёртки, результат
+ * которых ещё не передан пользователю (см. #hyscan_convolution_convolve_async).
+ * По умолчанию используется значение 4.
+ */
+void
+hyscan_convolution_set_queue_depth (HyScanConvolution *convolution,
+                                    guint              depth)
+{
+  HyScanConvolutionPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_CONVOLUTION (convolution));
+  g_return_if_fail (depth > 0);
+
+  priv = convolution->priv;
+
+  g_mutex_lock (&priv->queue_lock);
+  priv->queue_depth = depth;
+  g_mutex_unlock (&priv->queue_lock);
+}
+
+/**
+ * hyscan_convolution_convolve_async:
  * @convolution: указатель на #HyScanConvolution
  * @index: номер образа сигнала
  * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @output: (array length=n_points) (transfer none): буфер для результата свёртки
  * @n_points: размер данных в точках
  * @scale: коэффициент масштабирования
+ * @cancellable: (nullable): объект отмены задания
+ * @callback: функция, вызываемая по завершении свёртки
+ * @user_data: пользовательские данные для функции callback
  *
- * Функция выполняет свёртку данных с образом. Результат свёртки помещается
- * во входной массив. При свёртке производится автоматическое нормирование
- * на размер образа свёртки. Пользователь может указать дополнительный
- * коэффициент на который будут домножены данные после свёртки.
+ * Функция ставит в очередь задание свёртки данных с образом и сразу
+ * возвращает управление, не ожидая освобождения места в очереди. Свёртка
+ * выполняется в отдельном потоке, результат записывается в массив output.
+ * Массивы data и output могут совпадать. Они должны оставаться доступными
+ * до вызова функции callback.
+ *
+ * Задания одного объекта выполняются строго в порядке их постановки в
+ * очередь, функции callback вызываются в том же порядке в контексте
+ * #GMainContext, активном при вызове этой функции. Образ фиксируется в
+ * момент постановки задания, поэтому его последующая замена не влияет на
+ * уже поставленные задания.
+ *
+ * Место в очереди освобождается перед вызовом функции callback. Если в
+ * очереди находится максимальное число заданий (см.
+ * #hyscan_convolution_set_queue_depth), задание не ставится и функция
+ * возвращает %FALSE. В этом случае функция callback не вызывается, а
+ * данные можно отбросить или передать повторно после завершения
+ * очередного задания.
+ *
+ * Результат задания получают функцией #hyscan_convolution_convolve_finish.
+ *
+ * Returns: %TRUE если задание поставлено в очередь, %FALSE если очередь
+ * заполнена или образ не задан.
+ */
+gboolean
+hyscan_convolution_convolve_async (HyScanConvolution        *convolution,
+                                   guint                     index,
+                                   const HyScanComplexFloat *data,
+                                   HyScanComplexFloat       *output,
+                                   guint32                   n_points,
+                                   gfloat                    scale,
+                                   GCancellable             *cancellable,
+                                   GAsyncReadyCallback       callback,
+                                   gpointer                  user_data)
+{
+  HyScanConvolutionPrivate *priv;
+  HyScanConvolutionImage *image;
+  HyScanConvolutionJob *job;
+  GTask *task;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (output != NULL, FALSE);
+
+  priv = convolution->priv;
+
+  image = g_hash_table_lookup (priv->fft_images, GINT_TO_POINTER (index));
+  if (image == NULL)
+    return FALSE;
+
+  /* Занимаем место в очереди. */
+  g_mutex_lock (&priv->queue_lock);
+  if (priv->n_queued >= priv->queue_depth)
+    {
+      g_mutex_unlock (&priv->queue_lock);
+      return FALSE;
+    }
+  priv->n_queued += 1;
+  g_mutex_unlock (&priv->queue_lock);
+
+  task = g_task_new (convolution, cancellable, hyscan_convolution_job_ready, NULL);
+  g_task_set_source_tag (task, hyscan_convolution_convolve_async);
+
+  job = g_slice_new (HyScanConvolutionJob);
+  job->image = g_object_ref (image);
+  job->data = data;
+  job->output = output;
+  job->n_points = n_points;
+  job->scale = scale;
+  job->callback = callback;
+  job->user_data = user_data;
+  g_task_set_task_data (task, job, hyscan_convolution_job_free);
+
+  /* Поток выполнения заданий создаётся при первом обращении. Один поток
+   * гарантирует порядок выполнения заданий. */
+  if (priv->pool == NULL)
+    {
+      priv->worker = hyscan_convolution_new ();
+      priv->pool = g_thread_pool_new (hyscan_convolution_job_run, priv->worker, 1, FALSE, NULL);
+    }
+
+  g_thread_pool_push (priv->pool, task, NULL);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_convolution_convolve_finish:
+ * @convolution: указатель на #HyScanConvolution
+ * @result: результат асинхронного задания
+ * @error: (nullable): указатель на #GError
+ *
+ * Функция возвращает результат задания, поставленного функцией
+ * #hyscan_convolution_convolve_async.
  *
  * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
  */
 gboolean
-hyscan_convolution_convolve (HyScanConvolution  *convolution,
-                             guint               index,
-                             HyScanComplexFloat *data,
-                             guint32             n_points,
-                             gfloat              scale)
+hyscan_convolution_convolve_finish (HyScanConvolution  *convolution,
+                                    GAsyncResult       *result,
+                                    GError            **error)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, convolution), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * hyscan_convolution_convolve_amplitude:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @output: (out) (array length=n_points) (transfer none): буфер для амплитуды свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку данных с образом и записывает в массив output
+ * амплитуду (огибающую) результата. Комплексный результат свёртки в буфер
+ * пользователя не записывается. Нормирование производится так же, как и в
+ * функции #hyscan_convolution_convolve.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_amplitude (HyScanConvolution        *convolution,
+                                       guint                     index,
+                                       const HyScanComplexFloat *data,
+                                       gfloat                   *output,
+                                       guint32                   n_points,
+                                       gfloat                    scale)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  return hyscan_convolution_convolve_envelope (convolution->priv, index,
+                                               data, output, n_points,
+                                               scale, FALSE, 0.0f);
+}
+
+/**
+ * hyscan_convolution_convolve_db:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @output: (out) (array length=n_points) (transfer none): буфер для амплитуды свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ * @floor_db: минимальное значение амплитуды, дБ
+ *
+ * Функция выполняет свёртку данных с образом и записывает в массив output
+ * амплитуду результата в дБ: 20 * log10 (|y|). Значения меньше @floor_db
+ * заменяются на @floor_db.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_db (HyScanConvolution        *convolution,
+                                guint                     index,
+                                const HyScanComplexFloat *data,
+                                gfloat                   *output,
+                                guint32                   n_points,
+                                gfloat                    scale,
+                                gfloat                    floor_db)
+{
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+
+  return hyscan_convolution_convolve_envelope (convolution->priv, index,
+                                               data, output, n_points,
+                                               scale, TRUE, floor_db);
+}
+
+/**
+ * hyscan_convolution_convolve_real:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): действительные данные для свёртки
+ * @output: (out) (array length=n_points) (transfer none): буфер для результата свёртки
+ * @n_points: размер данных в точках
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку действительных данных с образом. Образ может
+ * быть как комплексным, так и действительным (с нулевыми мнимыми частями).
+ * Результат свёртки является комплексным и помещается в массив output.
+ *
+ * Прямое преобразование Фурье выполняется над действительными данными,
+ * а их спектр хранится в упакованном виде (только положительные частоты).
+ * Нормирование производится так же, как и в функции
+ * #hyscan_convolution_convolve.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_real (HyScanConvolution  *convolution,
+                                  guint               index,
+                                  const gfloat       *data,
+                                  HyScanComplexFloat *output,
+                                  guint32             n_points,
+                                  gfloat              scale)
 {
   HyScanConvolutionPrivate *priv;
+  HyScanConvolutionPlan *plan;
 
-  HyScanComplexFloat *fft_image;
+  const HyScanComplexFloat *ordered_parts;
+  PFFFT_Setup *fft_real;
+  gfloat *ibuff;
 
   guint32 full_size;
   guint32 half_size;
+  guint32 hop_size;
+  guint32 staged;
+  gint32 n_direct;
+  gint32 n_blocks;
   gint32 n_fft;
   gint32 i;
 
@@ -440,55 +2061,83 @@ hyscan_convolution_convolve (HyScanConvolution  *convolution,
 
   priv = convolution->priv;
 
-  /* Свертка выполняется блоками по fft_size элементов, при этом каждый
-   * следующий блок смещен относительно предыдущего на (fft_size / 2)
-   * элементов. Входные данные находятся в ibuff, где над ними производится
-   * прямое преобразование Фурье с сохранением результата в obuff, но уже
-   * без перекрытия, т.е. с шагом fft_size. Затем производится перемножение
-   * ("свертка") с нужным образом и обратное преобразование Фурье в ibuff.
-   * Таким образом в ibuff оказываются необходимые данные, разбитые на
-   * некоторое число блоков, в каждом из которых нам нужны только первые
-   * (fft_size / 2) элементов. Так как операции над блоками происходят
-   * независимо друг от друга этот процесс можно выполнять параллельно, что
-   * и производится за счет использования библиотеки OpenMP. */
+  /* Свёртка выполняется так же, как и для комплексных данных (см.
+   * hyscan_convolution_convolve), но прямое преобразование Фурье
+   * выполняется над действительными данными. Спектр блока размером
+   * fft_size действительных чисел занимает fft_size / 2 комплексных
+   * отсчётов. Перед обратным преобразованием из него восстанавливается
+   * полный спектр, который перемножается с образом в обычном порядке. */
 
   /* Образ свёртки. */
-  fft_image = g_hash_table_lookup (priv->fft_images, GINT_TO_POINTER (index));
-  if (priv->fft == NULL || fft_image == NULL)
+  plan = hyscan_convolution_lookup (priv, index, n_points);
+  if (plan == NULL)
     return FALSE;
 
-  full_size = priv->fft_size;
-  half_size = priv->fft_size / 2;
+  full_size = plan->fft_size;
+  half_size = plan->fft_size / 2;
+  hop_size = plan->hop_size;
+
+  /* Коэффициенты преобразования действительных данных. */
+  fft_real = hyscan_convolution_get_setup (priv, full_size, PFFFT_REAL);
+  if (fft_real == NULL)
+    {
+      g_warning ("HyScanConvolution: can't setup fft");
+      return FALSE;
+    }
+
+  /* Образ в обычном порядке. */
+  ordered_parts = hyscan_convolution_plan_get_ordered (plan);
 
   /* Число блоков преобразования Фурье над одной строкой. */
-  n_fft = (n_points / half_size);
-  if (n_points % half_size)
+  n_fft = (n_points / hop_size);
+  if (n_points % hop_size)
     n_fft += 1;
 
+  /* Число блоков входных данных с учётом частей образа. */
+  n_blocks = n_fft + plan->n_parts - 1;
+
   /* Обновляем буферы. */
-  hyscan_convolution_realloc_buffers(priv, n_fft * priv->fft_size);
+  hyscan_convolution_realloc_buffers (priv, n_blocks * full_size);
+
+  /* Полные блоки выровненных данных преобразуются прямо из буфера
+   * пользователя, во входной буфер копируется только конец строки (см.
+   * hyscan_convolution_forward). Шаг между блоками кратен 4 отсчётам,
+   * поэтому начала блоков также выровнены. */
+  n_direct = 0;
+  if (HYSCAN_CONVOLUTION_IS_ALIGNED (data) && (n_points >= full_size))
+    n_direct = (n_points - full_size) / hop_size + 1;
+
+  ibuff = (gfloat*) priv->ibuff;
+  if (n_direct < n_blocks)
+    {
+      guint32 staged_end = (n_blocks - n_direct - 1) * hop_size + full_size;
 
-  /* Копируем данные во входной буфер. */
-  memcpy (priv->ibuff,
-          data,
-          n_points * sizeof(HyScanComplexFloat));
+      staged = n_points - n_direct * hop_size;
 
-  /* Зануляем конец буфера по границе half_size. */
-  memset (priv->ibuff + n_points,
-          0,
-          ((n_fft + 1) * half_size - n_points) * sizeof(HyScanComplexFloat));
+      memcpy (ibuff, data + n_direct * hop_size, staged * sizeof(gfloat));
+      if (staged_end > staged)
+        memset (ibuff + staged, 0, (staged_end - staged) * sizeof(gfloat));
+    }
 
-  /* Прямое преобразование Фурье. */
+  /* Прямое преобразование Фурье. Спектры блоков размещаются в obuff
+   * с шагом fft_size / 2 комплексных отсчётов. */
 #ifdef HYSCAN_OPEN_MP
 #pragma omp parallel for
 #endif
-  for (i = 0; i < n_fft; i++)
+  for (i = 0; i < n_blocks; i++)
     {
-      pffft_transform (priv->fft,
-                       (const gfloat*) (priv->ibuff + (i * half_size)),
-                       (gfloat*) (priv->obuff + (i * full_size)),
-                       (gfloat*) (priv->wbuff + (i * full_size)),
-                       PFFFT_FORWARD);
+      const gfloat *block;
+
+      if (i < n_direct)
+        block = data + i * hop_size;
+      else
+        block = ibuff + (i - n_direct) * hop_size;
+
+      pffft_transform_ordered (fft_real,
+                               block,
+                               (gfloat*) (priv->obuff + (i * half_size)),
+                               (gfloat*) (priv->wbuff + (i * half_size)),
+                               PFFFT_FORWARD);
     }
 
   /* Свёртка и обратное преобразование Фурье. */
@@ -498,38 +2147,206 @@ hyscan_convolution_convolve (HyScanConvolution  *convolution,
   for (i = 0; i < n_fft; i++)
     {
       guint32 offset = i * full_size;
-      guint32 used_size = MIN ((n_points - i * half_size), half_size);
+      guint32 used_size = MIN ((n_points - i * hop_size), hop_size);
+      guint32 j;
 
-      /* Обнуляем выходной буфер, т.к. функция zconvolve_accumulate добавляет
-       * полученный результат к значениям в этом буфере (нам это не нужно). */
       memset (priv->ibuff + offset,
               0,
               full_size * sizeof(HyScanComplexFloat));
 
-      /* Выполняем свёртку. */
-      pffft_zconvolve_accumulate (priv->fft,
-                                  (const gfloat*) (priv->obuff + offset),
-                                  (const gfloat*) fft_image,
-                                  (gfloat*) (priv->ibuff + offset),
-                                  scale * priv->fft_scale);
-
-      /* Выполняем обратное преобразование Фурье. */
-      pffft_zreorder (priv->fft,
-                      (gfloat*) (priv->ibuff + offset),
-                      (gfloat*) (priv->obuff + offset),
-                      PFFFT_FORWARD);
+      for (j = 0; j < plan->n_parts; j++)
+        {
+          hyscan_convolution_real_accumulate ((const gfloat*) (priv->obuff + (i + j) * half_size),
+                                              ordered_parts + j * full_size,
+                                              priv->ibuff + offset,
+                                              full_size,
+                                              scale * plan->scale);
+        }
 
-      pffft_transform_ordered (priv->fft,
-                               (gfloat*) (priv->obuff + offset),
+      pffft_transform_ordered (plan->fft,
+                               (gfloat*) (priv->ibuff + offset),
                                (gfloat*) (priv->ibuff + offset),
                                (gfloat*) (priv->wbuff + offset),
                                PFFFT_BACKWARD);
 
-      /* Копируем результат обратно в буфер пользователя. */
-      memcpy (data + offset / 2,
+      memcpy (output + i * hop_size,
               priv->ibuff + offset,
               used_size * sizeof (HyScanComplexFloat));
     }
 
   return TRUE;
 }
+
+/**
+ * hyscan_convolution_convolve_decimate:
+ * @convolution: указатель на #HyScanConvolution
+ * @index: номер образа сигнала
+ * @data: (array length=n_points) (transfer none): данные для свёртки
+ * @output: (out) (transfer none): буфер для результата свёртки
+ * @n_points: размер данных в точках
+ * @decimation: коэффициент децимации
+ * @antialias: применять маску, подавляющую наложение спектров
+ * @scale: коэффициент масштабирования
+ *
+ * Функция выполняет свёртку данных с образом и децимацию результата.
+ * В массив output записывается каждый decimation отсчёт свёртки, размер
+ * массива должен быть не меньше (n_points + decimation - 1) / decimation.
+ * Массивы data и output могут совпадать.
+ *
+ * Децимация выполняется в частотной области: спектр каждого блока
+ * "сворачивается" до размера fft_size / decimation, после чего выполняется
+ * обратное преобразование Фурье уменьшенного размера. Если такое
+ * преобразование невозможно, используется наибольший допустимый делитель
+ * коэффициента децимации, а оставшаяся децимация выполняется прореживанием.
+ *
+ * Если @antialias равен %TRUE, перед децимацией спектр ограничивается
+ * полосой шириной 1 / decimation от частоты дискретизации, в которую
+ * попадает максимальная энергия образа. Иначе результат совпадает с
+ * прореживанием результата функции #hyscan_convolution_convolve.
+ *
+ * Returns: %TRUE если свёртка выполнена, иначе %FALSE.
+ */
+gboolean
+hyscan_convolution_convolve_decimate (HyScanConvolution        *convolution,
+                                      guint                     index,
+                                      const HyScanComplexFloat *data,
+                                      HyScanComplexFloat       *output,
+                                      guint32                   n_points,
+                                      guint                     decimation,
+                                      gboolean                  antialias,
+                                      gfloat                    scale)
+{
+  HyScanConvolutionPrivate *priv;
+  HyScanConvolutionPlan *plan;
+
+  PFFFT_Setup *fft_dec;
+
+  guint32 full_size;
+  guint32 hop_size;
+  guint32 fold_size;
+  guint32 mask_start;
+  guint32 n_output;
+  guint fold;
+  gint32 n_fft;
+  gint32 i;
+
+  g_return_val_if_fail (HYSCAN_IS_CONVOLUTION (convolution), FALSE);
+  g_return_val_if_fail (decimation > 0, FALSE);
+
+  priv = convolution->priv;
+
+  /* Свёртка выполняется так же, как и в функции hyscan_convolution_convolve.
+   * Перед обратным преобразованием Фурье спектр блока Y размером fft_size
+   * "сворачивается" до размера fft_size / fold: Z[k] = sum (Y[k + r * fft_size / fold]).
+   * Обратное преобразование Фурье спектра Z даёт каждый fold отсчёт
+   * обратного преобразования спектра Y. Если используется маска, в спектре
+   * Y остаются только fft_size / decimation отсчётов, которые при
+   * сворачивании не накладываются друг на друга. */
+
+  /* Образ свёртки. */
+  plan = hyscan_convolution_lookup (priv, index, n_points);
+  if (plan == NULL)
+    return FALSE;
+
+  full_size = plan->fft_size;
+  hop_size = plan->hop_size;
+
+  /* Ищем наибольший делитель коэффициента децимации, для которого возможно
+   * обратное преобразование уменьшенного размера. Начало каждого блока
+   * должно совпадать с одним из отсчётов после сворачивания, поэтому шаг
+   * между блоками должен быть кратен fold. */
+  fft_dec = NULL;
+  for (fold = decimation; fold > 1; fold--)
+    {
+      if ((decimation % fold) != 0 || (full_size % fold) != 0 || (hop_size % fold) != 0)
+        continue;
+
+      fold_size = full_size / fold;
+      if ((fold_size % 16) != 0)
+        continue;
+
+      fft_dec = hyscan_convolution_get_setup (priv, fold_size, PFFFT_COMPLEX);
+      if (fft_dec != NULL)
+        break;
+    }
+
+  if (fold == 1)
+    fft_dec = plan->fft;
+
+  fold_size = full_size / fold;
+
+  /* Положение полосы пропускания маски. */
+  mask_start = antialias ? hyscan_convolution_plan_get_mask_start (plan, decimation) : 0;
+
+  /* Число отсчётов результата. */
+  n_output = (n_points + decimation - 1) / decimation;
+
+  /* Прямое преобразование Фурье. */
+  n_fft = hyscan_convolution_forward (priv, plan, data, n_points);
+
+  /* Свёртка, децимация и обратное преобразование Фурье. */
+#ifdef HYSCAN_OPEN_MP
+#pragma omp parallel for
+#endif
+  for (i = 0; i < n_fft; i++)
+    {
+      HyScanComplexFloat *spectrum = priv->ibuff + i * full_size;
+      HyScanComplexFloat *folded = priv->wbuff + i * full_size;
+      guint32 start = i * hop_size;
+      guint32 first;
+      guint32 last;
+      guint32 j, k;
+
+      hyscan_convolution_multiply (priv, plan, i, folded, scale);
+
+      pffft_zreorder (plan->fft,
+                      (gfloat*) folded,
+                      (gfloat*) spectrum,
+                      PFFFT_FORWARD);
+
+      /* Сворачиваем спектр. При использовании маски каждый отсчёт
+       * свёрнутого спектра получает ровно один отсчёт из полосы пропускания. */
+      memset (folded, 0, fold_size * sizeof(HyScanComplexFloat));
+      if (antialias)
+        {
+          guint32 band_size = full_size / decimation;
+
+          for (j = 0; j < band_size; j++)
+            {
+              guint32 src = (mask_start + j) % full_size;
+              guint32 dst = src % fold_size;
+
+              folded[dst].re += spectrum[src].re;
+              folded[dst].im += spectrum[src].im;
+            }
+        }
+      else
+        {
+          for (j = 0; j < fold; j++)
+            {
+              for (k = 0; k < fold_size; k++)
+                {
+                  folded[k].re += spectrum[j * fold_size + k].re;
+                  folded[k].im += spectrum[j * fold_size + k].im;
+                }
+            }
+        }
+
+      /* Обратное преобразование Фурье уменьшенного размера. */
+      pffft_transform_ordered (fft_dec,
+                               (gfloat*) folded,
+                               (gfloat*) folded,
+                               (gfloat*) spectrum,
+                               PFFFT_BACKWARD);
+
+      /* Отсчёты результата, принадлежащие этому блоку. */
+      first = start / decimation + ((start % decimation) ? 1 : 0);
+      last = MIN (start + hop_size, n_points);
+      last = MIN ((last + decimation - 1) / decimation, n_output);
+
+      for (k = first; k < last; k++)
+        output[k] = folded[(k * decimation - start) / fold];
+    }
+
+  return TRUE;
+}
@@ -35,8 +35,9 @@
 #ifndef __HYSCAN_CONVOLUTION_H__
 #define __HYSCAN_CONVOLUTION_H__
 
-#include <glib-object.h>
+#include <gio/gio.h>
 #include <hyscan-types.h>
+#include <hyscan-convolution-image.h>
 
 G_BEGIN_DECLS
 
@@ -50,6 +51,22 @@ G_BEGIN_DECLS
 typedef struct _HyScanConvolution HyScanConvolution;
 typedef struct _HyScanConvolutionPrivate HyScanConvolutionPrivate;
 typedef struct _HyScanConvolutionClass HyScanConvolutionClass;
+typedef struct _HyScanConvolutionGate HyScanConvolutionGate;
+typedef struct _HyScanConvolutionPeak HyScanConvolutionPeak;
+
+/**
+ * HyScanConvolutionPeakInterpolation:
+ * @HYSCAN_CONVOLUTION_PEAK_PARABOLIC:  Парабола по амплитуде.
+ * @HYSCAN_CONVOLUTION_PEAK_GAUSSIAN:   Гауссиана (парабола по логарифму амплитуды).
+ *
+ * Способ уточнения положения пика между отсчётами.
+ */
+typedef enum
+{
+  HYSCAN_CONVOLUTION_PEAK_PARABOLIC,
+  HYSCAN_CONVOLUTION_PEAK_GAUSSIAN
+
+} HyScanConvolutionPeakInterpolation;
 
 struct _HyScanConvolution
 {
@@ -63,33 +80,195 @@ struct _HyScanConvolutionClass
   GObjectClass parent_class;
 };
 
+/**
+ * HyScanConvolutionGate:
+ * @start: индекс первого отсчёта результата
+ * @end: индекс отсчёта, следующего за последним
+ *
+ * Интервал отсчётов результата свёртки [start, end).
+ */
+struct _HyScanConvolutionGate
+{
+  guint32              start;
+  guint32              end;
+};
+
+/**
+ * HyScanConvolutionPeak:
+ * @offset: положение пика в отсчётах с учётом дробной части
+ * @amplitude: уточнённая амплитуда пика
+ *
+ * Пик результата свёртки (взаимной корреляции).
+ */
+struct _HyScanConvolutionPeak
+{
+  gdouble              offset;
+  gfloat               amplitude;
+};
+
+HYSCAN_API
+GType               hyscan_convolution_get_type              (void);
+
+HYSCAN_API
+HyScanConvolution * hyscan_convolution_new                   (void);
+
+HYSCAN_API
+guint32             hyscan_convolution_get_fft_size          (guint32                             size);
+
+HYSCAN_API
+gboolean            hyscan_convolution_set_image_td          (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *image,
+                                                              guint32                             n_points);
+
+HYSCAN_API
+gboolean            hyscan_convolution_set_image_fd          (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *image,
+                                                              guint32                             n_points);
+
+HYSCAN_API
+gboolean            hyscan_convolution_convolve              (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              HyScanComplexFloat                 *data,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale);
+
+HYSCAN_API
+guint32             hyscan_convolution_get_optimal_fft_size  (guint32                             image_size,
+                                                              guint32                             line_size,
+                                                              guint32                             max_fft_size,
+                                                              guint32                            *hop_size);
+
+HYSCAN_API
+void                hyscan_convolution_set_max_fft_size      (HyScanConvolution                  *convolution,
+                                                              guint32                             fft_size);
+
+HYSCAN_API
+void                hyscan_convolution_set_background_fft    (HyScanConvolution                  *convolution,
+                                                              gboolean                            background);
+
+HYSCAN_API
+gboolean            hyscan_convolution_set_image             (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              HyScanConvolutionImage             *image);
+
+HYSCAN_API
+gboolean            hyscan_convolution_convolve_out          (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              HyScanComplexFloat                 *output,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale);
+
+HYSCAN_API
+gboolean            hyscan_convolution_convolve_gated        (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              guint32                             n_points,
+                                                              const HyScanConvolutionGate        *gates,
+                                                              guint                               n_gates,
+                                                              HyScanComplexFloat                 *output,
+                                                              gfloat                              scale);
+
+HYSCAN_API
+gboolean            hyscan_convolution_find_peaks            (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale,
+                                                              HyScanConvolutionPeakInterpolation  interpolation,
+                                                              HyScanConvolutionPeak              *peaks,
+                                                              guint                               n_peaks,
+                                                              guint                              *n_found);
+
+HYSCAN_API
+gboolean            hyscan_convolution_find_peaks_batch      (HyScanConvolution                  *convolution,
+                                                              const guint                        *indexes,
+                                                              const HyScanComplexFloat * const   *data,
+                                                              guint                               n_lines,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale,
+                                                              HyScanConvolutionPeakInterpolation  interpolation,
+                                                              HyScanConvolutionPeak              *peaks,
+                                                              guint                               n_peaks,
+                                                              guint                              *n_found);
+
+HYSCAN_API
+gboolean            hyscan_convolution_set_doppler_bank      (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              gdouble                             discretization,
+                                                              gdouble                             start_frequency,
+                                                              gdouble                             end_frequency,
+                                                              gdouble                             duration,
+                                                              const gdouble                      *dopplers,
+                                                              guint                               n_dopplers);
+
+HYSCAN_API
+gboolean            hyscan_convolution_convolve_bank         (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              guint                               n_images,
+                                                              const HyScanComplexFloat           *data,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale,
+                                                              gfloat                             *map,
+                                                              gfloat                             *amplitude,
+                                                              guint                              *best);
+
+HYSCAN_API
+void                hyscan_convolution_set_queue_depth       (HyScanConvolution                  *convolution,
+                                                              guint                               depth);
+
 HYSCAN_API
-GType               hyscan_convolution_get_type       (void);
+gboolean            hyscan_convolution_convolve_async        (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              HyScanComplexFloat                 *output,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale,
+                                                              GCancellable                       *cancellable,
+                                                              GAsyncReadyCallback                 callback,
+                                                              gpointer                            user_data);
 
 HYSCAN_API
-HyScanConvolution * hyscan_convolution_new            (void);
+gboolean            hyscan_convolution_convolve_finish       (HyScanConvolution                  *convolution,
+                                                              GAsyncResult                       *result,
+                                                              GError                            **error);
 
 HYSCAN_API
-guint32             hyscan_convolution_get_fft_size   (guint32                    size);
+gboolean            hyscan_convolution_convolve_amplitude    (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              gfloat                             *output,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale);
 
 HYSCAN_API
-gboolean            hyscan_convolution_set_image_td   (HyScanConvolution         *convolution,
-                                                       guint                      index,
-                                                       const HyScanComplexFloat  *image,
-                                                       guint32                    n_points);
+gboolean            hyscan_convolution_convolve_db           (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              gfloat                             *output,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale,
+                                                              gfloat                              floor_db);
 
 HYSCAN_API
-gboolean            hyscan_convolution_set_image_fd   (HyScanConvolution         *convolution,
-                                                       guint                      index,
-                                                       const HyScanComplexFloat  *image,
-                                                       guint32                    n_points);
+gboolean            hyscan_convolution_convolve_real         (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const gfloat                       *data,
+                                                              HyScanComplexFloat                 *output,
+                                                              guint32                             n_points,
+                                                              gfloat                              scale);
 
 HYSCAN_API
-gboolean            hyscan_convolution_convolve       (HyScanConvolution         *convolution,
-                                                       guint                      index,
-                                                       HyScanComplexFloat        *data,
-                                                       guint32                    n_points,
-                                                       gfloat                     scale);
+gboolean            hyscan_convolution_convolve_decimate     (HyScanConvolution                  *convolution,
+                                                              guint                               index,
+                                                              const HyScanComplexFloat           *data,
+                                                              HyScanComplexFloat                 *output,
+                                                              guint32                             n_points,
+                                                              guint                               decimation,
+                                                              gboolean                            antialias,
+                                                              gfloat                              scale);
 
 G_END_DECLS
 
@@ -0,0 +1,674 @@
+/* hyscan-ddc.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+/**
+ * SECTION: hyscan-ddc
+ * @Short_description: класс цифрового преобразования сигнала на нулевую частоту
+ * @Title: HyScanDDC
+ *
+ * Класс предназначен для преобразования действительных отсчётов АЦП в
+ * комплексные отсчёты на нулевой частоте с понижением частоты дискретизации.
+ * Результат может использоваться классами #HyScanConvolution и
+ * #HyScanInter2DOA.
+ *
+ * Создание объекта производится с помощью функции #hyscan_ddc_new.
+ *
+ * Параметры преобразования задаются функцией #hyscan_ddc_configure:
+ * частота дискретизации АЦП, частота гетеродина и коэффициент децимации.
+ * Частота дискретизации результата возвращается функцией
+ * #hyscan_ddc_get_data_rate.
+ *
+ * Входные отсчёты умножаются на комплексный гетеродин exp (-j * 2 * pi *
+ * heterodyne * t), поэтому нулевой частоте результата соответствует частота
+ * гетеродина, а сигнал с несущей частотой frequency0 оказывается на частоте
+ * frequency0 - heterodyne. Это совпадает с соглашением функции
+ * #hyscan_fft_set_transposition, в которую передаются та же частота
+ * гетеродина и частота дискретизации результата. Образы сигналов для
+ * свёртки (см. #HyScanSignal) при этом рассчитываются для частот,
+ * отсчитанных от частоты гетеродина. Амплитуда результата равна амплитуде
+ * входного гармонического сигнала.
+ *
+ * Отсчёты гетеродина рассчитываются блоками: отсчёты блока получаются
+ * умножением точно рассчитанного опорного отсчёта на постоянный массив
+ * множителей, поэтому ошибка не накапливается.
+ *
+ * Децимация производится цепочкой фильтров. Коэффициент децимации
+ * раскладывается на нечётный множитель и степень двойки. Нечётный множитель
+ * реализуется КИХ фильтром, для которого рассчитываются только выходные
+ * отсчёты, а каждое понижение частоты в два раза - полуполосным фильтром
+ * в полифазной форме, в котором половина коэффициентов равна нулю и не
+ * участвует в расчёте. Полоса пропускания цепочки составляет +/- 0.4 частоты
+ * дискретизации результата, подавление в полосе заграждения - не менее 90 дБ.
+ * Каждый следующий фильтр работает на меньшей частоте, а требования к
+ * ширине переходной полосы первых фильтров невысоки, поэтому основной объём
+ * вычислений приходится на короткие фильтры.
+ *
+ * Обработка данных производится функцией #hyscan_ddc_process. Состояние
+ * гетеродина и фильтров сохраняется между вызовами, поэтому данные можно
+ * передавать частями произвольного размера. Число выходных отсчётов для
+ * следующего вызова можно узнать функцией #hyscan_ddc_get_output_size, а
+ * задержку, вносимую фильтрами, - функцией #hyscan_ddc_get_delay. Сброс
+ * состояния производится функцией #hyscan_ddc_reset.
+ */
+
+#include "hyscan-ddc.h"
+#include "hyscan-fir-design.h"
+#include <math.h>
+#include <string.h>
+
+/* Размер блока отсчётов гетеродина. */
+#define HYSCAN_DDC_BLOCK_SIZE          256
+
+/* Максимальное число входных отсчётов, обрабатываемых за один проход. */
+#define HYSCAN_DDC_CHUNK_SIZE          4096
+
+/* Число независимых сумм при расчёте свёртки. */
+#define HYSCAN_DDC_LANES               8
+
+/* Полоса пропускания относительно частоты дискретизации результата. */
+#define HYSCAN_DDC_PASSBAND            0.4
+
+/* Подавление в полосе заграждения, дБ. */
+#define HYSCAN_DDC_ATTENUATION         90.0
+
+/* Максимальный коэффициент децимации. */
+#define HYSCAN_DDC_MAX_DECIMATION      1024
+
+/* Ступень децимации. */
+typedef struct
+{
+  gboolean                     halfband;       /* Признак полуполосного фильтра. */
+  guint                        factor;         /* Коэффициент децимации. */
+  guint                        length;         /* Длина фильтра. */
+  gfloat                      *taps;           /* Коэффициенты фильтра. */
+  guint                        n_taps;         /* Число коэффициентов, кратное HYSCAN_DDC_LANES. */
+  gfloat                      *re[2];          /* Действительные части входных отсчётов. */
+  gfloat                      *im[2];          /* Мнимые части входных отсчётов. */
+  guint32                      capacity;       /* Размер буферов входных отсчётов. */
+  guint32                      n_points;       /* Число входных отсчётов в буфере. */
+} HyScanDDCStage;
+
+struct _HyScanDDCPrivate
+{
+  gdouble                      disc_freq;      /* Частота дискретизации АЦП. */
+  gdouble                      heterodyne;     /* Частота гетеродина. */
+  guint                        decimation;     /* Коэффициент децимации. */
+  gdouble                      delay;          /* Задержка фильтров, в отсчётах результата. */
+
+  gdouble                      omega;          /* Приращение фазы гетеродина, радиан / отсчёт. */
+  gdouble                      phase;          /* Текущая фаза гетеродина. */
+  gfloat                       nco_re[HYSCAN_DDC_BLOCK_SIZE];
+  gfloat                       nco_im[HYSCAN_DDC_BLOCK_SIZE];
+  guint                        counter;        /* Номер входного отсчёта по модулю коэффициента децимации. */
+
+  HyScanDDCStage              *stages;         /* Ступени децимации. */
+  guint                        n_stages;       /* Число ступеней децимации. */
+
+  gfloat                      *re;             /* Буфер действительных частей. */
+  gfloat                      *im;             /* Буфер мнимых частей. */
+};
+
+static void      hyscan_ddc_object_finalize    (GObject                *object);
+
+static void      hyscan_ddc_stage_init         (HyScanDDCStage         *stage,
+                                                guint                   factor,
+                                                gdouble                 transition);
+
+static void      hyscan_ddc_stage_clear        (HyScanDDCStage         *stage);
+
+static void      hyscan_ddc_stage_reset        (HyScanDDCStage         *stage);
+
+static void      hyscan_ddc_stage_append       (HyScanDDCStage         *stage,
+                                                const gfloat           *re,
+                                                const gfloat           *im,
+                                                guint32                 n_points);
+
+static guint32   hyscan_ddc_stage_filter       (HyScanDDCStage         *stage,
+                                                gfloat                 *re,
+                                                gfloat                 *im);
+
+static void      hyscan_ddc_mix                (HyScanDDCPrivate       *priv,
+                                                const gfloat           *input,
+                                                guint32                 n_points);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanDDC, hyscan_ddc, G_TYPE_OBJECT)
+
+static void
+hyscan_ddc_class_init (HyScanDDCClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_ddc_object_finalize;
+}
+
+static void
+hyscan_ddc_init (HyScanDDC *ddc)
+{
+  ddc->priv = hyscan_ddc_get_instance_private (ddc);
+}
+
+static void
+hyscan_ddc_object_finalize (GObject *object)
+{
+  HyScanDDC *ddc = HYSCAN_DDC (object);
+  HyScanDDCPrivate *priv = ddc->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_stages; i++)
+    hyscan_ddc_stage_clear (&priv->stages[i]);
+
+  g_free (priv->stages);
+  g_free (priv->re);
+  g_free (priv->im);
+
+  G_OBJECT_CLASS (hyscan_ddc_parent_class)->finalize (object);
+}
+
+/* Функция рассчитывает фильтр ступени децимации. Для коэффициента 2
+ * используется полуполосный фильтр длиной 4 * K - 1, у которого все
+ * коэффициенты с нечётными индексами, кроме центрального, равны нулю.
+ * Центральный коэффициент равен 0.5, поэтому из фильтра сохраняются
+ * только коэффициенты с чётными индексами. */
+static void
+hyscan_ddc_stage_init (HyScanDDCStage *stage,
+                       guint           factor,
+                       gdouble         transition)
+{
+  guint length = hyscan_fir_design_length (transition, HYSCAN_DDC_ATTENUATION);
+  gdouble *h;
+  guint i;
+
+  stage->factor = factor;
+  stage->halfband = (factor == 2);
+
+  if (stage->halfband)
+    {
+      guint half = (length + 4) / 4;
+      gdouble sum = 0.0;
+
+      stage->length = 4 * half - 1;
+      h = hyscan_fir_design_lowpass (stage->length, 0.25, HYSCAN_DDC_ATTENUATION);
+
+      for (i = 0; i < stage->length; i += 2)
+        sum += h[i];
+
+      stage->n_taps = 2 * half;
+      stage->n_taps += (HYSCAN_DDC_LANES - stage->n_taps % HYSCAN_DDC_LANES) % HYSCAN_DDC_LANES;
+      stage->taps = g_new0 (gfloat, stage->n_taps);
+      for (i = 0; i < 2 * half; i++)
+        stage->taps[i] = 0.5 * h[2 * i] / sum;
+
+      stage->capacity = (stage->length + HYSCAN_DDC_CHUNK_SIZE) / 2 + HYSCAN_DDC_LANES + 1;
+    }
+  else
+    {
+      stage->length = length | 1;
+      h = hyscan_fir_design_lowpass (stage->length, 0.5 / factor, HYSCAN_DDC_ATTENUATION);
+
+      stage->n_taps = stage->length;
+      stage->n_taps += (HYSCAN_DDC_LANES - stage->n_taps % HYSCAN_DDC_LANES) % HYSCAN_DDC_LANES;
+      stage->taps = g_new0 (gfloat, stage->n_taps);
+      for (i = 0; i < stage->length; i++)
+        stage->taps[i] = h[i];
+
+      stage->capacity = stage->length + HYSCAN_DDC_CHUNK_SIZE + HYSCAN_DDC_LANES;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      stage->re[i] = g_new (gfloat, stage->capacity);
+      stage->im[i] = g_new (gfloat, stage->capacity);
+    }
+
+  hyscan_ddc_stage_reset (stage);
+
+  g_free (h);
+}
+
+/* Функция освобождает память ступени децимации. */
+static void
+hyscan_ddc_stage_clear (HyScanDDCStage *stage)
+{
+  guint i;
+
+  g_free (stage->taps);
+  for (i = 0; i < 2; i++)
+    {
+      g_free (stage->re[i]);
+      g_free (stage->im[i]);
+    }
+}
+
+/* Функция заполняет историю фильтра нулями. Первый выходной отсчёт
+ * соответствует первому входному отсчёту. */
+static void
+hyscan_ddc_stage_reset (HyScanDDCStage *stage)
+{
+  guint i;
+
+  for (i = 0; i < 2; i++)
+    {
+      memset (stage->re[i], 0, stage->capacity * sizeof (gfloat));
+      memset (stage->im[i], 0, stage->capacity * sizeof (gfloat));
+    }
+
+  stage->n_points = stage->length - 1;
+}
+
+/* Функция добавляет отсчёты во входной буфер ступени. Для полуполосного
+ * фильтра отсчёты с чётными и нечётными номерами хранятся раздельно. */
+static void
+hyscan_ddc_stage_append (HyScanDDCStage *stage,
+                         const gfloat   *re,
+                         const gfloat   *im,
+                         guint32         n_points)
+{
+  guint32 i;
+
+  if (!stage->halfband)
+    {
+      memcpy (stage->re[0] + stage->n_points, re, n_points * sizeof (gfloat));
+      memcpy (stage->im[0] + stage->n_points, im, n_points * sizeof (gfloat));
+      stage->n_points += n_points;
+      return;
+    }
+
+  for (i = 0; i < n_points; i++, stage->n_points++)
+    {
+      guint phase = stage->n_points % 2;
+      guint32 index = stage->n_points / 2;
+
+      stage->re[phase][index] = re[i];
+      stage->im[phase][index] = im[i];
+    }
+}
+
+/* Функция рассчитывает выходные отсчёты ступени по накопленным входным
+ * отсчётам и удаляет из буфера отсчёты, которые больше не понадобятся.
+ * Свёртка рассчитывается HYSCAN_DDC_LANES независимыми суммами, внутренний
+ * цикл по которым векторизуется компилятором. */
+static guint32
+hyscan_ddc_stage_filter (HyScanDDCStage *stage,
+                         gfloat         *re,
+                         gfloat         *im)
+{
+  const gfloat *taps = stage->taps;
+  const gfloat *x_re = stage->re[0];
+  const gfloat *x_im = stage->im[0];
+  guint32 center = (stage->length - 3) / 4;
+  guint32 step = stage->halfband ? 1 : stage->factor;
+  guint32 n_out = 0;
+  guint32 start;
+
+  for (start = 0; start + stage->length <= stage->n_points; start += stage->factor, n_out++)
+    {
+      gfloat acc_re[HYSCAN_DDC_LANES] = {0.0f};
+      gfloat acc_im[HYSCAN_DDC_LANES] = {0.0f};
+      gfloat sum_re = 0.0f;
+      gfloat sum_im = 0.0f;
+      guint32 offset = n_out * step;
+      guint i, l;
+
+      for (i = 0; i < stage->n_taps; i += HYSCAN_DDC_LANES)
+        {
+          for (l = 0; l < HYSCAN_DDC_LANES; l++)
+            {
+              acc_re[l] += taps[i + l] * x_re[offset + i + l];
+              acc_im[l] += taps[i + l] * x_im[offset + i + l];
+            }
+        }
+
+      for (l = 0; l < HYSCAN_DDC_LANES; l++)
+        {
+          sum_re += acc_re[l];
+          sum_im += acc_im[l];
+        }
+
+      /* Центральный коэффициент полуполосного фильтра. */
+      if (stage->halfband)
+        {
+          sum_re += 0.5f * stage->re[1][offset + center];
+          sum_im += 0.5f * stage->im[1][offset + center];
+        }
+
+      re[n_out] = sum_re;
+      im[n_out] = sum_im;
+    }
+
+  /* Удаляем использованные отсчёты. */
+  if (stage->halfband)
+    {
+      guint32 n_even = (stage->n_points + 1) / 2 - n_out;
+      guint32 n_odd = stage->n_points / 2 - n_out;
+
+      memmove (stage->re[0], stage->re[0] + n_out, n_even * sizeof (gfloat));
+      memmove (stage->im[0], stage->im[0] + n_out, n_even * sizeof (gfloat));
+      memmove (stage->re[1], stage->re[1] + n_out, n_odd * sizeof (gfloat));
+      memmove (stage->im[1], stage->im[1] + n_out, n_odd * sizeof (gfloat));
+    }
+  else
+    {
+      memmove (stage->re[0], stage->re[0] + start, (stage->n_points - start) * sizeof (gfloat));
+      memmove (stage->im[0], stage->im[0] + start, (stage->n_points - start) * sizeof (gfloat));
+    }
+
+  stage->n_points -= start;
+
+  return n_out;
+}
+
+/* Функция переносит сигнал на нулевую частоту. Отсчёты гетеродина каждого
+ * блока рассчитываются умножением опорного отсчёта блока на массив
+ * множителей exp (-j * omega * k). */
+static void
+hyscan_ddc_mix (HyScanDDCPrivate *priv,
+                const gfloat     *input,
+                guint32           n_points)
+{
+  guint32 start;
+
+  for (start = 0; start < n_points; start += HYSCAN_DDC_BLOCK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_DDC_BLOCK_SIZE, n_points - start);
+      gfloat a_re = 2.0 * cos (priv->phase);
+      gfloat a_im = -2.0 * sin (priv->phase);
+      const gfloat *x = input + start;
+      gfloat *re = priv->re + start;
+      gfloat *im = priv->im + start;
+      guint32 k;
+
+      for (k = 0; k < n; k++)
+        {
+          re[k] = x[k] * (a_re * priv->nco_re[k] - a_im * priv->nco_im[k]);
+          im[k] = x[k] * (a_re * priv->nco_im[k] + a_im * priv->nco_re[k]);
+        }
+
+      priv->phase = fmod (priv->phase + priv->omega * n, 2.0 * G_PI);
+    }
+}
+
+/**
+ * hyscan_ddc_new:
+ *
+ * Функция создаёт новый объект #HyScanDDC.
+ *
+ * Returns: #HyScanDDC. Для удаления #g_object_unref.
+ */
+HyScanDDC *
+hyscan_ddc_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_DDC, NULL);
+}
+
+/**
+ * hyscan_ddc_configure:
+ * @ddc: указатель на #HyScanDDC
+ * @disc_freq: частота дискретизации входных данных, Гц
+ * @heterodyne: частота гетеродина, Гц
+ * @decimation: коэффициент децимации
+ *
+ * Функция задаёт параметры преобразования и сбрасывает состояние объекта.
+ * Коэффициент децимации должен находиться в пределах от 1 до 1024.
+ *
+ * Returns: %TRUE если параметры установлены, иначе %FALSE.
+ */
+gboolean
+hyscan_ddc_configure (HyScanDDC *ddc,
+                      gdouble    disc_freq,
+                      gdouble    heterodyne,
+                      guint      decimation)
+{
+  HyScanDDCPrivate *priv;
+  gdouble passband;
+  gdouble rate;
+  guint odd;
+  guint i, k;
+
+  g_return_val_if_fail (HYSCAN_IS_DDC (ddc), FALSE);
+
+  priv = ddc->priv;
+
+  if ((disc_freq <= 0.0) || (decimation == 0) || (decimation > HYSCAN_DDC_MAX_DECIMATION))
+    {
+      g_warning ("HyScanDDC: incorrect parameters");
+      return FALSE;
+    }
+
+  for (i = 0; i < priv->n_stages; i++)
+    hyscan_ddc_stage_clear (&priv->stages[i]);
+  g_clear_pointer (&priv->stages, g_free);
+  priv->n_stages = 0;
+
+  if (priv->re == NULL)
+    {
+      priv->re = g_new0 (gfloat, HYSCAN_DDC_CHUNK_SIZE);
+      priv->im = g_new0 (gfloat, HYSCAN_DDC_CHUNK_SIZE);
+    }
+
+  priv->disc_freq = disc_freq;
+  priv->heterodyne = heterodyne;
+  priv->decimation = decimation;
+  priv->omega = fmod (2.0 * G_PI * heterodyne / disc_freq, 2.0 * G_PI);
+
+  for (k = 0; k < HYSCAN_DDC_BLOCK_SIZE; k++)
+    {
+      priv->nco_re[k] = cos (priv->omega * k);
+      priv->nco_im[k] = -sin (priv->omega * k);
+    }
+
+  /* Раскладываем коэффициент децимации на нечётный множитель и степень двойки. */
+  for (odd = decimation, k = 0; (odd % 2) == 0; odd /= 2)
+    k++;
+
+  priv->n_stages = k + ((odd > 1) ? 1 : 0);
+  priv->stages = g_new0 (HyScanDDCStage, priv->n_stages);
+
+  /* Ширина переходной полосы каждой ступени выбирается так, чтобы
+   * наложение спектров не затрагивало полосу пропускания результата. */
+  passband = HYSCAN_DDC_PASSBAND * disc_freq / decimation;
+  rate = disc_freq;
+  priv->delay = 0.0;
+
+  for (i = 0; i < priv->n_stages; i++)
+    {
+      HyScanDDCStage *stage = &priv->stages[i];
+      guint factor = ((i == 0) && (odd > 1)) ? odd : 2;
+
+      hyscan_ddc_stage_init (stage, factor, (rate / factor - 2.0 * passband) / rate);
+
+      priv->delay += (stage->length - 1) / 2.0 * (disc_freq / rate);
+      rate /= factor;
+    }
+
+  priv->delay /= decimation;
+
+  hyscan_ddc_reset (ddc);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_ddc_get_data_rate:
+ * @ddc: указатель на #HyScanDDC
+ *
+ * Функция возвращает частоту дискретизации результата преобразования. Это
+ * значение передаётся в #hyscan_fft_set_transposition вместе с частотой
+ * гетеродина.
+ *
+ * Returns: Частота дискретизации результата, Гц.
+ */
+gdouble
+hyscan_ddc_get_data_rate (HyScanDDC *ddc)
+{
+  g_return_val_if_fail (HYSCAN_IS_DDC (ddc), 0.0);
+
+  if (ddc->priv->decimation == 0)
+    return 0.0;
+
+  return ddc->priv->disc_freq / ddc->priv->decimation;
+}
+
+/**
+ * hyscan_ddc_get_delay:
+ * @ddc: указатель на #HyScanDDC
+ *
+ * Функция возвращает задержку, вносимую фильтрами децимации. Выходной
+ * отсчёт с номером m соответствует моменту времени (m - delay) / data_rate
+ * от начала входных данных.
+ *
+ * Returns: Задержка в отсчётах результата.
+ */
+gdouble
+hyscan_ddc_get_delay (HyScanDDC *ddc)
+{
+  g_return_val_if_fail (HYSCAN_IS_DDC (ddc), 0.0);
+
+  return ddc->priv->delay;
+}
+
+/**
+ * hyscan_ddc_get_output_size:
+ * @ddc: указатель на #HyScanDDC
+ * @n_points: число входных отсчётов
+ *
+ * Функция возвращает число выходных отсчётов, которое будет рассчитано
+ * при следующем вызове #hyscan_ddc_process для n_points входных отсчётов.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_ddc_get_output_size (HyScanDDC *ddc,
+                            guint32    n_points)
+{
+  HyScanDDCPrivate *priv;
+  guint64 decimation;
+
+  g_return_val_if_fail (HYSCAN_IS_DDC (ddc), 0);
+
+  priv = ddc->priv;
+  decimation = priv->decimation;
+
+  if (decimation == 0)
+    return 0;
+
+  /* Выходной отсчёт рассчитывается для каждого входного отсчёта,
+   * номер которого кратен коэффициенту децимации. */
+  return (priv->counter + n_points + decimation - 1) / decimation -
+         (priv->counter + decimation - 1) / decimation;
+}
+
+/**
+ * hyscan_ddc_process:
+ * @ddc: указатель на #HyScanDDC
+ * @input: (array length=n_points) входные отсчёты
+ * @n_points: число входных отсчётов
+ * @output: (out) (array) буфер для результата
+ *
+ * Функция преобразует очередную часть входных данных. Размер буфера для
+ * результата должен быть не меньше значения, возвращаемого функцией
+ * #hyscan_ddc_get_output_size.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_ddc_process (HyScanDDC          *ddc,
+                    const gfloat       *input,
+                    guint32             n_points,
+                    HyScanComplexFloat *output)
+{
+  HyScanDDCPrivate *priv;
+  guint32 n_out = 0;
+  guint32 offset;
+
+  g_return_val_if_fail (HYSCAN_IS_DDC (ddc), 0);
+
+  priv = ddc->priv;
+
+  if (priv->decimation == 0)
+    {
+      g_warning ("HyScanDDC: parameters not set");
+      return 0;
+    }
+
+  for (offset = 0; offset < n_points; offset += HYSCAN_DDC_CHUNK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_DDC_CHUNK_SIZE, n_points - offset);
+      guint32 i;
+
+      hyscan_ddc_mix (priv, input + offset, n);
+
+      for (i = 0; i < priv->n_stages; i++)
+        {
+          hyscan_ddc_stage_append (&priv->stages[i], priv->re, priv->im, n);
+          n = hyscan_ddc_stage_filter (&priv->stages[i], priv->re, priv->im);
+        }
+
+      for (i = 0; i < n; i++)
+        {
+          output[n_out + i].re = priv->re[i];
+          output[n_out + i].im = priv->im[i];
+        }
+
+      n_out += n;
+    }
+
+  priv->counter = (priv->counter + (guint64) n_points) % priv->decimation;
+
+  return n_out;
+}
+
+/**
+ * hyscan_ddc_reset:
+ * @ddc: указатель на #HyScanDDC
+ *
+ * Функция сбрасывает состояние гетеродина и фильтров. Следующий вызов
+ * #hyscan_ddc_process обрабатывает данные как новый поток.
+ */
+void
+hyscan_ddc_reset (HyScanDDC *ddc)
+{
+  HyScanDDCPrivate *priv;
+  guint i;
+
+  g_return_if_fail (HYSCAN_IS_DDC (ddc));
+
+  priv = ddc->priv;
+
+  priv->phase = 0.0;
+  priv->counter = 0;
+
+  for (i = 0; i < priv->n_stages; i++)
+    hyscan_ddc_stage_reset (&priv->stages[i]);
+}
@@ -0,0 +1,99 @@
+/* hyscan-ddc.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_DDC_H__
+#define __HYSCAN_DDC_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DDC             (hyscan_ddc_get_type ())
+#define HYSCAN_DDC(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DDC, HyScanDDC))
+#define HYSCAN_IS_DDC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DDC))
+#define HYSCAN_DDC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DDC, HyScanDDCClass))
+#define HYSCAN_IS_DDC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DDC))
+#define HYSCAN_DDC_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DDC, HyScanDDCClass))
+
+typedef struct _HyScanDDC HyScanDDC;
+typedef struct _HyScanDDCPrivate HyScanDDCPrivate;
+typedef struct _HyScanDDCClass HyScanDDCClass;
+
+struct _HyScanDDC
+{
+  GObject parent_instance;
+
+  HyScanDDCPrivate *priv;
+};
+
+struct _HyScanDDCClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_ddc_get_type             (void);
+
+HYSCAN_API
+HyScanDDC *            hyscan_ddc_new                  (void);
+
+HYSCAN_API
+gboolean               hyscan_ddc_configure            (HyScanDDC                *ddc,
+                                                        gdouble                   disc_freq,
+                                                        gdouble                   heterodyne,
+                                                        guint                     decimation);
+
+HYSCAN_API
+gdouble                hyscan_ddc_get_data_rate        (HyScanDDC                *ddc);
+
+HYSCAN_API
+gdouble                hyscan_ddc_get_delay            (HyScanDDC                *ddc);
+
+HYSCAN_API
+guint32                hyscan_ddc_get_output_size      (HyScanDDC                *ddc,
+                                                        guint32                   n_points);
+
+HYSCAN_API
+guint32                hyscan_ddc_process              (HyScanDDC                *ddc,
+                                                        const gfloat             *input,
+                                                        guint32                   n_points,
+                                                        HyScanComplexFloat       *output);
+
+HYSCAN_API
+void                   hyscan_ddc_reset                (HyScanDDC                *ddc);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DDC_H__ */
@@ -0,0 +1,108 @@
+/* hyscan-fft-size.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+
+#include "hyscan-fft-size.h"
+
+/* Таблица доспустимых размеров FFT преобразований. */
+static const guint32
+fft_sizes[] = {32, 64, 96, 128, 160, 192, 256, 288, 320, 384, 480, 512, 576, 640, 768,
+               800, 864, 960, 1024, 1152, 1280, 1440, 1536, 1600, 1728, 1920, 2048, 2304,
+               2400, 2560, 2592, 2880, 3072, 3200, 3456, 3840, 4000, 4096, 4320, 4608,
+               4800, 5120, 5184, 5760, 6144, 6400, 6912, 7200, 7680, 7776, 8000, 8192,
+               8640, 9216, 9600, 10240, 10368, 11520, 12000, 12288, 12800, 12960, 13824,
+               14400, 15360, 15552, 16000, 16384, 17280, 18432, 19200, 20000, 20480, 20736,
+               21600, 23040, 23328, 24000, 24576, 25600, 25920, 27648, 28800, 30720, 31104,
+               32000, 32768, 34560, 36000, 36864, 38400, 38880, 40000, 40960, 41472, 43200,
+               46080, 46656, 48000, 49152, 51200, 51840, 55296, 57600, 60000, 61440, 62208,
+               64000, 64800, 65536, 69120, 69984, 72000, 73728, 76800, 77760, 80000, 81920,
+               82944, 86400, 92160, 93312, 96000, 98304, 100000, 102400, 103680, 108000,
+               110592, 115200, 116640, 120000, 122880, 124416, 128000, 129600, 131072,
+               138240, 139968, 144000, 147456, 153600, 155520, 160000, 163840, 165888,
+               172800, 180000, 184320, 186624, 192000, 194400, 196608, 200000, 204800,
+               207360, 209952, 216000, 221184, 230400, 233280, 240000, 245760, 248832,
+               256000, 259200, 262144, 276480, 279936, 288000, 294912, 300000, 307200,
+               311040, 320000, 324000, 327680, 331776, 345600, 349920, 360000, 368640,
+               373248, 384000, 388800, 393216, 400000, 409600, 414720, 419904, 432000,
+               442368, 460800, 466560, 480000, 491520, 497664, 500000, 512000, 518400,
+               524288, 540000, 552960, 559872, 576000, 583200, 589824, 600000, 614400,
+               622080, 629856, 640000, 648000, 655360, 663552, 691200, 699840, 720000,
+               737280, 746496, 768000, 777600, 786432, 800000, 819200, 829440, 839808,
+               864000, 884736, 900000, 921600, 933120, 960000, 972000, 983040, 995328,
+               1000000, 1024000, 1036800, 1048576};
+
+/* Функция возвращает наименьший допустимый размер FFT преобразования,
+ * не меньший указанного, или 0, если такого размера нет. */
+guint32
+hyscan_fft_size_ceil (guint32 size)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (fft_sizes); i++)
+    {
+      if (fft_sizes[i] >= size)
+        return fft_sizes[i];
+    }
+
+  return 0;
+}
+
+/* Функция возвращает наибольший допустимый размер FFT преобразования,
+ * не больший указанного. Если указанный размер меньше минимального,
+ * возвращается минимальный размер. */
+guint32
+hyscan_fft_size_floor (guint32 size)
+{
+  guint32 normalized = fft_sizes[0];
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (fft_sizes); i++)
+    {
+      if (fft_sizes[i] <= size)
+        normalized = fft_sizes[i];
+    }
+
+  return normalized;
+}
+
+/* Функция возвращает таблицу допустимых размеров FFT преобразования,
+ * упорядоченную по возрастанию. */
+const guint32 *
+hyscan_fft_size_list (guint *n_sizes)
+{
+  *n_sizes = G_N_ELEMENTS (fft_sizes);
+
+  return fft_sizes;
+}
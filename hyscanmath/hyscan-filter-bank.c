@@ -0,0 +1,813 @@
+/* hyscan-filter-bank.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+/**
+ * SECTION: hyscan-filter-bank
+ * @Short_description: класс фильтрации многоканальных данных
+ * @Title: HyScanFilterBank
+ *
+ * Класс предназначен для фильтрации действительных и комплексных данных
+ * нескольких каналов одинаковыми КИХ и БИХ фильтрами, например для
+ * ограничения полосы, удаления постоянной составляющей или выравнивания
+ * спектра перед свёрткой (см. #HyScanConvolution).
+ *
+ * Создание объекта производится с помощью функции #hyscan_filter_bank_new,
+ * в которую передаётся число каналов.
+ *
+ * КИХ фильтр задаётся функцией #hyscan_filter_bank_set_fir, каскад звеньев
+ * второго порядка БИХ фильтра - функцией #hyscan_filter_bank_set_iir. Если
+ * заданы оба фильтра, данные сначала обрабатываются КИХ фильтром, а затем
+ * БИХ фильтром.
+ *
+ * Каналы обрабатываются группами: отсчёты нескольких каналов (для
+ * комплексных данных - действительные и мнимые части отдельно) в один
+ * момент времени располагаются рядом и обрабатываются одной векторной
+ * операцией. КИХ фильтры с числом коэффициентов больше 32 реализуются
+ * свёрткой в частотной области с помощью #HyScanConvolution. При этом пары
+ * потоков объединяются в комплексные строки, и строки всех каналов
+ * обрабатываются одной свёрткой. Части данных, короткие по сравнению с
+ * длиной фильтра, фильтруются во временной области. БИХ фильтр
+ * рассчитывается с двойной точностью, что позволяет использовать звенья
+ * с полюсами вблизи единичной окружности.
+ *
+ * Обработка данных производится функциями #hyscan_filter_bank_process_complex
+ * и #hyscan_filter_bank_process_real. Результат записывается во входные
+ * массивы. Состояние фильтров каждого канала сохраняется между вызовами,
+ * поэтому данные можно передавать частями произвольного размера. Внутри
+ * вызова данные обрабатываются шагами фиксированного размера, поэтому
+ * объём рабочих буферов не зависит от размера частей. При переходе от
+ * комплексных данных к действительным необходимо сбросить состояние
+ * фильтров функцией #hyscan_filter_bank_reset.
+ */
+
+#include "hyscan-filter-bank.h"
+#include "hyscan-convolution.h"
+#include "pffft.h"
+#include <string.h>
+
+/* Число каналов, обрабатываемых одной векторной операцией. */
+#define HYSCAN_FILTER_BANK_LANES       8
+
+/* Размер блока отсчётов одной группы каналов. */
+#define HYSCAN_FILTER_BANK_BLOCK_SIZE  256
+
+/* Максимальное число отсчётов каждого канала, обрабатываемых за один шаг. */
+#define HYSCAN_FILTER_BANK_CHUNK_SIZE  4096
+
+/* Число коэффициентов КИХ фильтра, начиная с которого используется
+ * свёртка в частотной области. Вычислительные затраты свёртки на один
+ * отсчёт примерно равны затратам прямого расчёта фильтра с таким числом
+ * коэффициентов, умноженным на отношение размера строки с историей к
+ * числу новых отсчётов. По этой оценке выбирается способ расчёта для
+ * каждого шага обработки. */
+#define HYSCAN_FILTER_BANK_FFT_TAPS    32
+
+enum
+{
+  PROP_O,
+  PROP_N_CHANNELS
+};
+
+struct _HyScanFilterBankPrivate
+{
+  guint                        n_channels;     /* Число каналов. */
+  guint                        n_groups;       /* Число групп действительных потоков. */
+  gpointer                    *chunk;          /* Указатели на данные каналов для шага обработки. */
+
+  gfloat                      *taps;           /* Коэффициенты КИХ фильтра. */
+  guint                        n_taps;         /* Число коэффициентов КИХ фильтра. */
+  gfloat                      *fir_work;       /* Буфер группы потоков. */
+  HyScanConvolution           *convolution;    /* Свёртка для длинных фильтров. */
+
+  HyScanComplexFloat          *rows;           /* Строки пар потоков: история и данные. */
+  guint32                      row_size;       /* Текущий размер строки. */
+  guint32                      rows_size;      /* Размер буфера строк. */
+  HyScanComplexFloat          *result;         /* Буфер результата свёртки. */
+
+  HyScanBiquad                *sections;       /* Звенья БИХ фильтра. */
+  guint                        n_sections;     /* Число звеньев БИХ фильтра. */
+  gdouble                     *iir_state;      /* Состояние звеньев для каждого потока. */
+  gdouble                     *iir_work;       /* Буфер группы потоков. */
+};
+
+static void      hyscan_filter_bank_set_property       (GObject                *object,
+                                                        guint                   prop_id,
+                                                        const GValue           *value,
+                                                        GParamSpec             *pspec);
+static void      hyscan_filter_bank_object_constructed (GObject                *object);
+static void      hyscan_filter_bank_object_finalize    (GObject                *object);
+
+static guint     hyscan_filter_bank_get_lanes          (gpointer const         *data,
+                                                        gboolean                complex,
+                                                        guint                   group,
+                                                        guint                   n_streams,
+                                                        gfloat                **lanes);
+
+static void      hyscan_filter_bank_get_history        (HyScanFilterBankPrivate *priv,
+                                                        guint                   group,
+                                                        guint                   n_lanes,
+                                                        gfloat                **history);
+
+static void      hyscan_filter_bank_resize_rows        (HyScanFilterBankPrivate *priv,
+                                                        guint32                 row_size);
+
+static void      hyscan_filter_bank_fir_direct         (HyScanFilterBankPrivate *priv,
+                                                        gfloat                **lanes,
+                                                        guint                   n_lanes,
+                                                        guint                   stride,
+                                                        gfloat                **history,
+                                                        guint32                 n_points);
+
+static gboolean  hyscan_filter_bank_fir_fft            (HyScanFilterBankPrivate *priv,
+                                                        gpointer const         *data,
+                                                        gboolean                complex,
+                                                        guint32                 n_points);
+
+static void      hyscan_filter_bank_iir                (HyScanFilterBankPrivate *priv,
+                                                        gfloat                **lanes,
+                                                        guint                   n_lanes,
+                                                        guint                   stride,
+                                                        gdouble                *state,
+                                                        guint32                 n_points);
+
+static gboolean  hyscan_filter_bank_process_chunk      (HyScanFilterBankPrivate *priv,
+                                                        gpointer const         *data,
+                                                        gboolean                complex,
+                                                        guint32                 n_points);
+
+static gboolean  hyscan_filter_bank_process            (HyScanFilterBankPrivate *priv,
+                                                        gpointer const         *data,
+                                                        gboolean                complex,
+                                                        guint32                 n_points);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanFilterBank, hyscan_filter_bank, G_TYPE_OBJECT)
+
+static void
+hyscan_filter_bank_class_init (HyScanFilterBankClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_filter_bank_set_property;
+  object_class->constructed = hyscan_filter_bank_object_constructed;
+  object_class->finalize = hyscan_filter_bank_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_N_CHANNELS,
+    g_param_spec_uint ("n-channels", "NChannels", "Number of channels", 1, G_MAXUINT16, 1,
+                       G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_filter_bank_init (HyScanFilterBank *bank)
+{
+  bank->priv = hyscan_filter_bank_get_instance_private (bank);
+}
+
+static void
+hyscan_filter_bank_set_property (GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  HyScanFilterBank *bank = HYSCAN_FILTER_BANK (object);
+  HyScanFilterBankPrivate *priv = bank->priv;
+
+  switch (prop_id)
+    {
+    case PROP_N_CHANNELS:
+      priv->n_channels = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_filter_bank_object_constructed (GObject *object)
+{
+  HyScanFilterBank *bank = HYSCAN_FILTER_BANK (object);
+  HyScanFilterBankPrivate *priv = bank->priv;
+
+  /* Для комплексных данных каждый канал - два действительных потока. */
+  priv->n_groups = (2 * priv->n_channels + HYSCAN_FILTER_BANK_LANES - 1) / HYSCAN_FILTER_BANK_LANES;
+  priv->iir_work = g_new (gdouble, HYSCAN_FILTER_BANK_BLOCK_SIZE * HYSCAN_FILTER_BANK_LANES);
+  priv->chunk = g_new (gpointer, priv->n_channels);
+}
+
+static void
+hyscan_filter_bank_object_finalize (GObject *object)
+{
+  HyScanFilterBank *bank = HYSCAN_FILTER_BANK (object);
+  HyScanFilterBankPrivate *priv = bank->priv;
+
+  g_free (priv->taps);
+  g_free (priv->fir_work);
+  g_clear_object (&priv->convolution);
+
+  pffft_aligned_free (priv->rows);
+  pffft_aligned_free (priv->result);
+
+  g_free (priv->sections);
+  g_free (priv->iir_state);
+  g_free (priv->iir_work);
+  g_free (priv->chunk);
+
+  G_OBJECT_CLASS (hyscan_filter_bank_parent_class)->finalize (object);
+}
+
+/* Функция возвращает указатели на первые отсчёты потоков группы. Поток
+ * 2 * c комплексных данных - действительные части канала c, поток
+ * 2 * c + 1 - мнимые части. Функция возвращает число потоков в группе. */
+static guint
+hyscan_filter_bank_get_lanes (gpointer const *data,
+                              gboolean        complex,
+                              guint           group,
+                              guint           n_streams,
+                              gfloat        **lanes)
+{
+  guint first = group * HYSCAN_FILTER_BANK_LANES;
+  guint n_lanes = MIN (HYSCAN_FILTER_BANK_LANES, n_streams - first);
+  guint l;
+
+  for (l = 0; l < n_lanes; l++)
+    {
+      guint stream = first + l;
+
+      if (complex)
+        lanes[l] = (gfloat *) data[stream / 2] + stream % 2;
+      else
+        lanes[l] = data[stream];
+    }
+
+  return n_lanes;
+}
+
+/* Функция возвращает указатели на историю КИХ фильтра потоков группы.
+ * История потоков 2 * r и 2 * r + 1 хранится в начале строки r в виде
+ * действительных и мнимых частей, поэтому шаг между отсчётами истории
+ * равен двум. */
+static void
+hyscan_filter_bank_get_history (HyScanFilterBankPrivate  *priv,
+                                guint                     group,
+                                guint                     n_lanes,
+                                gfloat                  **history)
+{
+  guint l;
+
+  for (l = 0; l < n_lanes; l++)
+    {
+      guint stream = group * HYSCAN_FILTER_BANK_LANES + l;
+
+      history[l] = (gfloat *) (priv->rows + (stream / 2) * priv->row_size) + stream % 2;
+    }
+}
+
+/* Функция изменяет размер строк, сохраняя историю в начале каждой строки.
+ * Буфер строк рассчитан на историю и один шаг обработки, поэтому размер
+ * строки не превышает n_taps - 1 + HYSCAN_FILTER_BANK_CHUNK_SIZE. */
+static void
+hyscan_filter_bank_resize_rows (HyScanFilterBankPrivate *priv,
+                                guint32                  row_size)
+{
+  const guint n_history = priv->n_taps - 1;
+  const guint n_rows = priv->n_channels;
+  guint r;
+
+  /* При увеличении размера строки сдвигаются с конца, при уменьшении -
+   * с начала, чтобы не затереть историю ещё не перемещённых строк. */
+  if (row_size > priv->row_size)
+    {
+      for (r = n_rows; r-- > 0;)
+        {
+          memmove (priv->rows + r * row_size, priv->rows + r * priv->row_size,
+                   n_history * sizeof (HyScanComplexFloat));
+        }
+    }
+  else if (row_size < priv->row_size)
+    {
+      for (r = 0; r < n_rows; r++)
+        {
+          memmove (priv->rows + r * row_size, priv->rows + r * priv->row_size,
+                   n_history * sizeof (HyScanComplexFloat));
+        }
+    }
+
+  priv->row_size = row_size;
+}
+
+/* Функция рассчитывает КИХ фильтр для группы потоков во временной области.
+ * Отсчёты потоков копируются в буфер, в котором отсчёты разных потоков
+ * для одного момента времени расположены рядом, поэтому внутренний цикл
+ * по потокам векторизуется компилятором. */
+static void
+hyscan_filter_bank_fir_direct (HyScanFilterBankPrivate *priv,
+                               gfloat                 **lanes,
+                               guint                    n_lanes,
+                               guint                    stride,
+                               gfloat                 **history,
+                               guint32                  n_points)
+{
+  const guint n_history = priv->n_taps - 1;
+  gfloat *work = priv->fir_work;
+  guint32 start;
+  guint l, r;
+
+  memset (work, 0, (n_history + HYSCAN_FILTER_BANK_BLOCK_SIZE) * HYSCAN_FILTER_BANK_LANES * sizeof (gfloat));
+
+  for (r = 0; r < n_history; r++)
+    for (l = 0; l < n_lanes; l++)
+      work[r * HYSCAN_FILTER_BANK_LANES + l] = history[l][2 * r];
+
+  for (start = 0; start < n_points; start += HYSCAN_FILTER_BANK_BLOCK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_FILTER_BANK_BLOCK_SIZE, n_points - start);
+      gfloat *input = work + n_history * HYSCAN_FILTER_BANK_LANES;
+      guint32 t;
+      guint k;
+
+      for (t = 0; t < n; t++)
+        for (l = 0; l < n_lanes; l++)
+          input[t * HYSCAN_FILTER_BANK_LANES + l] = lanes[l][(start + t) * stride];
+
+      for (t = 0; t < n; t++)
+        {
+          gfloat acc[HYSCAN_FILTER_BANK_LANES] = {0.0f};
+          const gfloat *x = input + t * HYSCAN_FILTER_BANK_LANES;
+
+          for (k = 0; k < priv->n_taps; k++)
+            {
+              const gfloat *xk = x - k * HYSCAN_FILTER_BANK_LANES;
+
+              for (l = 0; l < HYSCAN_FILTER_BANK_LANES; l++)
+                acc[l] += priv->taps[k] * xk[l];
+            }
+
+          for (l = 0; l < n_lanes; l++)
+            lanes[l][(start + t) * stride] = acc[l];
+        }
+
+      /* Последние отсчёты блока - история для следующего блока. */
+      memmove (work, work + n * HYSCAN_FILTER_BANK_LANES,
+               n_history * HYSCAN_FILTER_BANK_LANES * sizeof (gfloat));
+    }
+
+  for (r = 0; r < n_history; r++)
+    for (l = 0; l < n_lanes; l++)
+      history[l][2 * r] = work[r * HYSCAN_FILTER_BANK_LANES + l];
+}
+
+/* Функция рассчитывает КИХ фильтр для всех каналов свёрткой в частотной
+ * области. Образ свёртки - коэффициенты фильтра в обратном порядке.
+ *
+ * Так как коэффициенты фильтра действительные, действительные и мнимые
+ * части комплексной строки фильтруются независимо. Поэтому строка r
+ * содержит канал r комплексных данных или каналы 2 * r и 2 * r + 1
+ * действительных данных. Данные записываются в строку после истории,
+ * а строки всех каналов располагаются подряд и обрабатываются одним
+ * вызовом свёртки. Отсчёт результата i строки зависит только от отсчётов
+ * этой же строки с i по i + n_taps - 1, поэтому строки не влияют друг на
+ * друга. После свёртки последние отсчёты каждой строки переносятся в её
+ * начало и становятся историей для следующего вызова. */
+static gboolean
+hyscan_filter_bank_fir_fft (HyScanFilterBankPrivate *priv,
+                            gpointer const          *data,
+                            gboolean                 complex,
+                            guint32                  n_points)
+{
+  const guint n_history = priv->n_taps - 1;
+  guint32 row_size = n_history + n_points;
+  guint n_rows = complex ? priv->n_channels : (priv->n_channels + 1) / 2;
+  guint r;
+  guint32 i;
+
+  hyscan_filter_bank_resize_rows (priv, row_size);
+
+  for (r = 0; r < n_rows; r++)
+    {
+      HyScanComplexFloat *row = priv->rows + r * row_size + n_history;
+
+      if (complex)
+        {
+          memcpy (row, data[r], n_points * sizeof (HyScanComplexFloat));
+        }
+      else
+        {
+          const gfloat *re = data[2 * r];
+          const gfloat *im = (2 * r + 1 < priv->n_channels) ? data[2 * r + 1] : NULL;
+
+          for (i = 0; i < n_points; i++)
+            {
+              row[i].re = re[i];
+              row[i].im = (im != NULL) ? im[i] : 0.0f;
+            }
+        }
+    }
+
+  if (!hyscan_convolution_convolve_out (priv->convolution, 0, priv->rows, priv->result,
+                                        n_rows * row_size, priv->n_taps))
+    {
+      return FALSE;
+    }
+
+  for (r = 0; r < n_rows; r++)
+    {
+      HyScanComplexFloat *row = priv->rows + r * row_size;
+      const HyScanComplexFloat *result = priv->result + r * row_size;
+
+      if (complex)
+        {
+          memcpy (data[r], result, n_points * sizeof (HyScanComplexFloat));
+        }
+      else
+        {
+          gfloat *re = data[2 * r];
+          gfloat *im = (2 * r + 1 < priv->n_channels) ? data[2 * r + 1] : NULL;
+
+          for (i = 0; i < n_points; i++)
+            re[i] = result[i].re;
+
+          if (im != NULL)
+            {
+              for (i = 0; i < n_points; i++)
+                im[i] = result[i].im;
+            }
+        }
+
+      memmove (row, row + n_points, n_history * sizeof (HyScanComplexFloat));
+    }
+
+  return TRUE;
+}
+
+/* Функция рассчитывает каскад звеньев БИХ фильтра для группы потоков.
+ * Звенья реализованы в транспонированной прямой форме II. */
+static void
+hyscan_filter_bank_iir (HyScanFilterBankPrivate *priv,
+                        gfloat                 **lanes,
+                        guint                    n_lanes,
+                        guint                    stride,
+                        gdouble                 *state,
+                        guint32                  n_points)
+{
+  gdouble *work = priv->iir_work;
+  guint32 start;
+
+  memset (work, 0, HYSCAN_FILTER_BANK_BLOCK_SIZE * HYSCAN_FILTER_BANK_LANES * sizeof (gdouble));
+
+  for (start = 0; start < n_points; start += HYSCAN_FILTER_BANK_BLOCK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_FILTER_BANK_BLOCK_SIZE, n_points - start);
+      guint32 t;
+      guint s, l;
+
+      for (t = 0; t < n; t++)
+        for (l = 0; l < n_lanes; l++)
+          work[t * HYSCAN_FILTER_BANK_LANES + l] = lanes[l][(start + t) * stride];
+
+      for (s = 0; s < priv->n_sections; s++)
+        {
+          const HyScanBiquad *section = &priv->sections[s];
+          gdouble *z1 = state + 2 * s * HYSCAN_FILTER_BANK_LANES;
+          gdouble *z2 = z1 + HYSCAN_FILTER_BANK_LANES;
+
+          for (t = 0; t < n; t++)
+            {
+              gdouble *v = work + t * HYSCAN_FILTER_BANK_LANES;
+
+              for (l = 0; l < HYSCAN_FILTER_BANK_LANES; l++)
+                {
+                  gdouble x = v[l];
+                  gdouble y = section->b0 * x + z1[l];
+
+                  z1[l] = section->b1 * x - section->a1 * y + z2[l];
+                  z2[l] = section->b2 * x - section->a2 * y;
+                  v[l] = y;
+                }
+            }
+        }
+
+      for (t = 0; t < n; t++)
+        for (l = 0; l < n_lanes; l++)
+          lanes[l][(start + t) * stride] = work[t * HYSCAN_FILTER_BANK_LANES + l];
+    }
+}
+
+/* Функция обрабатывает не более HYSCAN_FILTER_BANK_CHUNK_SIZE отсчётов
+ * всех каналов. */
+static gboolean
+hyscan_filter_bank_process_chunk (HyScanFilterBankPrivate *priv,
+                                  gpointer const          *data,
+                                  gboolean                 complex,
+                                  guint32                  n_points)
+{
+  gfloat *lanes[HYSCAN_FILTER_BANK_LANES];
+  guint n_streams = complex ? 2 * priv->n_channels : priv->n_channels;
+  guint stride = complex ? 2 : 1;
+  guint n_groups = (n_streams + HYSCAN_FILTER_BANK_LANES - 1) / HYSCAN_FILTER_BANK_LANES;
+  guint g;
+
+  if (priv->n_taps > 0)
+    {
+      guint64 direct_cost = (guint64) priv->n_taps * n_points;
+      guint64 fft_cost = (guint64) HYSCAN_FILTER_BANK_FFT_TAPS * (n_points + priv->n_taps - 1);
+
+      if ((priv->convolution != NULL) && (direct_cost > fft_cost))
+        {
+          if (!hyscan_filter_bank_fir_fft (priv, data, complex, n_points))
+            return FALSE;
+        }
+      else
+        {
+          gfloat *history[HYSCAN_FILTER_BANK_LANES];
+
+          for (g = 0; g < n_groups; g++)
+            {
+              guint n_lanes = hyscan_filter_bank_get_lanes (data, complex, g, n_streams, lanes);
+
+              hyscan_filter_bank_get_history (priv, g, n_lanes, history);
+              hyscan_filter_bank_fir_direct (priv, lanes, n_lanes, stride, history, n_points);
+            }
+        }
+    }
+
+  if (priv->n_sections > 0)
+    {
+      for (g = 0; g < n_groups; g++)
+        {
+          guint n_lanes = hyscan_filter_bank_get_lanes (data, complex, g, n_streams, lanes);
+          gdouble *state = priv->iir_state + g * 2 * priv->n_sections * HYSCAN_FILTER_BANK_LANES;
+
+          hyscan_filter_bank_iir (priv, lanes, n_lanes, stride, state, n_points);
+        }
+    }
+
+  return TRUE;
+}
+
+/* Функция обрабатывает данные всех каналов шагами фиксированного размера,
+ * что ограничивает размер рабочих буферов. */
+static gboolean
+hyscan_filter_bank_process (HyScanFilterBankPrivate *priv,
+                            gpointer const          *data,
+                            gboolean                 complex,
+                            guint32                  n_points)
+{
+  guint stride = complex ? 2 : 1;
+  guint32 offset;
+  guint c;
+
+  for (offset = 0; offset < n_points; offset += HYSCAN_FILTER_BANK_CHUNK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_FILTER_BANK_CHUNK_SIZE, n_points - offset);
+
+      for (c = 0; c < priv->n_channels; c++)
+        priv->chunk[c] = (gfloat *) data[c] + offset * stride;
+
+      if (!hyscan_filter_bank_process_chunk (priv, priv->chunk, complex, n))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_filter_bank_new:
+ * @n_channels: число каналов
+ *
+ * Функция создаёт новый объект #HyScanFilterBank.
+ *
+ * Returns: #HyScanFilterBank. Для удаления #g_object_unref.
+ */
+HyScanFilterBank *
+hyscan_filter_bank_new (guint n_channels)
+{
+  return g_object_new (HYSCAN_TYPE_FILTER_BANK,
+                       "n-channels", n_channels,
+                       NULL);
+}
+
+/**
+ * hyscan_filter_bank_get_n_channels:
+ * @bank: указатель на #HyScanFilterBank
+ *
+ * Функция возвращает число каналов.
+ *
+ * Returns: Число каналов.
+ */
+guint
+hyscan_filter_bank_get_n_channels (HyScanFilterBank *bank)
+{
+  g_return_val_if_fail (HYSCAN_IS_FILTER_BANK (bank), 0);
+
+  return bank->priv->n_channels;
+}
+
+/**
+ * hyscan_filter_bank_set_fir:
+ * @bank: указатель на #HyScanFilterBank
+ * @taps: (nullable) (array length=n_taps) (transfer none): коэффициенты фильтра
+ * @n_taps: число коэффициентов
+ *
+ * Функция задаёт коэффициенты КИХ фильтра и сбрасывает его состояние.
+ * Если коэффициенты равны NULL, КИХ фильтр отключается.
+ *
+ * Returns: %TRUE если фильтр установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_filter_bank_set_fir (HyScanFilterBank *bank,
+                            const gfloat     *taps,
+                            guint             n_taps)
+{
+  HyScanFilterBankPrivate *priv;
+  guint n_history;
+
+  g_return_val_if_fail (HYSCAN_IS_FILTER_BANK (bank), FALSE);
+
+  priv = bank->priv;
+
+  g_clear_pointer (&priv->taps, g_free);
+  g_clear_pointer (&priv->fir_work, g_free);
+  g_clear_pointer (&priv->rows, pffft_aligned_free);
+  g_clear_pointer (&priv->result, pffft_aligned_free);
+  g_clear_object (&priv->convolution);
+  priv->n_taps = 0;
+
+  if ((taps == NULL) || (n_taps == 0))
+    return TRUE;
+
+  priv->n_taps = n_taps;
+  priv->taps = g_new (gfloat, n_taps);
+  memcpy (priv->taps, taps, n_taps * sizeof (gfloat));
+
+  /* История хранится в начале строк пар потоков. Для свёртки в частотной
+   * области в строках также размещаются данные одного шага обработки. */
+  n_history = n_taps - 1;
+  priv->row_size = n_history;
+  priv->rows_size = priv->n_channels * n_history;
+  if (n_taps > HYSCAN_FILTER_BANK_FFT_TAPS)
+    priv->rows_size += priv->n_channels * HYSCAN_FILTER_BANK_CHUNK_SIZE;
+
+  priv->rows = pffft_aligned_malloc (priv->rows_size * sizeof (HyScanComplexFloat));
+  memset (priv->rows, 0, priv->rows_size * sizeof (HyScanComplexFloat));
+  priv->fir_work = g_new (gfloat, (n_history + HYSCAN_FILTER_BANK_BLOCK_SIZE) * HYSCAN_FILTER_BANK_LANES);
+
+  if (n_taps > HYSCAN_FILTER_BANK_FFT_TAPS)
+    {
+      HyScanComplexFloat *image = g_new0 (HyScanComplexFloat, n_taps);
+      guint i;
+
+      for (i = 0; i < n_taps; i++)
+        image[i].re = taps[n_taps - 1 - i];
+
+      priv->result = pffft_aligned_malloc (priv->rows_size * sizeof (HyScanComplexFloat));
+      priv->convolution = hyscan_convolution_new ();
+      if (!hyscan_convolution_set_image_td (priv->convolution, 0, image, n_taps))
+        {
+          g_free (image);
+          hyscan_filter_bank_set_fir (bank, NULL, 0);
+          return FALSE;
+        }
+
+      g_free (image);
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_filter_bank_set_iir:
+ * @bank: указатель на #HyScanFilterBank
+ * @sections: (nullable) (array length=n_sections) (transfer none): звенья фильтра
+ * @n_sections: число звеньев
+ *
+ * Функция задаёт звенья второго порядка БИХ фильтра и сбрасывает его
+ * состояние. Звенья применяются последовательно в порядке их следования
+ * в массиве. Если звенья равны NULL, БИХ фильтр отключается.
+ *
+ * Returns: %TRUE если фильтр установлен, иначе %FALSE.
+ */
+gboolean
+hyscan_filter_bank_set_iir (HyScanFilterBank   *bank,
+                            const HyScanBiquad *sections,
+                            guint               n_sections)
+{
+  HyScanFilterBankPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_FILTER_BANK (bank), FALSE);
+
+  priv = bank->priv;
+
+  g_clear_pointer (&priv->sections, g_free);
+  g_clear_pointer (&priv->iir_state, g_free);
+  priv->n_sections = 0;
+
+  if ((sections == NULL) || (n_sections == 0))
+    return TRUE;
+
+  priv->n_sections = n_sections;
+  priv->sections = g_new (HyScanBiquad, n_sections);
+  memcpy (priv->sections, sections, n_sections * sizeof (HyScanBiquad));
+  priv->iir_state = g_new0 (gdouble, priv->n_groups * 2 * n_sections * HYSCAN_FILTER_BANK_LANES);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_filter_bank_process_complex:
+ * @bank: указатель на #HyScanFilterBank
+ * @data: (array) (transfer none): массив указателей на данные каналов
+ * @n_points: число отсчётов в каждом канале
+ *
+ * Функция фильтрует очередную часть комплексных данных всех каналов.
+ * Результат записывается во входные массивы.
+ *
+ * Returns: %TRUE если данные обработаны, иначе %FALSE.
+ */
+gboolean
+hyscan_filter_bank_process_complex (HyScanFilterBank          *bank,
+                                    HyScanComplexFloat *const *data,
+                                    guint32                    n_points)
+{
+  g_return_val_if_fail (HYSCAN_IS_FILTER_BANK (bank), FALSE);
+
+  return hyscan_filter_bank_process (bank->priv, (gpointer const *) data, TRUE, n_points);
+}
+
+/**
+ * hyscan_filter_bank_process_real:
+ * @bank: указатель на #HyScanFilterBank
+ * @data: (array) (transfer none): массив указателей на данные каналов
+ * @n_points: число отсчётов в каждом канале
+ *
+ * Функция фильтрует очередную часть действительных данных всех каналов.
+ * Результат записывается во входные массивы.
+ *
+ * Returns: %TRUE если данные обработаны, иначе %FALSE.
+ */
+gboolean
+hyscan_filter_bank_process_real (HyScanFilterBank *bank,
+                                 gfloat *const    *data,
+                                 guint32           n_points)
+{
+  g_return_val_if_fail (HYSCAN_IS_FILTER_BANK (bank), FALSE);
+
+  return hyscan_filter_bank_process (bank->priv, (gpointer const *) data, FALSE, n_points);
+}
+
+/**
+ * hyscan_filter_bank_reset:
+ * @bank: указатель на #HyScanFilterBank
+ *
+ * Функция сбрасывает состояние фильтров всех каналов.
+ */
+void
+hyscan_filter_bank_reset (HyScanFilterBank *bank)
+{
+  HyScanFilterBankPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FILTER_BANK (bank));
+
+  priv = bank->priv;
+
+  if (priv->n_taps > 0)
+    memset (priv->rows, 0, priv->rows_size * sizeof (HyScanComplexFloat));
+
+  if (priv->n_sections > 0)
+    {
+      memset (priv->iir_state, 0,
+              priv->n_groups * 2 * priv->n_sections * HYSCAN_FILTER_BANK_LANES * sizeof (gdouble));
+    }
+}
@@ -0,0 +1,120 @@
+/* hyscan-filter-bank.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_FILTER_BANK_H__
+#define __HYSCAN_FILTER_BANK_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_FILTER_BANK             (hyscan_filter_bank_get_type ())
+#define HYSCAN_FILTER_BANK(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_FILTER_BANK, HyScanFilterBank))
+#define HYSCAN_IS_FILTER_BANK(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_FILTER_BANK))
+#define HYSCAN_FILTER_BANK_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_FILTER_BANK, HyScanFilterBankClass))
+#define HYSCAN_IS_FILTER_BANK_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_FILTER_BANK))
+#define HYSCAN_FILTER_BANK_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_FILTER_BANK, HyScanFilterBankClass))
+
+typedef struct _HyScanFilterBank HyScanFilterBank;
+typedef struct _HyScanFilterBankPrivate HyScanFilterBankPrivate;
+typedef struct _HyScanFilterBankClass HyScanFilterBankClass;
+
+/**
+ * HyScanBiquad:
+ * @b0: коэффициент числителя при z^0
+ * @b1: коэффициент числителя при z^-1
+ * @b2: коэффициент числителя при z^-2
+ * @a1: коэффициент знаменателя при z^-1
+ * @a2: коэффициент знаменателя при z^-2
+ *
+ * Коэффициенты звена второго порядка БИХ фильтра с передаточной функцией
+ * (b0 + b1 * z^-1 + b2 * z^-2) / (1 + a1 * z^-1 + a2 * z^-2).
+ */
+typedef struct
+{
+  gdouble                      b0;
+  gdouble                      b1;
+  gdouble                      b2;
+  gdouble                      a1;
+  gdouble                      a2;
+} HyScanBiquad;
+
+struct _HyScanFilterBank
+{
+  GObject parent_instance;
+
+  HyScanFilterBankPrivate *priv;
+};
+
+struct _HyScanFilterBankClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_filter_bank_get_type             (void);
+
+HYSCAN_API
+HyScanFilterBank *     hyscan_filter_bank_new                  (guint                     n_channels);
+
+HYSCAN_API
+guint                  hyscan_filter_bank_get_n_channels       (HyScanFilterBank         *bank);
+
+HYSCAN_API
+gboolean               hyscan_filter_bank_set_fir              (HyScanFilterBank         *bank,
+                                                                const gfloat             *taps,
+                                                                guint                     n_taps);
+
+HYSCAN_API
+gboolean               hyscan_filter_bank_set_iir              (HyScanFilterBank         *bank,
+                                                                const HyScanBiquad       *sections,
+                                                                guint                     n_sections);
+
+HYSCAN_API
+gboolean               hyscan_filter_bank_process_complex      (HyScanFilterBank         *bank,
+                                                                HyScanComplexFloat *const *data,
+                                                                guint32                   n_points);
+
+HYSCAN_API
+gboolean               hyscan_filter_bank_process_real         (HyScanFilterBank         *bank,
+                                                                gfloat *const            *data,
+                                                                guint32                   n_points);
+
+HYSCAN_API
+void                   hyscan_filter_bank_reset                (HyScanFilterBank         *bank);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_FILTER_BANK_H__ */
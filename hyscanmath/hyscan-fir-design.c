@@ -0,0 +1,101 @@
+/* hyscan-fir-design.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include "hyscan-fir-design.h"
+#include <math.h>
+
+/* Функция рассчитывает модифицированную функцию Бесселя нулевого порядка. */
+static gdouble
+hyscan_fir_design_bessel_i0 (gdouble x)
+{
+  gdouble sum = 1.0;
+  gdouble term = 1.0;
+  guint k;
+
+  for (k = 1; term > 1e-12 * sum; k++)
+    {
+      gdouble a = x / (2.0 * k);
+
+      term *= a * a;
+      sum += term;
+    }
+
+  return sum;
+}
+
+/* Функция рассчитывает длину фильтра с окном Кайзера по ширине переходной
+ * полосы и подавлению в полосе заграждения в дБ. */
+guint
+hyscan_fir_design_length (gdouble transition,
+                          gdouble attenuation)
+{
+  return (guint) ceil ((attenuation - 8.0) / (2.285 * 2.0 * G_PI * transition)) + 1;
+}
+
+/* Функция рассчитывает коэффициенты фильтра нижних частот с окном Кайзера
+ * и единичным коэффициентом передачи на нулевой частоте. Для освобождения
+ * памяти используется g_free. */
+gdouble *
+hyscan_fir_design_lowpass (guint   length,
+                           gdouble cutoff,
+                           gdouble attenuation)
+{
+  gdouble beta = (attenuation > 50.0) ? 0.1102 * (attenuation - 8.7) :
+                 0.5842 * pow (attenuation - 21.0, 0.4) + 0.07886 * (attenuation - 21.0);
+  gdouble center = (length - 1) / 2.0;
+  gdouble norm = hyscan_fir_design_bessel_i0 (beta);
+  gdouble *h = g_new (gdouble, length);
+  gdouble sum = 0.0;
+  guint i;
+
+  for (i = 0; i < length; i++)
+    {
+      gdouble t = i - center;
+      gdouble r = (center > 0.0) ? t / center : 0.0;
+
+      if (t == 0.0)
+        h[i] = 2.0 * cutoff;
+      else
+        h[i] = sin (2.0 * G_PI * cutoff * t) / (G_PI * t);
+
+      h[i] *= hyscan_fir_design_bessel_i0 (beta * sqrt (MAX (0.0, 1.0 - r * r))) / norm;
+      sum += h[i];
+    }
+
+  for (i = 0; i < length; i++)
+    h[i] /= sum;
+
+  return h;
+}
@@ -0,0 +1,558 @@
+/* hyscan-resampler.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+/**
+ * SECTION: hyscan-resampler
+ * @Short_description: класс изменения частоты дискретизации
+ * @Title: HyScanResampler
+ *
+ * Класс предназначен для изменения частоты дискретизации действительных и
+ * комплексных данных в рациональное число раз: частота дискретизации
+ * результата равна частоте дискретизации входных данных, умноженной на
+ * interpolation / decimation.
+ *
+ * Создание объекта производится с помощью функции #hyscan_resampler_new.
+ * Коэффициенты изменения частоты задаются функцией
+ * #hyscan_resampler_set_ratio. Например, для преобразования данных с
+ * частотой дискретизации 48 кГц в данные с частотой 44.1 кГц
+ * используются коэффициенты 147 и 160.
+ *
+ * Изменение частоты производится полифазным КИХ фильтром: для каждого
+ * выходного отсчёта рассчитывается свёртка только с той частью
+ * коэффициентов фильтра, которая соответствует ненулевым отсчётам
+ * интерполированного сигнала. Полоса пропускания фильтра составляет
+ * +/- 0.4 меньшей из частот дискретизации, подавление в полосе
+ * заграждения - не менее 90 дБ. Рассчитанные фильтры хранятся в общем
+ * кэше и используются всеми объектами с одинаковыми коэффициентами.
+ *
+ * Обработка данных производится функциями #hyscan_resampler_process_complex
+ * и #hyscan_resampler_process_real. Состояние фильтра сохраняется между
+ * вызовами, поэтому данные можно передавать частями произвольного размера.
+ * Один объект обрабатывает один поток данных, поэтому при переходе от
+ * комплексных данных к действительным необходимо сбросить состояние функцией
+ * #hyscan_resampler_reset. Число выходных отсчётов для следующего вызова
+ * можно узнать функцией #hyscan_resampler_get_output_size, а задержку,
+ * вносимую фильтром, - функцией #hyscan_resampler_get_delay.
+ */
+
+#include "hyscan-resampler.h"
+#include "hyscan-fir-design.h"
+#include <string.h>
+
+/* Максимальное число входных отсчётов, обрабатываемых за один проход. */
+#define HYSCAN_RESAMPLER_CHUNK_SIZE    4096
+
+/* Число независимых сумм при расчёте свёртки. */
+#define HYSCAN_RESAMPLER_LANES         8
+
+/* Полоса пропускания относительно меньшей частоты дискретизации. */
+#define HYSCAN_RESAMPLER_PASSBAND      0.4
+
+/* Подавление в полосе заграждения, дБ. */
+#define HYSCAN_RESAMPLER_ATTENUATION   90.0
+
+/* Максимальное значение коэффициентов изменения частоты. */
+#define HYSCAN_RESAMPLER_MAX_FACTOR    1024
+
+/* Полифазный фильтр. */
+typedef struct
+{
+  guint64                      key;            /* Ключ кэша фильтров. */
+  guint                        interpolation;  /* Коэффициент интерполяции. */
+  guint                        decimation;     /* Коэффициент децимации. */
+  guint                        length;         /* Длина исходного фильтра. */
+  guint                        n_taps;         /* Число коэффициентов в одной фазе. */
+  gfloat                      *taps;           /* Коэффициенты фаз фильтра. */
+} HyScanResamplerFilter;
+
+struct _HyScanResamplerPrivate
+{
+  const HyScanResamplerFilter *filter;         /* Полифазный фильтр. */
+
+  gfloat                      *re;             /* Действительные части входных отсчётов. */
+  gfloat                      *im;             /* Мнимые части входных отсчётов. */
+  guint32                      n_points;       /* Число входных отсчётов в буфере. */
+  guint64                      position;       /* Позиция следующего выходного отсчёта. */
+};
+
+static void    hyscan_resampler_object_finalize        (GObject                     *object);
+
+static const HyScanResamplerFilter *
+               hyscan_resampler_filter_get             (guint                        interpolation,
+                                                        guint                        decimation);
+
+static guint32 hyscan_resampler_process                (HyScanResamplerPrivate      *priv,
+                                                        gboolean                     complex,
+                                                        gfloat                      *re,
+                                                        gfloat                      *im,
+                                                        guint                        stride);
+
+static GMutex      hyscan_resampler_filters_lock;
+static GHashTable *hyscan_resampler_filters = NULL;
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanResampler, hyscan_resampler, G_TYPE_OBJECT)
+
+static void
+hyscan_resampler_class_init (HyScanResamplerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_resampler_object_finalize;
+}
+
+static void
+hyscan_resampler_init (HyScanResampler *resampler)
+{
+  resampler->priv = hyscan_resampler_get_instance_private (resampler);
+}
+
+static void
+hyscan_resampler_object_finalize (GObject *object)
+{
+  HyScanResampler *resampler = HYSCAN_RESAMPLER (object);
+  HyScanResamplerPrivate *priv = resampler->priv;
+
+  g_free (priv->re);
+  g_free (priv->im);
+
+  G_OBJECT_CLASS (hyscan_resampler_parent_class)->finalize (object);
+}
+
+/* Функция возвращает полифазный фильтр из кэша, рассчитывая его при первом
+ * запросе. Фильтры хранятся до завершения работы программы.
+ *
+ * Коэффициенты фазы p исходного фильтра h - h[p], h[p + L], h[p + 2L] и т.д.
+ * Они хранятся в обратном порядке и дополняются нулями в начале до размера,
+ * кратного HYSCAN_RESAMPLER_LANES, поэтому свёртка рассчитывается как
+ * скалярное произведение с непрерывным участком входных отсчётов. */
+static const HyScanResamplerFilter *
+hyscan_resampler_filter_get (guint interpolation,
+                             guint decimation)
+{
+  HyScanResamplerFilter *filter;
+  guint64 key = ((guint64) interpolation << 32) | decimation;
+  guint factor = MAX (interpolation, decimation);
+  guint n_phase;
+  gdouble *h;
+  guint p, k;
+
+  g_mutex_lock (&hyscan_resampler_filters_lock);
+
+  if (hyscan_resampler_filters == NULL)
+    hyscan_resampler_filters = g_hash_table_new (g_int64_hash, g_int64_equal);
+
+  filter = g_hash_table_lookup (hyscan_resampler_filters, &key);
+  if (filter != NULL)
+    {
+      g_mutex_unlock (&hyscan_resampler_filters_lock);
+      return filter;
+    }
+
+  /* Фильтр работает на частоте дискретизации, увеличенной в interpolation
+   * раз. Полоса заграждения начинается там, где наложение спектров
+   * затрагивает полосу пропускания. */
+  filter = g_new0 (HyScanResamplerFilter, 1);
+  filter->key = key;
+  filter->interpolation = interpolation;
+  filter->decimation = decimation;
+  filter->length = hyscan_fir_design_length ((1.0 - 2.0 * HYSCAN_RESAMPLER_PASSBAND) / factor,
+                                             HYSCAN_RESAMPLER_ATTENUATION);
+  h = hyscan_fir_design_lowpass (filter->length, 0.5 / factor, HYSCAN_RESAMPLER_ATTENUATION);
+
+  n_phase = (filter->length + interpolation - 1) / interpolation;
+  filter->n_taps = n_phase;
+  filter->n_taps += (HYSCAN_RESAMPLER_LANES - n_phase % HYSCAN_RESAMPLER_LANES) % HYSCAN_RESAMPLER_LANES;
+  filter->taps = g_new0 (gfloat, interpolation * filter->n_taps);
+
+  for (p = 0; p < interpolation; p++)
+    {
+      gfloat *taps = filter->taps + p * filter->n_taps;
+
+      for (k = 0; k < n_phase; k++)
+        {
+          if (p + k * interpolation < filter->length)
+            taps[filter->n_taps - 1 - k] = interpolation * h[p + k * interpolation];
+        }
+    }
+
+  g_free (h);
+
+  g_hash_table_insert (hyscan_resampler_filters, &filter->key, filter);
+
+  g_mutex_unlock (&hyscan_resampler_filters_lock);
+
+  return filter;
+}
+
+/* Функция рассчитывает выходные отсчёты по накопленным входным отсчётам и
+ * удаляет из буфера отсчёты, которые больше не понадобятся. Выходной
+ * отсчёт j соответствует отсчёту j * M интерполированного сигнала, для
+ * которого используется фаза фильтра (j * M) mod L и входные отсчёты до
+ * (j * M) / L включительно. Свёртка рассчитывается HYSCAN_RESAMPLER_LANES
+ * независимыми суммами, внутренний цикл по которым векторизуется. */
+static guint32
+hyscan_resampler_process (HyScanResamplerPrivate *priv,
+                          gboolean                complex,
+                          gfloat                 *re,
+                          gfloat                 *im,
+                          guint                   stride)
+{
+  const HyScanResamplerFilter *filter = priv->filter;
+  guint interpolation = filter->interpolation;
+  guint n_taps = filter->n_taps;
+  guint32 n_out = 0;
+  guint32 start;
+
+  for (start = priv->position / interpolation;
+       start + n_taps <= priv->n_points;
+       start = priv->position / interpolation)
+    {
+      const gfloat *taps = filter->taps + (priv->position % interpolation) * n_taps;
+      const gfloat *x_re = priv->re + start;
+      const gfloat *x_im = priv->im + start;
+      gfloat acc_re[HYSCAN_RESAMPLER_LANES] = {0.0f};
+      gfloat acc_im[HYSCAN_RESAMPLER_LANES] = {0.0f};
+      gfloat sum_re = 0.0f;
+      gfloat sum_im = 0.0f;
+      guint i, l;
+
+      if (complex)
+        {
+          for (i = 0; i < n_taps; i += HYSCAN_RESAMPLER_LANES)
+            {
+              for (l = 0; l < HYSCAN_RESAMPLER_LANES; l++)
+                {
+                  acc_re[l] += taps[i + l] * x_re[i + l];
+                  acc_im[l] += taps[i + l] * x_im[i + l];
+                }
+            }
+        }
+      else
+        {
+          for (i = 0; i < n_taps; i += HYSCAN_RESAMPLER_LANES)
+            {
+              for (l = 0; l < HYSCAN_RESAMPLER_LANES; l++)
+                acc_re[l] += taps[i + l] * x_re[i + l];
+            }
+        }
+
+      for (l = 0; l < HYSCAN_RESAMPLER_LANES; l++)
+        {
+          sum_re += acc_re[l];
+          sum_im += acc_im[l];
+        }
+
+      re[n_out * stride] = sum_re;
+      if (complex)
+        im[n_out * stride] = sum_im;
+
+      priv->position += filter->decimation;
+      n_out++;
+    }
+
+  /* Удаляем использованные отсчёты. */
+  memmove (priv->re, priv->re + start, (priv->n_points - start) * sizeof (gfloat));
+  if (complex)
+    memmove (priv->im, priv->im + start, (priv->n_points - start) * sizeof (gfloat));
+
+  priv->position -= (guint64) start * interpolation;
+  priv->n_points -= start;
+
+  return n_out;
+}
+
+/**
+ * hyscan_resampler_new:
+ *
+ * Функция создаёт новый объект #HyScanResampler.
+ *
+ * Returns: #HyScanResampler. Для удаления #g_object_unref.
+ */
+HyScanResampler *
+hyscan_resampler_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_RESAMPLER, NULL);
+}
+
+/**
+ * hyscan_resampler_set_ratio:
+ * @resampler: указатель на #HyScanResampler
+ * @interpolation: коэффициент интерполяции
+ * @decimation: коэффициент децимации
+ *
+ * Функция задаёт коэффициенты изменения частоты дискретизации и сбрасывает
+ * состояние объекта. Коэффициенты сокращаются на общий делитель и после
+ * этого не должны превышать 1024.
+ *
+ * Returns: %TRUE если коэффициенты установлены, иначе %FALSE.
+ */
+gboolean
+hyscan_resampler_set_ratio (HyScanResampler *resampler,
+                            guint            interpolation,
+                            guint            decimation)
+{
+  HyScanResamplerPrivate *priv;
+  guint a, b;
+
+  g_return_val_if_fail (HYSCAN_IS_RESAMPLER (resampler), FALSE);
+
+  priv = resampler->priv;
+
+  if ((interpolation == 0) || (decimation == 0))
+    {
+      g_warning ("HyScanResampler: incorrect ratio");
+      return FALSE;
+    }
+
+  /* Сокращаем коэффициенты. */
+  for (a = interpolation, b = decimation; b != 0;)
+    {
+      guint r = a % b;
+
+      a = b;
+      b = r;
+    }
+
+  interpolation /= a;
+  decimation /= a;
+
+  if ((interpolation > HYSCAN_RESAMPLER_MAX_FACTOR) || (decimation > HYSCAN_RESAMPLER_MAX_FACTOR))
+    {
+      g_warning ("HyScanResampler: ratio %u/%u is too big", interpolation, decimation);
+      return FALSE;
+    }
+
+  priv->filter = hyscan_resampler_filter_get (interpolation, decimation);
+
+  g_free (priv->re);
+  g_free (priv->im);
+  priv->re = g_new (gfloat, priv->filter->n_taps + HYSCAN_RESAMPLER_CHUNK_SIZE);
+  priv->im = g_new (gfloat, priv->filter->n_taps + HYSCAN_RESAMPLER_CHUNK_SIZE);
+
+  hyscan_resampler_reset (resampler);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_resampler_get_delay:
+ * @resampler: указатель на #HyScanResampler
+ *
+ * Функция возвращает задержку, вносимую фильтром. Выходной отсчёт с
+ * номером m соответствует моменту времени (m - delay) / data_rate от
+ * начала входных данных, где data_rate - частота дискретизации результата.
+ *
+ * Returns: Задержка в отсчётах результата.
+ */
+gdouble
+hyscan_resampler_get_delay (HyScanResampler *resampler)
+{
+  const HyScanResamplerFilter *filter;
+
+  g_return_val_if_fail (HYSCAN_IS_RESAMPLER (resampler), 0.0);
+
+  filter = resampler->priv->filter;
+  if (filter == NULL)
+    return 0.0;
+
+  return (filter->length - 1) / (2.0 * filter->decimation);
+}
+
+/**
+ * hyscan_resampler_get_output_size:
+ * @resampler: указатель на #HyScanResampler
+ * @n_points: число входных отсчётов
+ *
+ * Функция возвращает число выходных отсчётов, которое будет рассчитано
+ * при следующем вызове функции обработки для n_points входных отсчётов.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_resampler_get_output_size (HyScanResampler *resampler,
+                                  guint32          n_points)
+{
+  HyScanResamplerPrivate *priv;
+  const HyScanResamplerFilter *filter;
+  guint64 total;
+  guint64 limit;
+
+  g_return_val_if_fail (HYSCAN_IS_RESAMPLER (resampler), 0);
+
+  priv = resampler->priv;
+  filter = priv->filter;
+
+  if (filter == NULL)
+    return 0;
+
+  /* Выходные отсчёты рассчитываются, пока фильтр не выходит за последний
+   * входной отсчёт. */
+  total = (guint64) priv->n_points + n_points;
+  if (total < filter->n_taps)
+    return 0;
+
+  limit = (total - filter->n_taps + 1) * filter->interpolation;
+  if (limit <= priv->position)
+    return 0;
+
+  return (limit - priv->position + filter->decimation - 1) / filter->decimation;
+}
+
+/**
+ * hyscan_resampler_process_complex:
+ * @resampler: указатель на #HyScanResampler
+ * @input: (array length=n_points) входные отсчёты
+ * @n_points: число входных отсчётов
+ * @output: (out) (array) буфер для результата
+ *
+ * Функция изменяет частоту дискретизации очередной части комплексных
+ * данных. Размер буфера для результата должен быть не меньше значения,
+ * возвращаемого функцией #hyscan_resampler_get_output_size.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_resampler_process_complex (HyScanResampler          *resampler,
+                                  const HyScanComplexFloat *input,
+                                  guint32                   n_points,
+                                  HyScanComplexFloat       *output)
+{
+  HyScanResamplerPrivate *priv;
+  guint32 n_out = 0;
+  guint32 offset;
+
+  g_return_val_if_fail (HYSCAN_IS_RESAMPLER (resampler), 0);
+
+  priv = resampler->priv;
+
+  if (priv->filter == NULL)
+    {
+      g_warning ("HyScanResampler: ratio not set");
+      return 0;
+    }
+
+  for (offset = 0; offset < n_points; offset += HYSCAN_RESAMPLER_CHUNK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_RESAMPLER_CHUNK_SIZE, n_points - offset);
+      guint32 i;
+
+      for (i = 0; i < n; i++)
+        {
+          priv->re[priv->n_points + i] = input[offset + i].re;
+          priv->im[priv->n_points + i] = input[offset + i].im;
+        }
+      priv->n_points += n;
+
+      n_out += hyscan_resampler_process (priv, TRUE, &output[n_out].re, &output[n_out].im, 2);
+    }
+
+  return n_out;
+}
+
+/**
+ * hyscan_resampler_process_real:
+ * @resampler: указатель на #HyScanResampler
+ * @input: (array length=n_points) входные отсчёты
+ * @n_points: число входных отсчётов
+ * @output: (out) (array) буфер для результата
+ *
+ * Функция изменяет частоту дискретизации очередной части действительных
+ * данных. Размер буфера для результата должен быть не меньше значения,
+ * возвращаемого функцией #hyscan_resampler_get_output_size.
+ *
+ * Returns: Число выходных отсчётов.
+ */
+guint32
+hyscan_resampler_process_real (HyScanResampler *resampler,
+                               const gfloat    *input,
+                               guint32          n_points,
+                               gfloat          *output)
+{
+  HyScanResamplerPrivate *priv;
+  guint32 n_out = 0;
+  guint32 offset;
+
+  g_return_val_if_fail (HYSCAN_IS_RESAMPLER (resampler), 0);
+
+  priv = resampler->priv;
+
+  if (priv->filter == NULL)
+    {
+      g_warning ("HyScanResampler: ratio not set");
+      return 0;
+    }
+
+  for (offset = 0; offset < n_points; offset += HYSCAN_RESAMPLER_CHUNK_SIZE)
+    {
+      guint32 n = MIN (HYSCAN_RESAMPLER_CHUNK_SIZE, n_points - offset);
+
+      memcpy (priv->re + priv->n_points, input + offset, n * sizeof (gfloat));
+      priv->n_points += n;
+
+      n_out += hyscan_resampler_process (priv, FALSE, output + n_out, NULL, 1);
+    }
+
+  return n_out;
+}
+
+/**
+ * hyscan_resampler_reset:
+ * @resampler: указатель на #HyScanResampler
+ *
+ * Функция сбрасывает состояние фильтра. Следующий вызов функции обработки
+ * обрабатывает данные как новый поток.
+ */
+void
+hyscan_resampler_reset (HyScanResampler *resampler)
+{
+  HyScanResamplerPrivate *priv;
+  guint32 size;
+
+  g_return_if_fail (HYSCAN_IS_RESAMPLER (resampler));
+
+  priv = resampler->priv;
+
+  if (priv->filter == NULL)
+    return;
+
+  /* История фильтра заполняется нулями, поэтому первый выходной отсчёт
+   * соответствует первому входному отсчёту. */
+  size = priv->filter->n_taps + HYSCAN_RESAMPLER_CHUNK_SIZE;
+  memset (priv->re, 0, size * sizeof (gfloat));
+  memset (priv->im, 0, size * sizeof (gfloat));
+
+  priv->n_points = priv->filter->n_taps - 1;
+  priv->position = 0;
+}
@@ -0,0 +1,101 @@
+/* hyscan-resampler.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#ifndef __HYSCAN_RESAMPLER_H__
+#define __HYSCAN_RESAMPLER_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_RESAMPLER             (hyscan_resampler_get_type ())
+#define HYSCAN_RESAMPLER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_RESAMPLER, HyScanResampler))
+#define HYSCAN_IS_RESAMPLER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_RESAMPLER))
+#define HYSCAN_RESAMPLER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_RESAMPLER, HyScanResamplerClass))
+#define HYSCAN_IS_RESAMPLER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_RESAMPLER))
+#define HYSCAN_RESAMPLER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_RESAMPLER, HyScanResamplerClass))
+
+typedef struct _HyScanResampler HyScanResampler;
+typedef struct _HyScanResamplerPrivate HyScanResamplerPrivate;
+typedef struct _HyScanResamplerClass HyScanResamplerClass;
+
+struct _HyScanResampler
+{
+  GObject parent_instance;
+
+  HyScanResamplerPrivate *priv;
+};
+
+struct _HyScanResamplerClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_resampler_get_type               (void);
+
+HYSCAN_API
+HyScanResampler *      hyscan_resampler_new                    (void);
+
+HYSCAN_API
+gboolean               hyscan_resampler_set_ratio              (HyScanResampler          *resampler,
+                                                                guint                     interpolation,
+                                                                guint                     decimation);
+
+HYSCAN_API
+gdouble                hyscan_resampler_get_delay              (HyScanResampler          *resampler);
+
+HYSCAN_API
+guint32                hyscan_resampler_get_output_size        (HyScanResampler          *resampler,
+                                                                guint32                   n_points);
+
+HYSCAN_API
+guint32                hyscan_resampler_process_complex        (HyScanResampler          *resampler,
+                                                                const HyScanComplexFloat *input,
+                                                                guint32                   n_points,
+                                                                HyScanComplexFloat       *output);
+
+HYSCAN_API
+guint32                hyscan_resampler_process_real           (HyScanResampler          *resampler,
+                                                                const gfloat             *input,
+                                                                guint32                   n_points,
+                                                                gfloat                   *output);
+
+HYSCAN_API
+void                   hyscan_resampler_reset                  (HyScanResampler          *resampler);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_RESAMPLER_H__ */
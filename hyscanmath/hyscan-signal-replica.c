@@ -0,0 +1,658 @@
+/* hyscan-signal-replica.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+
+/**
+ * SECTION: hyscan-signal-replica
+ * @Short_description: общий кэш образов сигналов
+ * @Title: HyScanSignalReplica
+ *
+ * Если один и тот же образ сигнала используется несколькими каналами, его
+ * можно получить из общего кэша функциями #hyscan_signal_replica_tone,
+ * #hyscan_signal_replica_lfm и #hyscan_signal_replica_doppler. Они
+ * возвращают объект HyScanSignalReplica, содержащий неизменяемый образ,
+ * выровненный для векторных вычислений. Образ совпадает с результатом
+ * соответствующей функции hyscan_signal_image_* (см. #HyScanSignal). Пока
+ * объект существует, для одинаковых параметров сигнала возвращается он же,
+ * поэтому повторный запрос образа не требует ни расчёта, ни выделения памяти.
+ *
+ * Кэш хранит образы и после удаления объектов пользователями. Если суммарный
+ * объём образов превышает лимит, неиспользуемые образы удаляются в порядке
+ * давности последнего запроса. Лимит задаётся функцией
+ * #hyscan_signal_cache_set_size. Образы, для которых существует хотя бы один
+ * объект HyScanSignalReplica, из кэша не удаляются.
+ *
+ * Для свёртки в частотной области (см. #hyscan_convolution_set_image_fd)
+ * образы можно сразу получить в виде комплексно сопряжённого спектра
+ * заданного размера функциями #hyscan_signal_spectrum_tone,
+ * #hyscan_signal_spectrum_lfm и #hyscan_signal_spectrum_doppler. Спектр
+ * тонального сигнала рассчитывается аналитически, спектр ЛЧМ сигнала -
+ * одним преобразованием Фурье при первом запросе. Спектры хранятся в том
+ * же кэше, поэтому смена образа при свёртке не требует преобразований Фурье.
+ *
+ * Функции работы с кэшем можно вызывать из разных потоков. Образы
+ * рассчитываются без блокировки кэша, поэтому расчёт большого образа не
+ * задерживает получение других образов.
+ */
+
+#include "hyscan-signal-replica.h"
+#include "hyscan-signal.h"
+#include "hyscan-fft-size.h"
+#include "pffft.h"
+#include <math.h>
+#include <string.h>
+
+/* Лимит объёма кэша образов по умолчанию, байт. */
+#define HYSCAN_SIGNAL_CACHE_SIZE        (64 * 1024 * 1024)
+
+/* Параметры сигнала - ключ кэша образов. */
+typedef struct
+{
+  gdouble                      disc_freq;      /* Частота дискретизации. */
+  gdouble                      start_freq;     /* Начальная частота. */
+  gdouble                      end_freq;       /* Конечная частота. */
+  gdouble                      duration;       /* Длительность. */
+  gdouble                      doppler;        /* Доплеровский коэффициент. */
+  guint32                      fft_size;       /* Размер спектра или 0 для образа во временной области. */
+} HyScanSignalReplicaKey;
+
+/* Образ в кэше. Образ принадлежит кэшу, объекты HyScanSignalReplica только
+ * ссылаются на него. Все поля, кроме данных, изменяются под блокировкой
+ * кэша. */
+typedef struct
+{
+  HyScanSignalReplicaKey       key;            /* Параметры сигнала. */
+  HyScanComplexFloat          *data;           /* Образ или спектр сигнала. */
+  guint32                      n_points;       /* Размер образа или спектра. */
+  guint                        n_users;        /* Число объектов, использующих образ. */
+  GWeakRef                     replica;        /* Объект, возвращаемый пользователям. */
+  GList                        link;           /* Элемент списка LRU. */
+} HyScanSignalCacheEntry;
+
+struct _HyScanSignalReplicaPrivate
+{
+  HyScanSignalCacheEntry      *entry;          /* Образ в кэше. */
+};
+
+static void    hyscan_signal_replica_object_finalize (GObject                *object);
+
+static void    hyscan_signal_spectrum_exact    (HyScanComplexFloat    *spectrum,
+                                                guint32                fft_size,
+                                                guint32                n_points,
+                                                gdouble                alpha);
+
+static gboolean hyscan_signal_spectrum_fft     (HyScanComplexFloat    *spectrum,
+                                                const HyScanSignalReplicaKey *key,
+                                                guint32                n_points);
+
+static guint   hyscan_signal_replica_key_hash  (gconstpointer          key);
+
+static gboolean hyscan_signal_replica_key_equal (gconstpointer         key1,
+                                                 gconstpointer         key2);
+
+static void    hyscan_signal_cache_trim        (void);
+
+static HyScanSignalReplica *
+               hyscan_signal_cache_use         (HyScanSignalCacheEntry *entry);
+
+static HyScanSignalReplica *
+               hyscan_signal_replica_get       (gdouble                disc_freq,
+                                                gdouble                start_freq,
+                                                gdouble                end_freq,
+                                                gdouble                duration,
+                                                gdouble                doppler,
+                                                guint32                fft_size);
+
+static GMutex      hyscan_signal_cache_lock;
+static GHashTable *hyscan_signal_cache = NULL;
+static GQueue      hyscan_signal_cache_lru = G_QUEUE_INIT;
+static gsize       hyscan_signal_cache_used = 0;
+static gsize       hyscan_signal_cache_max_size = HYSCAN_SIGNAL_CACHE_SIZE;
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanSignalReplica, hyscan_signal_replica, G_TYPE_OBJECT);
+
+static void
+hyscan_signal_replica_class_init (HyScanSignalReplicaClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_signal_replica_object_finalize;
+}
+
+static void
+hyscan_signal_replica_init (HyScanSignalReplica *replica)
+{
+  replica->priv = hyscan_signal_replica_get_instance_private (replica);
+}
+
+/* Объект перестаёт использовать образ. Если образов в кэше больше лимита,
+ * образ может быть удалён. */
+static void
+hyscan_signal_replica_object_finalize (GObject *object)
+{
+  HyScanSignalReplica *replica = HYSCAN_SIGNAL_REPLICA (object);
+
+  g_mutex_lock (&hyscan_signal_cache_lock);
+
+  replica->priv->entry->n_users -= 1;
+  hyscan_signal_cache_trim ();
+
+  g_mutex_unlock (&hyscan_signal_cache_lock);
+
+  G_OBJECT_CLASS (hyscan_signal_replica_parent_class)->finalize (object);
+}
+
+/* Функция рассчитывает комплексно сопряжённый спектр тонального сигнала
+ * exp (j * alpha * n) длительностью n_points отсчётов, дополненного нулями
+ * до fft_size. Спектр - сумма геометрической прогрессии:
+ *
+ *   X[k] = exp (j * theta * (n_points - 1) / 2) * sin (theta * n_points / 2) / sin (theta / 2),
+ *
+ * где theta = alpha - 2 * pi * k / fft_size. */
+static void
+hyscan_signal_spectrum_exact (HyScanComplexFloat *spectrum,
+                              guint32             fft_size,
+                              guint32             n_points,
+                              gdouble             alpha)
+{
+  gdouble scale = (gdouble) fft_size / n_points;
+  guint32 k;
+
+  for (k = 0; k < fft_size; k++)
+    {
+      gdouble theta = remainder (alpha - 2.0 * G_PI * k / fft_size, 2.0 * G_PI);
+      gdouble denominator = sin (0.5 * theta);
+      gdouble phase = 0.5 * theta * (n_points - 1);
+      gdouble amplitude;
+
+      if (fabs (denominator) < 1e-12)
+        amplitude = n_points;
+      else
+        amplitude = sin (0.5 * theta * n_points) / denominator;
+
+      amplitude *= scale;
+      spectrum[k].re = amplitude * cos (phase);
+      spectrum[k].im = -amplitude * sin (phase);
+    }
+}
+
+/* Функция рассчитывает комплексно сопряжённый спектр ЛЧМ сигнала с
+ * заданными параметрами через преобразование Фурье. */
+static gboolean
+hyscan_signal_spectrum_fft (HyScanComplexFloat           *spectrum,
+                            const HyScanSignalReplicaKey *key,
+                            guint32                       n_points)
+{
+  PFFFT_Setup *fft;
+  HyScanComplexFloat *work;
+  gfloat scale = (gfloat) key->fft_size / n_points;
+  guint32 k;
+
+  fft = pffft_new_setup (key->fft_size, PFFFT_COMPLEX);
+  if (fft == NULL)
+    return FALSE;
+
+  hyscan_signal_fill_lfm_doppler (key->disc_freq, key->start_freq, key->end_freq,
+                                  key->duration, key->doppler, spectrum, key->fft_size);
+
+  work = pffft_aligned_malloc (key->fft_size * sizeof (HyScanComplexFloat));
+  pffft_transform_ordered (fft, (const gfloat*) spectrum, (gfloat*) spectrum, (gfloat*) work, PFFFT_FORWARD);
+  pffft_aligned_free (work);
+  pffft_destroy_setup (fft);
+
+  for (k = 0; k < key->fft_size; k++)
+    {
+      spectrum[k].re = scale * spectrum[k].re;
+      spectrum[k].im = -scale * spectrum[k].im;
+    }
+
+  return TRUE;
+}
+
+/* Функция расчёта хэша параметров сигнала. */
+static guint
+hyscan_signal_replica_key_hash (gconstpointer key)
+{
+  const HyScanSignalReplicaKey *params = key;
+  guint hash;
+
+  hash = g_double_hash (&params->disc_freq);
+  hash = 31 * hash + g_double_hash (&params->start_freq);
+  hash = 31 * hash + g_double_hash (&params->end_freq);
+  hash = 31 * hash + g_double_hash (&params->duration);
+  hash = 31 * hash + g_double_hash (&params->doppler);
+  hash = 31 * hash + params->fft_size;
+
+  return hash;
+}
+
+/* Функция сравнения параметров сигналов. */
+static gboolean
+hyscan_signal_replica_key_equal (gconstpointer key1,
+                                 gconstpointer key2)
+{
+  const HyScanSignalReplicaKey *params1 = key1;
+  const HyScanSignalReplicaKey *params2 = key2;
+
+  return (params1->disc_freq == params2->disc_freq) &&
+         (params1->start_freq == params2->start_freq) &&
+         (params1->end_freq == params2->end_freq) &&
+         (params1->duration == params2->duration) &&
+         (params1->doppler == params2->doppler) &&
+         (params1->fft_size == params2->fft_size);
+}
+
+/* Функция удаляет из кэша неиспользуемые образы, начиная с самых старых,
+ * пока объём кэша превышает лимит. Вызывается с захваченной блокировкой. */
+static void
+hyscan_signal_cache_trim (void)
+{
+  GList *link = hyscan_signal_cache_lru.tail;
+
+  while ((link != NULL) && (hyscan_signal_cache_used > hyscan_signal_cache_max_size))
+    {
+      HyScanSignalCacheEntry *entry = link->data;
+
+      link = link->prev;
+
+      /* Число пользователей изменяется только под блокировкой, поэтому
+       * неиспользуемый образ не может стать используемым во время проверки. */
+      if (entry->n_users > 0)
+        continue;
+
+      g_queue_unlink (&hyscan_signal_cache_lru, &entry->link);
+      g_hash_table_remove (hyscan_signal_cache, &entry->key);
+      hyscan_signal_cache_used -= entry->n_points * sizeof (HyScanComplexFloat);
+
+      g_weak_ref_clear (&entry->replica);
+      pffft_aligned_free (entry->data);
+      g_slice_free (HyScanSignalCacheEntry, entry);
+    }
+}
+
+/* Функция переносит образ в начало списка LRU и возвращает объект для
+ * пользователя. Если объекта нет или он удаляется в другом потоке,
+ * создаётся новый объект. Вызывается с захваченной блокировкой. */
+static HyScanSignalReplica *
+hyscan_signal_cache_use (HyScanSignalCacheEntry *entry)
+{
+  HyScanSignalReplica *replica;
+
+  g_queue_unlink (&hyscan_signal_cache_lru, &entry->link);
+  g_queue_push_head_link (&hyscan_signal_cache_lru, &entry->link);
+
+  replica = g_weak_ref_get (&entry->replica);
+  if (replica != NULL)
+    return replica;
+
+  replica = g_object_new (HYSCAN_TYPE_SIGNAL_REPLICA, NULL);
+  replica->priv->entry = entry;
+  entry->n_users += 1;
+  g_weak_ref_set (&entry->replica, replica);
+
+  return replica;
+}
+
+/* Функция возвращает образ или спектр сигнала из кэша или рассчитывает
+ * его. Если fft_size равен нулю, возвращается образ во временной области.
+ * Расчёт выполняется без блокировки кэша. Если за это время такой же образ
+ * поместил в кэш другой поток, используется его образ. */
+static HyScanSignalReplica *
+hyscan_signal_replica_get (gdouble disc_freq,
+                           gdouble start_freq,
+                           gdouble end_freq,
+                           gdouble duration,
+                           gdouble doppler,
+                           guint32 fft_size)
+{
+  HyScanSignalReplicaKey key;
+  HyScanSignalCacheEntry *entry;
+  HyScanSignalReplica *replica;
+  HyScanComplexFloat *data;
+  guint32 n_points;
+  guint32 data_size;
+
+  g_return_val_if_fail (disc_freq > 0.0, NULL);
+  g_return_val_if_fail (duration > 0.0, NULL);
+  g_return_val_if_fail (doppler > 0.0, NULL);
+
+  n_points = (duration / doppler) * disc_freq;
+  if (n_points == 0)
+    return NULL;
+
+  /* Спектр используется при свёртке с шагом в половину FFT преобразования,
+   * поэтому образ должен занимать не более половины блока. */
+  if (fft_size > 0)
+    {
+      if (hyscan_fft_size_ceil (fft_size) != fft_size)
+        {
+          g_warning ("HyScanSignalReplica: unsupported fft size %u", fft_size);
+          return NULL;
+        }
+      if (2 * n_points > fft_size)
+        {
+          g_warning ("HyScanSignalReplica: fft size %u too small for %u points", fft_size, n_points);
+          return NULL;
+        }
+    }
+
+  data_size = (fft_size > 0) ? fft_size : n_points;
+
+  key.disc_freq = disc_freq;
+  key.start_freq = start_freq;
+  key.end_freq = end_freq;
+  key.duration = duration;
+  key.doppler = doppler;
+  key.fft_size = fft_size;
+
+  g_mutex_lock (&hyscan_signal_cache_lock);
+
+  if (hyscan_signal_cache == NULL)
+    {
+      hyscan_signal_cache = g_hash_table_new (hyscan_signal_replica_key_hash,
+                                              hyscan_signal_replica_key_equal);
+    }
+
+  entry = g_hash_table_lookup (hyscan_signal_cache, &key);
+  replica = (entry != NULL) ? hyscan_signal_cache_use (entry) : NULL;
+
+  g_mutex_unlock (&hyscan_signal_cache_lock);
+
+  if (replica != NULL)
+    return replica;
+
+  /* Расчёт образа. Спектр тонального сигнала рассчитывается точно, для
+   * остальных сигналов выполняется преобразование Фурье. */
+  data = pffft_aligned_malloc (data_size * sizeof (HyScanComplexFloat));
+
+  if (fft_size == 0)
+    {
+      hyscan_signal_fill_lfm_doppler (disc_freq, start_freq, end_freq, duration, doppler, data, data_size);
+    }
+  else if (start_freq == end_freq)
+    {
+      hyscan_signal_spectrum_exact (data, fft_size, n_points, 2.0 * G_PI * start_freq * doppler / disc_freq);
+    }
+  else if (!hyscan_signal_spectrum_fft (data, &key, n_points))
+    {
+      g_warning ("HyScanSignalReplica: can't setup fft");
+      pffft_aligned_free (data);
+      return NULL;
+    }
+
+  g_mutex_lock (&hyscan_signal_cache_lock);
+
+  entry = g_hash_table_lookup (hyscan_signal_cache, &key);
+  if (entry == NULL)
+    {
+      entry = g_slice_new0 (HyScanSignalCacheEntry);
+      entry->key = key;
+      entry->data = data;
+      entry->n_points = data_size;
+      entry->link.data = entry;
+      g_weak_ref_init (&entry->replica, NULL);
+
+      g_hash_table_insert (hyscan_signal_cache, &entry->key, entry);
+      g_queue_push_head_link (&hyscan_signal_cache_lru, &entry->link);
+      hyscan_signal_cache_used += data_size * sizeof (HyScanComplexFloat);
+
+      data = NULL;
+    }
+
+  /* Образ используется до удаления лишних образов из кэша. */
+  replica = hyscan_signal_cache_use (entry);
+  hyscan_signal_cache_trim ();
+
+  g_mutex_unlock (&hyscan_signal_cache_lock);
+
+  pffft_aligned_free (data);
+
+  return replica;
+}
+
+/**
+ * hyscan_signal_replica_tone:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ *
+ * Функция возвращает образ тонального сигнала из кэша. Если образа с такими
+ * параметрами в кэше нет, он рассчитывается и помещается в кэш. Образ
+ * совпадает с результатом #hyscan_signal_image_tone.
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_replica_tone (gdouble disc_freq,
+                            gdouble signal_freq,
+                            gdouble duration)
+{
+  return hyscan_signal_replica_get (disc_freq, signal_freq, signal_freq, duration, 1.0, 0);
+}
+
+/**
+ * hyscan_signal_replica_lfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ *
+ * Функция возвращает образ ЛЧМ сигнала из кэша. Если образа с такими
+ * параметрами в кэше нет, он рассчитывается и помещается в кэш. Образ
+ * совпадает с результатом #hyscan_signal_image_lfm.
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_replica_lfm (gdouble disc_freq,
+                           gdouble start_freq,
+                           gdouble end_freq,
+                           gdouble duration)
+{
+  return hyscan_signal_replica_get (disc_freq, start_freq, end_freq, duration, 1.0, 0);
+}
+
+/**
+ * hyscan_signal_replica_doppler:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @doppler: коэффициент доплеровского сжатия сигнала
+ *
+ * Функция возвращает образ ЛЧМ сигнала с доплеровским сжатием из кэша.
+ * Образ совпадает с результатом #hyscan_signal_image_lfm_doppler.
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_replica_doppler (gdouble disc_freq,
+                               gdouble start_freq,
+                               gdouble end_freq,
+                               gdouble duration,
+                               gdouble doppler)
+{
+  return hyscan_signal_replica_get (disc_freq, start_freq, end_freq, duration, doppler, 0);
+}
+
+/**
+ * hyscan_signal_spectrum_tone:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @fft_size: размер FFT преобразования
+ *
+ * Функция возвращает из кэша комплексно сопряжённый спектр образа тонального
+ * сигнала размером @fft_size. Спектр рассчитывается аналитически, без
+ * преобразования Фурье, и предназначен для #hyscan_convolution_set_image_fd.
+ *
+ * Размер FFT преобразования должен быть допустимым (см.
+ * #hyscan_convolution_get_fft_size) и не меньше удвоенного размера образа.
+ * Спектр масштабирован так, что результат свёртки совпадает с результатом
+ * свёртки с образом во временной области.
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_spectrum_tone (gdouble disc_freq,
+                             gdouble signal_freq,
+                             gdouble duration,
+                             guint32 fft_size)
+{
+  g_return_val_if_fail (fft_size > 0, NULL);
+
+  return hyscan_signal_replica_get (disc_freq, signal_freq, signal_freq, duration, 1.0, fft_size);
+}
+
+/**
+ * hyscan_signal_spectrum_lfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @fft_size: размер FFT преобразования
+ *
+ * Функция возвращает из кэша комплексно сопряжённый спектр образа ЛЧМ
+ * сигнала размером @fft_size. Спектр рассчитывается одним преобразованием
+ * Фурье при первом запросе. Требования к размеру FFT преобразования и
+ * масштаб спектра такие же, как у #hyscan_signal_spectrum_tone.
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_spectrum_lfm (gdouble disc_freq,
+                            gdouble start_freq,
+                            gdouble end_freq,
+                            gdouble duration,
+                            guint32 fft_size)
+{
+  g_return_val_if_fail (fft_size > 0, NULL);
+
+  return hyscan_signal_replica_get (disc_freq, start_freq, end_freq, duration, 1.0, fft_size);
+}
+
+/**
+ * hyscan_signal_spectrum_doppler:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @doppler: коэффициент доплеровского сжатия сигнала
+ * @fft_size: размер FFT преобразования
+ *
+ * Функция возвращает из кэша комплексно сопряжённый спектр образа ЛЧМ
+ * сигнала с доплеровским сжатием (см. #hyscan_signal_spectrum_lfm).
+ *
+ * Returns: (nullable) (transfer full): #HyScanSignalReplica или NULL.
+ *          Для удаления #g_object_unref.
+ */
+HyScanSignalReplica *
+hyscan_signal_spectrum_doppler (gdouble disc_freq,
+                                gdouble start_freq,
+                                gdouble end_freq,
+                                gdouble duration,
+                                gdouble doppler,
+                                guint32 fft_size)
+{
+  g_return_val_if_fail (fft_size > 0, NULL);
+
+  return hyscan_signal_replica_get (disc_freq, start_freq, end_freq, duration, doppler, fft_size);
+}
+
+/**
+ * hyscan_signal_replica_get_data:
+ * @replica: указатель на #HyScanSignalReplica
+ * @n_points: (out): размер образа сигнала в точках
+ *
+ * Функция возвращает образ или спектр сигнала. Данные выровнены для векторных вычислений
+ * и не должны изменяться. Указатель действителен, пока существует объект.
+ *
+ * Returns: (array length=n_points) (transfer none): Образ или спектр сигнала.
+ */
+const HyScanComplexFloat *
+hyscan_signal_replica_get_data (HyScanSignalReplica *replica,
+                                guint32             *n_points)
+{
+  g_return_val_if_fail (HYSCAN_IS_SIGNAL_REPLICA (replica), NULL);
+
+  *n_points = replica->priv->entry->n_points;
+
+  return replica->priv->entry->data;
+}
+
+/**
+ * hyscan_signal_cache_set_size:
+ * @max_size: лимит объёма кэша, байт
+ *
+ * Функция устанавливает лимит объёма кэша образов сигналов. При превышении
+ * лимита неиспользуемые образы удаляются в порядке давности последнего
+ * запроса. При нулевом лимите в кэше остаются только используемые образы.
+ * По умолчанию лимит равен 64 Мб.
+ */
+void
+hyscan_signal_cache_set_size (gsize max_size)
+{
+  g_mutex_lock (&hyscan_signal_cache_lock);
+
+  hyscan_signal_cache_max_size = max_size;
+  hyscan_signal_cache_trim ();
+
+  g_mutex_unlock (&hyscan_signal_cache_lock);
+}
+
+/**
+ * hyscan_signal_cache_get_size:
+ *
+ * Функция возвращает суммарный объём образов в кэше, включая используемые
+ * образы.
+ *
+ * Returns: Объём кэша, байт.
+ */
+gsize
+hyscan_signal_cache_get_size (void)
+{
+  gsize used;
+
+  g_mutex_lock (&hyscan_signal_cache_lock);
+  used = hyscan_signal_cache_used;
+  g_mutex_unlock (&hyscan_signal_cache_lock);
+
+  return used;
+}
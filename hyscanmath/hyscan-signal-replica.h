@@ -0,0 +1,121 @@
+/* hyscan-signal-replica.h
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_SIGNAL_REPLICA_H__
+#define __HYSCAN_SIGNAL_REPLICA_H__
+
+#include <glib-object.h>
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_SIGNAL_REPLICA             (hyscan_signal_replica_get_type ())
+#define HYSCAN_SIGNAL_REPLICA(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_SIGNAL_REPLICA, HyScanSignalReplica))
+#define HYSCAN_IS_SIGNAL_REPLICA(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_SIGNAL_REPLICA))
+#define HYSCAN_SIGNAL_REPLICA_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_SIGNAL_REPLICA, HyScanSignalReplicaClass))
+#define HYSCAN_IS_SIGNAL_REPLICA_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_SIGNAL_REPLICA))
+#define HYSCAN_SIGNAL_REPLICA_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_SIGNAL_REPLICA, HyScanSignalReplicaClass))
+
+typedef struct _HyScanSignalReplica HyScanSignalReplica;
+typedef struct _HyScanSignalReplicaPrivate HyScanSignalReplicaPrivate;
+typedef struct _HyScanSignalReplicaClass HyScanSignalReplicaClass;
+
+struct _HyScanSignalReplica
+{
+  GObject parent_instance;
+
+  HyScanSignalReplicaPrivate *priv;
+};
+
+struct _HyScanSignalReplicaClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_signal_replica_get_type  (void);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_replica_tone      (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                duration);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_replica_lfm       (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_replica_doppler   (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                doppler);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_spectrum_tone     (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                duration,
+                                                        guint32                fft_size);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_spectrum_lfm      (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        guint32                fft_size);
+
+HYSCAN_API
+HyScanSignalReplica   *hyscan_signal_spectrum_doppler  (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                doppler,
+                                                        guint32                fft_size);
+
+HYSCAN_API
+const HyScanComplexFloat *
+                       hyscan_signal_replica_get_data  (HyScanSignalReplica   *replica,
+                                                        guint32               *n_points);
+
+HYSCAN_API
+void                   hyscan_signal_cache_set_size    (gsize                  max_size);
+
+HYSCAN_API
+gsize                  hyscan_signal_cache_get_size    (void);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_SIGNAL_REPLICA_H__ */
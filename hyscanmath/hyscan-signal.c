@@ -32,8 +32,426 @@
  * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
  */
 
+/**
+ * SECTION: hyscan-signal
+ * @Short_description: функции расчёта образов сигналов
+ * @Title: HyScanSignal
+ *
+ * Функции предназначены для расчёта образов сигналов, используемых при
+ * свёртке (см. #HyScanConvolution):
+ *
+ * - тонального сигнала - #hyscan_signal_image_tone;
+ * - ЛЧМ сигнала - #hyscan_signal_image_lfm и #hyscan_signal_image_lfm_doppler;
+ * - сигнала с гиперболической частотной модуляцией - #hyscan_signal_image_hfm;
+ * - сигнала с нелинейной частотной модуляцией - #hyscan_signal_image_nlfm;
+ * - фазоманипулированных сигналов - #hyscan_signal_image_barker и
+ *   #hyscan_signal_image_mseq;
+ * - сигнала с частотной манипуляцией по коду Костаса - #hyscan_signal_image_costas.
+ *
+ * Отсчёты сигнала вычисляются не прямым вызовом тригонометрических функций
+ * для каждого отсчёта, а рекуррентным умножением на комплексные множители.
+ * Сигнал рассчитывается блоками: отсчёты каждого блока получаются
+ * умножением опорного отсчёта блока на массив множителей, который для
+ * следующего блока обновляется поэлементным умножением. Для ЛЧМ сигнала
+ * приращение фазы между блоками меняется линейно, что учитывается второй
+ * ступенью рекурсии. Опорные отсчёты вычисляются точно для каждого блока,
+ * а массив множителей периодически пересчитывается, поэтому ошибка не
+ * накапливается. Отличие от точного значения не превышает 1e-6, т.е.
+ * определяется точностью представления отсчётов в формате float.
+ *
+ * Фаза сигналов с нелинейной частотной модуляцией на каждом блоке
+ * аппроксимируется квадратичной функцией, а отсчёты блока рассчитываются
+ * той же рекурсией в нескольких независимых потоках. Размер блока
+ * уменьшается, пока ошибка аппроксимации фазы превышает 1e-7 радиан.
+ *
+ * Функции hyscan_signal_fill_* записывают образ в буфер пользователя,
+ * например выровненный буфер, выделенный #hyscan_fft_alloc, что позволяет
+ * передавать образ в #HyScanFFT и #HyScanConvolution без промежуточного
+ * копирования. Если буфер больше образа, оставшаяся часть буфера заполняется
+ * нулями, если меньше - образ обрезается. Функции возвращают полный размер
+ * образа, если буфер равен NULL - только рассчитывают размер.
+ *
+ * Функции hyscan_signal_image_* возвращают новую копию образа при каждом
+ * вызове. Если один и тот же образ используется несколькими каналами,
+ * его можно получить из общего кэша образов (см. #HyScanSignalReplica).
+ */
+
 #include "hyscan-signal.h"
 #include <math.h>
+#include <string.h>
+
+/* Размер блока отсчётов сигнала. */
+#define HYSCAN_SIGNAL_BLOCK_SIZE        256
+
+/* Период точного пересчёта множителей, в блоках. */
+#define HYSCAN_SIGNAL_REFRESH_BLOCKS    64
+
+/* Число независимых рекурсий при расчёте блока с квадратичной фазой. */
+#define HYSCAN_SIGNAL_LANES             8
+
+/* Допустимая ошибка квадратичной аппроксимации фазы, радиан. */
+#define HYSCAN_SIGNAL_PHASE_ERROR       1e-7
+
+/* Функция возвращает фазу сигнала в радианах для отсчёта n. */
+typedef gdouble (*HyScanSignalPhaseFunc)       (gdouble                n,
+                                                gconstpointer          params);
+
+/* Параметры сигнала с гиперболической частотной модуляцией. */
+typedef struct
+{
+  gdouble                      scale;          /* Множитель логарифма. */
+  gdouble                      rate;           /* Скорость изменения периода, 1 / отсчёт. */
+} HyScanSignalHFM;
+
+/* Параметры сигнала с нелинейной частотной модуляцией. */
+typedef struct
+{
+  gdouble                      n_points;       /* Длительность сигнала, отсчёты. */
+  gdouble                      start;          /* Начальная частота, радиан / отсчёт. */
+  gdouble                      band;           /* Полоса сигнала, радиан / отсчёт. */
+  gdouble                      ripple;         /* Коэффициент неравномерности скорости. */
+} HyScanSignalNLFM;
+
+/* Коды Баркера. */
+static const gchar *hyscan_signal_barker_codes[] =
+{
+  NULL, NULL, "+-", "++-", "++-+", "+++-+", NULL, "+++--+-",
+  NULL, NULL, NULL, "+++---+--+-", NULL, "+++++--++-+-+"
+};
+
+/* Маски отводов регистра сдвига с линейной обратной связью для
+ * M-последовательностей степени от 2 до 16. */
+static const guint32 hyscan_signal_mseq_taps[] =
+{
+  0, 0, 0x3, 0x3, 0x3, 0x5, 0x3, 0x3,
+  0x1d, 0x11, 0x9, 0x5, 0x107, 0x27, 0x1007, 0x3, 0x100b
+};
+
+static void    hyscan_signal_generate          (HyScanComplexFloat    *image,
+                                                guint                  n_points,
+                                                gdouble                alpha,
+                                                gdouble                beta);
+
+static void    hyscan_signal_generate_block    (HyScanComplexFloat    *image,
+                                                guint32                n_points,
+                                                gdouble                phase,
+                                                gdouble                alpha,
+                                                gdouble                beta);
+
+static void    hyscan_signal_generate_phase    (HyScanComplexFloat    *image,
+                                                guint32                n_points,
+                                                guint32                size,
+                                                HyScanSignalPhaseFunc  func,
+                                                gconstpointer          params);
+
+static gdouble hyscan_signal_phase_hfm         (gdouble                n,
+                                                gconstpointer          params);
+
+static gdouble hyscan_signal_phase_nlfm        (gdouble                n,
+                                                gconstpointer          params);
+
+static guint32 hyscan_signal_fill_begin        (HyScanComplexFloat    *buffer,
+                                                guint32                size,
+                                                guint32                n_points);
+
+static guint32 hyscan_signal_fill_code         (gdouble                disc_freq,
+                                                gdouble                signal_freq,
+                                                gdouble                chip_duration,
+                                                const gint8           *code,
+                                                guint32                length,
+                                                HyScanComplexFloat    *buffer,
+                                                guint32                size);
+
+/* Функция рассчитывает отсчёты сигнала exp (j * (alpha * n + beta * n^2)).
+ *
+ * Отсчёт с номером start + k, где start - начало блока, равен произведению
+ * опорного отсчёта блока exp (j * (alpha * start + beta * start^2)) и
+ * множителя exp (j * (alpha * k + beta * k^2 + 2 * beta * start * k)).
+ * При переходе к следующему блоку множитель умножается на
+ * exp (j * 2 * beta * BLOCK_SIZE * k). Внутренние циклы не содержат
+ * зависимостей между итерациями и векторизуются компилятором. */
+static void
+hyscan_signal_generate (HyScanComplexFloat *image,
+                        guint               n_points,
+                        gdouble             alpha,
+                        gdouble             beta)
+{
+  gdouble e_re[HYSCAN_SIGNAL_BLOCK_SIZE];
+  gdouble e_im[HYSCAN_SIGNAL_BLOCK_SIZE];
+  gdouble d_re[HYSCAN_SIGNAL_BLOCK_SIZE];
+  gdouble d_im[HYSCAN_SIGNAL_BLOCK_SIZE];
+  guint size = MIN (HYSCAN_SIGNAL_BLOCK_SIZE, n_points);
+  guint start;
+  guint block;
+  guint k;
+
+  /* Для коротких сигналов множители следующего блока не нужны. */
+  if (n_points > HYSCAN_SIGNAL_BLOCK_SIZE)
+    {
+      for (k = 0; k < HYSCAN_SIGNAL_BLOCK_SIZE; k++)
+        {
+          gdouble phase = 2.0 * beta * HYSCAN_SIGNAL_BLOCK_SIZE * k;
+
+          d_re[k] = cos (phase);
+          d_im[k] = sin (phase);
+        }
+    }
+
+  for (start = 0, block = 0; start < n_points; start += HYSCAN_SIGNAL_BLOCK_SIZE, block++)
+    {
+      guint n = MIN (HYSCAN_SIGNAL_BLOCK_SIZE, n_points - start);
+      gdouble a_phase = alpha * start + beta * (gdouble) start * start;
+      gdouble a_re = cos (a_phase);
+      gdouble a_im = sin (a_phase);
+      HyScanComplexFloat *out = image + start;
+
+      /* Точный пересчёт множителей. */
+      if ((block % HYSCAN_SIGNAL_REFRESH_BLOCKS) == 0)
+        {
+          for (k = 0; k < size; k++)
+            {
+              gdouble phase = alpha * k + beta * ((gdouble) k * k + 2.0 * (gdouble) start * k);
+
+              e_re[k] = cos (phase);
+              e_im[k] = sin (phase);
+            }
+        }
+
+      for (k = 0; k < n; k++)
+        {
+          out[k].re = a_re * e_re[k] - a_im * e_im[k];
+          out[k].im = a_re * e_im[k] + a_im * e_re[k];
+        }
+
+      if (start + HYSCAN_SIGNAL_BLOCK_SIZE >= n_points)
+        break;
+
+      /* Множители для следующего блока. */
+      for (k = 0; k < HYSCAN_SIGNAL_BLOCK_SIZE; k++)
+        {
+          gdouble re = e_re[k] * d_re[k] - e_im[k] * d_im[k];
+          gdouble im = e_re[k] * d_im[k] + e_im[k] * d_re[k];
+
+          e_re[k] = re;
+          e_im[k] = im;
+        }
+    }
+}
+
+/* Функция рассчитывает отсчёты exp (j * (phase + alpha * k + beta * k^2)).
+ *
+ * Отсчёты рассчитываются HYSCAN_SIGNAL_LANES независимыми рекурсиями: рекурсия
+ * с номером l рассчитывает отсчёты l, l + LANES, l + 2 * LANES и т.д. Отсчёт
+ * умножается на множитель w, а множитель - на постоянный множитель c:
+ *
+ *   w = exp (j * (LANES * alpha + beta * (2 * LANES * k + LANES^2))),
+ *   c = exp (j * 2 * beta * LANES^2).
+ *
+ * Внутренний цикл по рекурсиям векторизуется компилятором. */
+static void
+hyscan_signal_generate_block (HyScanComplexFloat *image,
+                              guint32             n_points,
+                              gdouble             phase,
+                              gdouble             alpha,
+                              gdouble             beta)
+{
+  gdouble z_re[HYSCAN_SIGNAL_LANES];
+  gdouble z_im[HYSCAN_SIGNAL_LANES];
+  gdouble w_re[HYSCAN_SIGNAL_LANES];
+  gdouble w_im[HYSCAN_SIGNAL_LANES];
+  gdouble c_re, c_im;
+  guint32 lanes = HYSCAN_SIGNAL_LANES;
+  guint32 k, l;
+
+  for (l = 0; l < lanes; l++)
+    {
+      gdouble z_phase = phase + alpha * l + beta * l * l;
+      gdouble w_phase = lanes * alpha + beta * (2.0 * lanes * l + lanes * lanes);
+
+      z_re[l] = cos (z_phase);
+      z_im[l] = sin (z_phase);
+      w_re[l] = cos (w_phase);
+      w_im[l] = sin (w_phase);
+    }
+
+  c_re = cos (2.0 * beta * lanes * lanes);
+  c_im = sin (2.0 * beta * lanes * lanes);
+
+  for (k = 0; k + lanes <= n_points; k += lanes)
+    {
+      for (l = 0; l < lanes; l++)
+        {
+          gdouble re, im;
+
+          image[k + l].re = z_re[l];
+          image[k + l].im = z_im[l];
+
+          re = z_re[l] * w_re[l] - z_im[l] * w_im[l];
+          im = z_re[l] * w_im[l] + z_im[l] * w_re[l];
+          z_re[l] = re;
+          z_im[l] = im;
+
+          re = w_re[l] * c_re - w_im[l] * c_im;
+          im = w_re[l] * c_im + w_im[l] * c_re;
+          w_re[l] = re;
+          w_im[l] = im;
+        }
+    }
+
+  for (l = 0; k + l < n_points; l++)
+    {
+      image[k + l].re = z_re[l];
+      image[k + l].im = z_im[l];
+    }
+}
+
+/* Функция рассчитывает отсчёты сигнала exp (j * func (n)) с произвольным
+ * законом изменения фазы. Фаза на каждом блоке аппроксимируется
+ * квадратичной функцией по трём точкам: началу, середине и концу блока.
+ * Ошибка аппроксимации проверяется в четвертях блока, где она близка к
+ * максимальной. Если ошибка велика, размер блока уменьшается вдвое.
+ *
+ * Разбиение на блоки зависит только от размера сигнала n_points, поэтому
+ * первые size отсчётов не зависят от числа рассчитываемых отсчётов. */
+static void
+hyscan_signal_generate_phase (HyScanComplexFloat    *image,
+                              guint32                n_points,
+                              guint32                size,
+                              HyScanSignalPhaseFunc  func,
+                              gconstpointer          params)
+{
+  guint32 start = 0;
+
+  while (start < size)
+    {
+      guint32 block = MIN (HYSCAN_SIGNAL_BLOCK_SIZE, n_points - start);
+      gdouble phase0, alpha, beta;
+
+      while (TRUE)
+        {
+          gdouble phase1 = func (start + 0.5 * block, params);
+          gdouble phase2 = func (start + block, params);
+          gdouble error1, error2;
+          gdouble q1 = 0.25 * block;
+          gdouble q3 = 0.75 * block;
+
+          phase0 = func (start, params);
+          beta = 2.0 * (phase2 - 2.0 * phase1 + phase0) / ((gdouble) block * block);
+          alpha = (phase2 - phase0) / block - beta * block;
+
+          if (block <= 2 * HYSCAN_SIGNAL_LANES)
+            break;
+
+          error1 = func (start + q1, params) - (phase0 + alpha * q1 + beta * q1 * q1);
+          error2 = func (start + q3, params) - (phase0 + alpha * q3 + beta * q3 * q3);
+          if ((fabs (error1) < HYSCAN_SIGNAL_PHASE_ERROR) && (fabs (error2) < HYSCAN_SIGNAL_PHASE_ERROR))
+            break;
+
+          block /= 2;
+        }
+
+      hyscan_signal_generate_block (image + start, MIN (block, size - start), phase0, alpha, beta);
+      start += block;
+    }
+}
+
+/* Фаза сигнала с гиперболической частотной модуляцией. Период сигнала
+ * меняется линейно, а фаза равна -scale * ln (1 - rate * n). */
+static gdouble
+hyscan_signal_phase_hfm (gdouble       n,
+                         gconstpointer params)
+{
+  const HyScanSignalHFM *hfm = params;
+
+  return -hfm->scale * log1p (-hfm->rate * n);
+}
+
+/* Фаза сигнала с нелинейной частотной модуляцией. Доля полосы x, которой
+ * достигает частота к моменту u = n / n_points, определяется уравнением
+ * u = x - ripple * sin (2 * pi * x) / (2 * pi), т.е. скорость изменения
+ * частоты обратно пропорциональна окну Хэмминга по частоте. Уравнение
+ * решается методом Ньютона, а фаза - интеграл частоты по времени. */
+static gdouble
+hyscan_signal_phase_nlfm (gdouble       n,
+                          gconstpointer params)
+{
+  const HyScanSignalNLFM *nlfm = params;
+  gdouble u = n / nlfm->n_points;
+  gdouble x = u;
+  gdouble s, c;
+  guint i;
+
+  for (i = 0; i < 32; i++)
+    {
+      gdouble dx;
+
+      s = sin (2.0 * G_PI * x);
+      c = cos (2.0 * G_PI * x);
+      dx = (x - nlfm->ripple * s / (2.0 * G_PI) - u) / (1.0 - nlfm->ripple * c);
+      x = CLAMP (x - dx, 0.0, 1.0);
+
+      if (fabs (dx) < 1e-15)
+        break;
+    }
+
+  s = sin (2.0 * G_PI * x);
+  c = cos (2.0 * G_PI * x);
+
+  return nlfm->n_points *
+         (nlfm->start * (x - nlfm->ripple * s / (2.0 * G_PI)) +
+          nlfm->band * (0.5 * x * x - nlfm->ripple * (x * s / (2.0 * G_PI) + (c - 1.0) / (4.0 * G_PI * G_PI))));
+}
+
+/* Функция рассчитывает образ тонального сигнала с манипуляцией фазы
+ * на 180 градусов по коду. */
+static guint32
+hyscan_signal_fill_code (gdouble             disc_freq,
+                         gdouble             signal_freq,
+                         gdouble             chip_duration,
+                         const gint8        *code,
+                         guint32             length,
+                         HyScanComplexFloat *buffer,
+                         guint32             size)
+{
+  guint32 n_points = length * chip_duration * disc_freq;
+  guint32 start, end;
+  guint32 i, j;
+
+  size = hyscan_signal_fill_begin (buffer, size, n_points);
+  hyscan_signal_generate (buffer, size, 2.0 * G_PI * signal_freq / disc_freq, 0.0);
+
+  for (i = 0, start = 0; (i < length) && (start < size); i++, start = end)
+    {
+      end = MIN ((i + 1) * chip_duration * disc_freq, size);
+      if (code[i] > 0)
+        continue;
+
+      for (j = start; j < end; j++)
+        {
+          buffer[j].re = -buffer[j].re;
+          buffer[j].im = -buffer[j].im;
+        }
+    }
+
+  return n_points;
+}
+
+/* Функция подготавливает буфер пользователя для образа размером n_points:
+ * заполняет нулями часть буфера за концом образа и возвращает число
+ * отсчётов образа, которые нужно рассчитать. */
+static guint32
+hyscan_signal_fill_begin (HyScanComplexFloat *buffer,
+                          guint32             size,
+                          guint32             n_points)
+{
+  if (buffer == NULL)
+    return 0;
+
+  if (size > n_points)
+    memset (buffer + n_points, 0, (size - n_points) * sizeof (HyScanComplexFloat));
+
+  return MIN (size, n_points);
+}
 
 /**
  * hyscan_signal_image_tone:
@@ -54,25 +472,16 @@ hyscan_signal_image_tone (gdouble  discretization_frequency,
                           guint   *n_points)
 {
   HyScanComplexFloat *image;
-  guint i;
-
-  *n_points = duration * discretization_frequency;
-  image = g_new0 (HyScanComplexFloat, *n_points);
 
-  for (i = 0; i < *n_points; i++)
-    {
-      gdouble time = i * (1.0 / discretization_frequency);
-      gdouble phase = 2.0 * G_PI * signal_frequency * time;
-
-      image[i].re = cos (phase);
-      image[i].im = sin (phase);
-    }
+  *n_points = hyscan_signal_fill_tone (discretization_frequency, signal_frequency, duration, NULL, 0);
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_tone (discretization_frequency, signal_frequency, duration, image, *n_points);
 
   return image;
 }
 
 /**
- * hyscan_signal_image_tone:
+ * hyscan_signal_image_lfm:
  * @discretization_frequency: частота дискретизации сигнала, Гц
  * @start_frequency: начальная частота сигнала, Гц
  * @end_frequency: конечная частота сигнала, Гц
@@ -92,21 +501,553 @@ hyscan_signal_image_lfm (gdouble  discretization_freq,
                          guint   *n_points)
 {
   HyScanComplexFloat *image;
-  gdouble bandwidth;
+
+  *n_points = hyscan_signal_fill_lfm (discretization_freq, start_frequency, end_frequency, duration, NULL, 0);
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_lfm (discretization_freq, start_frequency, end_frequency, duration, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_lfm_doppler:
+ * @discretization_freq: частота дискретизации сигнала, Гц
+ * @start_frequency: начальная частота сигнала, Гц
+ * @end_frequency: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @doppler: коэффициент доплеровского сжатия сигнала
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ ЛЧМ сигнала, принятого от движущейся цели.
+ * Доплеровский эффект приводит к сжатию сигнала во времени: принятый сигнал
+ * s(doppler * t) имеет длительность duration / doppler, а все его частоты
+ * умножены на doppler. Коэффициент doppler равен (c + v) / (c - v), где c -
+ * скорость звука, v - скорость сближения. При doppler = 1 образ совпадает
+ * с #hyscan_signal_image_lfm.
+ *
+ * Returns: (array length=n_points) (transfer full): Образ сигнала.
+ *          Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_lfm_doppler (gdouble  discretization_freq,
+                                 gdouble  start_frequency,
+                                 gdouble  end_frequency,
+                                 gdouble  duration,
+                                 gdouble  doppler,
+                                 guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_lfm_doppler (discretization_freq, start_frequency, end_frequency,
+                                              duration, doppler, NULL, 0);
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_lfm_doppler (discretization_freq, start_frequency, end_frequency,
+                                  duration, doppler, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_hfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ сигнала с гиперболической частотной модуляцией.
+ * Период такого сигнала меняется линейно во времени, поэтому доплеровское
+ * сжатие приводит только к сдвигу сигнала по времени и свёртка с ним
+ * устойчива к доплеровскому эффекту. Начальная и конечная частоты должны
+ * быть одного знака.
+ *
+ * Returns: (array length=n_points) (transfer full): Образ сигнала.
+ *          Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_hfm (gdouble  disc_freq,
+                         gdouble  start_freq,
+                         gdouble  end_freq,
+                         gdouble  duration,
+                         guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_hfm (disc_freq, start_freq, end_freq, duration, NULL, 0);
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_hfm (disc_freq, start_freq, end_freq, duration, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_nlfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @pedestal: уровень окна на краях полосы, от 0.5 до 1
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ сигнала с нелинейной частотной модуляцией.
+ * Амплитуда сигнала постоянна, а скорость изменения частоты обратно
+ * пропорциональна окну pedestal - (1 - pedestal) * cos (2 * pi * x), где x -
+ * положение частоты в полосе от 0 до 1. Энергетический спектр сигнала
+ * повторяет форму окна, поэтому уровень боковых лепестков свёртки снижается
+ * без потерь, связанных с взвешиванием. При @pedestal равном 0.54 окно
+ * совпадает с окном Хэмминга, при 1 сигнал совпадает с ЛЧМ.
+ *
+ * Returns: (array length=n_points) (transfer full): Образ сигнала.
+ *          Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_nlfm (gdouble  disc_freq,
+                          gdouble  start_freq,
+                          gdouble  end_freq,
+                          gdouble  duration,
+                          gdouble  pedestal,
+                          guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_nlfm (disc_freq, start_freq, end_freq, duration, pedestal, NULL, 0);
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_nlfm (disc_freq, start_freq, end_freq, duration, pedestal, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_barker:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @length: длина кода Баркера: 2, 3, 4, 5, 7, 11 или 13
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ тонального сигнала с манипуляцией фазы на
+ * 180 градусов по коду Баркера.
+ *
+ * Returns: (nullable) (array length=n_points) (transfer full): Образ сигнала
+ *          или NULL. Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_barker (gdouble  disc_freq,
+                            gdouble  signal_freq,
+                            gdouble  chip_duration,
+                            guint    length,
+                            guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_barker (disc_freq, signal_freq, chip_duration, length, NULL, 0);
+  if (*n_points == 0)
+    return NULL;
+
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_barker (disc_freq, signal_freq, chip_duration, length, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_mseq:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @degree: степень M-последовательности, от 2 до 16
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ тонального сигнала с манипуляцией фазы на
+ * 180 градусов по M-последовательности длиной 2^@degree - 1 элементов.
+ *
+ * Returns: (nullable) (array length=n_points) (transfer full): Образ сигнала
+ *          или NULL. Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_mseq (gdouble  disc_freq,
+                          gdouble  signal_freq,
+                          gdouble  chip_duration,
+                          guint    degree,
+                          guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_mseq (disc_freq, signal_freq, chip_duration, degree, NULL, 0);
+  if (*n_points == 0)
+    return NULL;
+
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_mseq (disc_freq, signal_freq, chip_duration, degree, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_image_costas:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: наименьшая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @order: число элементов кода, на единицу меньше простого числа
+ * @n_points: расчитанный размер образа сигнала в точках
+ *
+ * Функция расчитывает образ сигнала с частотной манипуляцией по коду
+ * Костаса. Код строится по методу Уэлча: частота элемента i равна
+ * @start_freq + (g^i mod p - 1) / @chip_duration, где p = @order + 1 -
+ * простое число, а g - первообразный корень по модулю p. Полоса сигнала
+ * равна @order / @chip_duration.
+ *
+ * Returns: (nullable) (array length=n_points) (transfer full): Образ сигнала
+ *          или NULL. Для освобождения #g_free.
+ */
+HyScanComplexFloat *
+hyscan_signal_image_costas (gdouble  disc_freq,
+                            gdouble  start_freq,
+                            gdouble  chip_duration,
+                            guint    order,
+                            guint   *n_points)
+{
+  HyScanComplexFloat *image;
+
+  *n_points = hyscan_signal_fill_costas (disc_freq, start_freq, chip_duration, order, NULL, 0);
+  if (*n_points == 0)
+    return NULL;
+
+  image = g_new (HyScanComplexFloat, *n_points);
+  hyscan_signal_fill_costas (disc_freq, start_freq, chip_duration, order, image, *n_points);
+
+  return image;
+}
+
+/**
+ * hyscan_signal_fill_tone:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ тонального сигнала в буфер пользователя
+ * (см. #hyscan_signal_image_tone).
+ *
+ * Returns: Размер образа сигнала в точках.
+ */
+guint32
+hyscan_signal_fill_tone (gdouble             disc_freq,
+                         gdouble             signal_freq,
+                         gdouble             duration,
+                         HyScanComplexFloat *buffer,
+                         guint32             size)
+{
+  return hyscan_signal_fill_lfm_doppler (disc_freq, signal_freq, signal_freq, duration, 1.0, buffer, size);
+}
+
+/**
+ * hyscan_signal_fill_lfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ ЛЧМ сигнала в буфер пользователя
+ * (см. #hyscan_signal_image_lfm).
+ *
+ * Returns: Размер образа сигнала в точках.
+ */
+guint32
+hyscan_signal_fill_lfm (gdouble             disc_freq,
+                        gdouble             start_freq,
+                        gdouble             end_freq,
+                        gdouble             duration,
+                        HyScanComplexFloat *buffer,
+                        guint32             size)
+{
+  return hyscan_signal_fill_lfm_doppler (disc_freq, start_freq, end_freq, duration, 1.0, buffer, size);
+}
+
+/**
+ * hyscan_signal_fill_lfm_doppler:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @doppler: коэффициент доплеровского сжатия сигнала
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ ЛЧМ сигнала, принятого от движущейся цели,
+ * в буфер пользователя (см. #hyscan_signal_image_lfm_doppler).
+ *
+ * Returns: Размер образа сигнала в точках.
+ */
+guint32
+hyscan_signal_fill_lfm_doppler (gdouble             disc_freq,
+                                gdouble             start_freq,
+                                gdouble             end_freq,
+                                gdouble             duration,
+                                gdouble             doppler,
+                                HyScanComplexFloat *buffer,
+                                guint32             size)
+{
+  guint32 n_points = (duration / doppler) * disc_freq;
+
+  size = hyscan_signal_fill_begin (buffer, size, n_points);
+  hyscan_signal_generate (buffer, size,
+                          2.0 * G_PI * start_freq * doppler / disc_freq,
+                          G_PI * (end_freq - start_freq) * doppler * doppler / (duration * disc_freq * disc_freq));
+
+  return n_points;
+}
+
+/**
+ * hyscan_signal_fill_hfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ сигнала с гиперболической частотной модуляцией
+ * в буфер пользователя (см. #hyscan_signal_image_hfm).
+ *
+ * Returns: Размер образа сигнала в точках.
+ */
+guint32
+hyscan_signal_fill_hfm (gdouble             disc_freq,
+                        gdouble             start_freq,
+                        gdouble             end_freq,
+                        gdouble             duration,
+                        HyScanComplexFloat *buffer,
+                        guint32             size)
+{
+  guint32 n_points = duration * disc_freq;
+  HyScanSignalHFM hfm;
+
+  g_return_val_if_fail (start_freq * end_freq > 0.0, 0);
+
+  size = hyscan_signal_fill_begin (buffer, size, n_points);
+
+  if (start_freq == end_freq)
+    {
+      hyscan_signal_generate (buffer, size, 2.0 * G_PI * start_freq / disc_freq, 0.0);
+      return n_points;
+    }
+
+  /* Частота f (t) = f0 / (1 - rate * t), где rate = (f1 - f0) / (f1 * T). */
+  hfm.rate = (end_freq - start_freq) / (end_freq * duration * disc_freq);
+  hfm.scale = 2.0 * G_PI * start_freq / (disc_freq * hfm.rate);
+
+  hyscan_signal_generate_phase (buffer, n_points, size, hyscan_signal_phase_hfm, &hfm);
+
+  return n_points;
+}
+
+/**
+ * hyscan_signal_fill_nlfm:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: начальная частота сигнала, Гц
+ * @end_freq: конечная частота сигнала, Гц
+ * @duration: длительность сигнала, с
+ * @pedestal: уровень окна на краях полосы, от 0.5 до 1
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ сигнала с нелинейной частотной модуляцией
+ * в буфер пользователя (см. #hyscan_signal_image_nlfm).
+ *
+ * Returns: Размер образа сигнала в точках.
+ */
+guint32
+hyscan_signal_fill_nlfm (gdouble             disc_freq,
+                         gdouble             start_freq,
+                         gdouble             end_freq,
+                         gdouble             duration,
+                         gdouble             pedestal,
+                         HyScanComplexFloat *buffer,
+                         guint32             size)
+{
+  guint32 n_points = duration * disc_freq;
+  HyScanSignalNLFM nlfm;
+
+  g_return_val_if_fail ((pedestal > 0.5) && (pedestal <= 1.0), 0);
+
+  nlfm.n_points = duration * disc_freq;
+  nlfm.start = 2.0 * G_PI * start_freq / disc_freq;
+  nlfm.band = 2.0 * G_PI * (end_freq - start_freq) / disc_freq;
+  nlfm.ripple = (1.0 - pedestal) / pedestal;
+
+  size = hyscan_signal_fill_begin (buffer, size, n_points);
+  hyscan_signal_generate_phase (buffer, n_points, size, hyscan_signal_phase_nlfm, &nlfm);
+
+  return n_points;
+}
+
+/**
+ * hyscan_signal_fill_barker:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @length: длина кода Баркера: 2, 3, 4, 5, 7, 11 или 13
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ сигнала, манипулированного по фазе кодом
+ * Баркера, в буфер пользователя (см. #hyscan_signal_image_barker).
+ *
+ * Returns: Размер образа сигнала в точках или 0 при недопустимой длине кода.
+ */
+guint32
+hyscan_signal_fill_barker (gdouble             disc_freq,
+                           gdouble             signal_freq,
+                           gdouble             chip_duration,
+                           guint               length,
+                           HyScanComplexFloat *buffer,
+                           guint32             size)
+{
+  gint8 code[G_N_ELEMENTS (hyscan_signal_barker_codes)];
   guint i;
 
-  bandwidth = end_frequency - start_frequency;
-  *n_points = duration * discretization_freq;
-  image = g_new0 (HyScanComplexFloat, *n_points);
+  if ((length >= G_N_ELEMENTS (hyscan_signal_barker_codes)) || (hyscan_signal_barker_codes[length] == NULL))
+    {
+      g_warning ("HyScanSignal: unsupported Barker code length %u", length);
+      return 0;
+    }
+
+  for (i = 0; i < length; i++)
+    code[i] = (hyscan_signal_barker_codes[length][i] == '+') ? 1 : -1;
 
-  for (i = 0; i < *n_points; i++)
+  return hyscan_signal_fill_code (disc_freq, signal_freq, chip_duration, code, length, buffer, size);
+}
+
+/**
+ * hyscan_signal_fill_mseq:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @signal_freq: несущая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @degree: степень M-последовательности, от 2 до 16
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ сигнала, манипулированного по фазе
+ * M-последовательностью, в буфер пользователя (см. #hyscan_signal_image_mseq).
+ *
+ * Returns: Размер образа сигнала в точках или 0 при недопустимой степени.
+ */
+guint32
+hyscan_signal_fill_mseq (gdouble             disc_freq,
+                         gdouble             signal_freq,
+                         gdouble             chip_duration,
+                         guint               degree,
+                         HyScanComplexFloat *buffer,
+                         guint32             size)
+{
+  gint8 *code;
+  guint32 length;
+  guint32 n_points;
+  guint32 state = 1;
+  guint32 i;
+
+  if ((degree < 2) || (degree >= G_N_ELEMENTS (hyscan_signal_mseq_taps)))
+    {
+      g_warning ("HyScanSignal: unsupported m-sequence degree %u", degree);
+      return 0;
+    }
+
+  length = (1 << degree) - 1;
+  if (buffer == NULL)
+    return length * chip_duration * disc_freq;
+
+  /* Регистр сдвига с линейной обратной связью. */
+  code = g_new (gint8, length);
+  for (i = 0; i < length; i++)
     {
-      gdouble time = i * (1.0 / discretization_freq);
-      gdouble phase =  2.0 * G_PI * start_frequency * time + G_PI * bandwidth * time * time / duration;
+      guint32 feedback = state & hyscan_signal_mseq_taps[degree];
+
+      feedback ^= feedback >> 16;
+      feedback ^= feedback >> 8;
+      feedback ^= feedback >> 4;
+      feedback ^= feedback >> 2;
+      feedback ^= feedback >> 1;
 
-      image[i].re = cos (phase);
-      image[i].im = sin (phase);
+      code[i] = (state & 1) ? 1 : -1;
+      state = (state >> 1) | ((feedback & 1) << (degree - 1));
     }
 
-  return image;
+  n_points = hyscan_signal_fill_code (disc_freq, signal_freq, chip_duration, code, length, buffer, size);
+
+  g_free (code);
+
+  return n_points;
+}
+
+/**
+ * hyscan_signal_fill_costas:
+ * @disc_freq: частота дискретизации сигнала, Гц
+ * @start_freq: наименьшая частота сигнала, Гц
+ * @chip_duration: длительность элемента кода, с
+ * @order: число элементов кода, на единицу меньше простого числа
+ * @buffer: (nullable) (array length=size): буфер для образа сигнала
+ * @size: размер буфера в точках
+ *
+ * Функция расчитывает образ сигнала с частотной манипуляцией по коду
+ * Костаса в буфер пользователя (см. #hyscan_signal_image_costas).
+ *
+ * Returns: Размер образа сигнала в точках или 0 при недопустимом числе
+ *          элементов кода.
+ */
+guint32
+hyscan_signal_fill_costas (gdouble             disc_freq,
+                           gdouble             start_freq,
+                           gdouble             chip_duration,
+                           guint               order,
+                           HyScanComplexFloat *buffer,
+                           guint32             size)
+{
+  guint32 prime = order + 1;
+  guint32 n_points;
+  guint32 root, power;
+  guint32 start, end;
+  guint32 i;
+
+  /* Проверяем, что order + 1 - простое число. */
+  for (i = 2; i * i <= prime; i++)
+    {
+      if ((prime % i) == 0)
+        break;
+    }
+
+  if ((order < 2) || (i * i <= prime))
+    {
+      g_warning ("HyScanSignal: unsupported Costas code order %u", order);
+      return 0;
+    }
+
+  /* Первообразный корень: его степени от 1 до prime - 2 не равны единице. */
+  for (root = 2; root < prime; root++)
+    {
+      for (i = 1, power = root; i < prime - 1; i++, power = (power * root) % prime)
+        {
+          if (power == 1)
+            break;
+        }
+
+      if (i == prime - 1)
+        break;
+    }
+
+  n_points = order * chip_duration * disc_freq;
+  size = hyscan_signal_fill_begin (buffer, size, n_points);
+
+  for (i = 0, start = 0, power = 1; (i < order) && (start < size); i++, start = end, power = (power * root) % prime)
+    {
+      gdouble frequency = start_freq + (power - 1) / chip_duration;
+
+      end = MIN ((i + 1) * chip_duration * disc_freq, size);
+      hyscan_signal_generate (buffer + start, end - start, 2.0 * G_PI * frequency / disc_freq, 0.0);
+    }
+
+  return n_points;
 }
@@ -52,6 +52,115 @@ HyScanComplexFloat    *hyscan_signal_image_lfm         (gdouble                d
                                                         gdouble                duration,
                                                         guint                 *n_points);
 
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_lfm_doppler (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                doppler,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_hfm         (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_nlfm        (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                pedestal,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_barker      (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  length,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_mseq        (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  degree,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+HyScanComplexFloat    *hyscan_signal_image_costas      (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  order,
+                                                        guint                 *n_points);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_tone         (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                duration,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_lfm          (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_lfm_doppler  (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                doppler,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_hfm          (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_nlfm         (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                end_freq,
+                                                        gdouble                duration,
+                                                        gdouble                pedestal,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_barker       (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  length,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_mseq         (gdouble                disc_freq,
+                                                        gdouble                signal_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  degree,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
+HYSCAN_API
+guint32                hyscan_signal_fill_costas       (gdouble                disc_freq,
+                                                        gdouble                start_freq,
+                                                        gdouble                chip_duration,
+                                                        guint                  order,
+                                                        HyScanComplexFloat    *buffer,
+                                                        guint32                size);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_SIGNAL_H__ */
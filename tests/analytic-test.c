@@ -0,0 +1,178 @@
+/* analytic-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include <hyscan-analytic.h>
+#include <hyscan-fft.h>
+#include <math.h>
+
+#define        N_POINTS        3000
+#define        N_STREAM        100000
+#define        MAX_PART        5000
+#define        MAX_ERROR       (1e-4)
+#define        MAX_STREAM_ERROR (1e-3)
+
+/* Функция рассчитывает аналитический сигнал прямым расчётом ДПФ. */
+static void
+analytic_reference (const gfloat *data,
+                    gdouble      *output,
+                    guint32       n_points,
+                    guint32       fft_size)
+{
+  gdouble *cos_table = g_new (gdouble, fft_size);
+  gdouble *sin_table = g_new (gdouble, fft_size);
+  gdouble *spectrum = g_new0 (gdouble, fft_size + 2);
+  guint32 k, n;
+
+  for (k = 0; k < fft_size; k++)
+    {
+      cos_table[k] = cos (2.0 * G_PI * k / fft_size);
+      sin_table[k] = sin (2.0 * G_PI * k / fft_size);
+    }
+
+  /* Спектр положительных частот с учётом удвоения. */
+  for (k = 0; k <= fft_size / 2; k++)
+    {
+      gdouble re = 0.0, im = 0.0;
+      gdouble scale = (k == 0 || k == fft_size / 2) ? 1.0 : 2.0;
+
+      for (n = 0; n < n_points; n++)
+        {
+          guint32 index = ((guint64) k * n) % fft_size;
+
+          re += data[n] * cos_table[index];
+          im -= data[n] * sin_table[index];
+        }
+
+      spectrum[2 * k] = scale * re / fft_size;
+      spectrum[2 * k + 1] = scale * im / fft_size;
+    }
+
+  for (n = 0; n < n_points; n++)
+    {
+      gdouble re = 0.0, im = 0.0;
+
+      for (k = 0; k <= fft_size / 2; k++)
+        {
+          guint32 index = ((guint64) k * n) % fft_size;
+
+          re += spectrum[2 * k] * cos_table[index] - spectrum[2 * k + 1] * sin_table[index];
+          im += spectrum[2 * k] * sin_table[index] + spectrum[2 * k + 1] * cos_table[index];
+        }
+
+      output[2 * n] = re;
+      output[2 * n + 1] = im;
+    }
+
+  g_free (cos_table);
+  g_free (sin_table);
+  g_free (spectrum);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanComplexFloat *output;
+  HyScanAnalytic *analytic;
+  gdouble *reference;
+  gfloat *data;
+  gdouble max_error = 0.0;
+  gdouble max_value = 0.0;
+  gdouble frequency = 0.1;
+  guint32 delay;
+  guint32 start, n;
+
+  g_random_set_seed (1);
+
+  analytic = hyscan_analytic_new ();
+
+  /* Строка целиком. */
+  data = g_new (gfloat, N_STREAM);
+  output = g_new (HyScanComplexFloat, N_STREAM);
+  reference = g_new (gdouble, 2 * N_POINTS);
+
+  for (n = 0; n < N_POINTS; n++)
+    data[n] = g_random_double_range (-1.0, 1.0);
+
+  if (!hyscan_analytic_transform (analytic, data, output, N_POINTS))
+    g_error ("can't transform line");
+
+  analytic_reference (data, reference, N_POINTS, hyscan_fft_get_transform_size (N_POINTS));
+
+  for (n = 0; n < N_POINTS; n++)
+    {
+      max_error = MAX (max_error, hypot (output[n].re - reference[2 * n], output[n].im - reference[2 * n + 1]));
+      max_value = MAX (max_value, hypot (reference[2 * n], reference[2 * n + 1]));
+    }
+
+  g_print ("line error %.2e\n", max_error / max_value);
+  if (max_error / max_value > MAX_ERROR)
+    g_error ("line error too big");
+
+  /* Поток данных частями случайного размера. */
+  for (n = 0; n < N_STREAM; n++)
+    data[n] = cos (2.0 * G_PI * frequency * n);
+
+  for (start = 0; start < N_STREAM; start += n)
+    {
+      n = g_random_int_range (1, MAX_PART);
+      n = MIN (n, N_STREAM - start);
+
+      if (!hyscan_analytic_process (analytic, data + start, output + start, n))
+        g_error ("can't process stream");
+    }
+
+  delay = hyscan_analytic_get_delay (analytic);
+  max_error = 0.0;
+
+  for (n = 2 * delay; n < N_STREAM; n++)
+    {
+      gdouble phase = 2.0 * G_PI * frequency * (n - (gdouble) delay);
+
+      max_error = MAX (max_error, hypot (output[n].re - cos (phase), output[n].im - sin (phase)));
+    }
+
+  g_print ("stream delay %u, error %.2e\n", delay, max_error);
+  if (max_error > MAX_STREAM_ERROR)
+    g_error ("stream error too big");
+
+  g_object_unref (analytic);
+
+  g_free (data);
+  g_free (output);
+  g_free (reference);
+
+  return 0;
+}
@@ -0,0 +1,176 @@
+/* channelizer-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include <hyscan-channelizer.h>
+#include <math.h>
+
+#define        N_POINTS        100000
+#define        MAX_PART        5000
+#define        N_TAPS          16
+#define        MAX_ERROR       (1e-3)
+
+/* Смещение частоты тона от центральной частоты канала относительно
+ * частоты дискретизации канала. */
+static gdouble
+channel_offset (guint channel)
+{
+  return 0.25 * sin (channel + 1.0);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint n_channels[] = {2, 3, 16, 16, 60, 64};
+  guint selected[] = {1, 5, 11};
+  HyScanComplexFloat *input;
+  HyScanComplexFloat **output;
+  HyScanChannelizer *channelizer;
+  guint i, k, s;
+
+  g_random_set_seed (1);
+
+  input = g_new (HyScanComplexFloat, N_POINTS);
+  output = g_new (HyScanComplexFloat *, 64);
+  for (k = 0; k < 64; k++)
+    output[k] = g_new (HyScanComplexFloat, N_POINTS);
+
+  channelizer = hyscan_channelizer_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (n_channels); i++)
+    {
+      guint M = n_channels[i];
+      guint n_selected = M;
+      gdouble max_error = 0.0;
+      guint32 start, n, n_out;
+      GTimer *timer;
+      gdouble time;
+      gdouble delay;
+
+      if (!hyscan_channelizer_configure (channelizer, M, N_TAPS))
+        g_error ("can't configure channelizer");
+
+      /* Во втором варианте с 16 каналами рассчитываются только выбранные. */
+      if ((i > 0) && (n_channels[i - 1] == M))
+        {
+          n_selected = G_N_ELEMENTS (selected);
+          if (!hyscan_channelizer_set_channels (channelizer, selected, n_selected))
+            g_error ("can't select channels");
+        }
+
+      delay = hyscan_channelizer_get_delay (channelizer);
+
+      /* Тоны во всех каналах. */
+      for (n = 0; n < N_POINTS; n++)
+        {
+          input[n].re = 0.0;
+          input[n].im = 0.0;
+
+          for (k = 0; k < M; k++)
+            {
+              gdouble frequency = (k + channel_offset (k)) / M;
+
+              input[n].re += cos (2.0 * G_PI * frequency * n);
+              input[n].im += sin (2.0 * G_PI * frequency * n);
+            }
+        }
+
+      /* Обработка частями случайного размера. */
+      for (start = 0, n_out = 0; start < N_POINTS; start += n)
+        {
+          HyScanComplexFloat *parts[64];
+          guint32 n_expected;
+          guint32 n_processed;
+
+          n = g_random_int_range (1, MAX_PART);
+          n = MIN (n, N_POINTS - start);
+
+          for (s = 0; s < n_selected; s++)
+            parts[s] = output[s] + n_out;
+
+          n_expected = hyscan_channelizer_get_output_size (channelizer, n);
+          n_processed = hyscan_channelizer_process (channelizer, input + start, n, parts);
+
+          if (n_processed != n_expected)
+            g_error ("output size mismatch: %u, expected %u", n_processed, n_expected);
+
+          n_out += n_processed;
+        }
+
+      if (n_out != (N_POINTS - 1) / M + 1)
+        g_error ("wrong output size %u", n_out);
+
+      /* Пропускаем переходный процесс фильтра. */
+      for (s = 0; s < n_selected; s++)
+        {
+          guint channel = (n_selected == M) ? s : selected[s];
+          gdouble offset = channel_offset (channel);
+
+          for (n = 2.0 * delay + 1.0; n < n_out; n++)
+            {
+              gdouble phase = 2.0 * G_PI * offset * (n - delay);
+              gdouble error;
+
+              error = hypot (output[s][n].re - cos (phase), output[s][n].im - sin (phase));
+              max_error = MAX (max_error, error);
+            }
+        }
+
+      hyscan_channelizer_reset (channelizer);
+
+      timer = g_timer_new ();
+      n = hyscan_channelizer_process (channelizer, input, N_POINTS, output);
+      time = g_timer_elapsed (timer, NULL);
+      g_timer_destroy (timer);
+
+      if (n != n_out)
+        g_error ("whole output size mismatch: %u, expected %u", n, n_out);
+
+      g_print ("%u channels, %u selected: delay %.2f, error %.2e, %.1f Msamples/s\n",
+               M, n_selected, delay, max_error, N_POINTS / time * 1e-6);
+
+      if (max_error > MAX_ERROR)
+        g_error ("output error too big");
+    }
+
+  g_object_unref (channelizer);
+
+  g_free (input);
+  for (k = 0; k < 64; k++)
+    g_free (output[k]);
+  g_free (output);
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+/* convolution-2d-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-convolution-2d.h>
+#include <math.h>
+
+#define        MAX_ERROR       (1e-4)
+
+/* Функция выполняет свёртку или корреляцию прямым способом. */
+static void
+convolution_2d_direct (const gfloat *input,
+                       gfloat       *output,
+                       guint32       width,
+                       guint32       height,
+                       const gfloat *kernel,
+                       guint32       kernel_width,
+                       guint32       kernel_height,
+                       gboolean      correlation)
+{
+  gint x, y, i, j;
+
+  for (y = 0; y < (gint) height; y++)
+    for (x = 0; x < (gint) width; x++)
+      {
+        gdouble sum = 0.0;
+
+        for (j = 0; j < (gint) kernel_height; j++)
+          for (i = 0; i < (gint) kernel_width; i++)
+            {
+              gint sx, sy;
+
+              if (correlation)
+                {
+                  sx = x + i - (gint) kernel_width / 2;
+                  sy = y + j - (gint) kernel_height / 2;
+                }
+              else
+                {
+                  sx = x + (gint) kernel_width / 2 - i;
+                  sy = y + (gint) kernel_height / 2 - j;
+                }
+
+              if ((sx >= 0) && (sx < (gint) width) && (sy >= 0) && (sy < (gint) height))
+                sum += kernel[j * kernel_width + i] * input[sy * width + sx];
+            }
+
+        output[y * width + x] = sum;
+      }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanConvolution2D *convolution;
+  GRand *rand;
+  guint n;
+
+  /* Размеры изображения и ядра: ширина и высота. */
+  guint32 sizes[][4] = { {  64,  48,  3,  3 },
+                         { 100, 200,  4,  7 },
+                         { 333,  97, 15, 15 },
+                         { 257, 129, 31, 17 },
+                         {  40,  30, 33, 21 },
+                         {   1, 300,  1, 45 } };
+
+  convolution = hyscan_convolution_2d_new ();
+  rand = g_rand_new_with_seed (1);
+
+  for (n = 0; n < 2 * G_N_ELEMENTS (sizes); n++)
+    {
+      guint32 width = sizes[n / 2][0];
+      guint32 height = sizes[n / 2][1];
+      guint32 kernel_width = sizes[n / 2][2];
+      guint32 kernel_height = sizes[n / 2][3];
+      gboolean correlation = (n % 2) == 1;
+      guint32 tile_width, tile_height;
+      gfloat *input, *output, *kernel, *reference;
+      gdouble max_value = 0.0;
+      gdouble max_error = 0.0;
+      guint32 i;
+
+      input = g_new (gfloat, width * height);
+      output = g_new (gfloat, width * height);
+      reference = g_new (gfloat, width * height);
+      kernel = g_new (gfloat, kernel_width * kernel_height);
+
+      for (i = 0; i < width * height; i++)
+        input[i] = g_rand_double_range (rand, -1.0, 1.0);
+      for (i = 0; i < kernel_width * kernel_height; i++)
+        kernel[i] = g_rand_double_range (rand, -1.0, 1.0);
+
+      if (!hyscan_convolution_2d_set_kernel (convolution, kernel, kernel_width, kernel_height, correlation))
+        g_error ("can't set kernel %ux%u", kernel_width, kernel_height);
+
+      if (!hyscan_convolution_2d_convolve (convolution, input, output, width, height))
+        g_error ("can't convolve image %ux%u", width, height);
+
+      convolution_2d_direct (input, reference, width, height,
+                             kernel, kernel_width, kernel_height, correlation);
+
+      for (i = 0; i < width * height; i++)
+        {
+          max_value = MAX (max_value, fabs (reference[i]));
+          max_error = MAX (max_error, fabs (reference[i] - output[i]));
+        }
+
+      hyscan_convolution_2d_get_tile_size (convolution, &tile_width, &tile_height);
+      g_print ("%s image %ux%u, kernel %ux%u, tile %ux%u: error %.2e\n",
+               correlation ? "correlation" : "convolution",
+               width, height, kernel_width, kernel_height,
+               tile_width, tile_height, max_error / max_value);
+
+      if (max_error > MAX_ERROR * max_value)
+        g_error ("convolution error %.2e", max_error / max_value);
+
+      g_free (input);
+      g_free (output);
+      g_free (reference);
+      g_free (kernel);
+    }
+
+  g_object_unref (convolution);
+  g_rand_free (rand);
+
+  g_message ("done");
+
+  return 0;
+}
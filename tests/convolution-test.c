@@ -1,10 +1,457 @@
 #include <hyscan-convolution.h>
 #include <hyscan-signal.h>
+#include "pffft.h"
 
 #include <glib/gstdio.h>
 #include <string.h>
 #include <math.h>
 
+/* Функция измеряет скорость обработки блоков свёртки размером fft_size.
+ * Каждый блок проходит прямое преобразование Фурье, перемножение с образом
+ * и обратное преобразование. Если reorder равен TRUE, используется прежний
+ * способ обратного преобразования: спектр приводится к обычному порядку
+ * и обрабатывается упорядоченным преобразованием. Иначе спектр во
+ * внутреннем порядке PFFFT обрабатывается неупорядоченным преобразованием,
+ * как это делает HyScanConvolution. Функция возвращает число блоков в
+ * секунду. */
+static gdouble
+convolution_benchmark_run (guint32  fft_size,
+                           gboolean reorder)
+{
+  PFFFT_Setup *fft;
+  HyScanComplexFloat *image;
+  HyScanComplexFloat *data;
+  HyScanComplexFloat *forward;
+  HyScanComplexFloat *spectrum;
+  HyScanComplexFloat *work;
+  GTimer *timer;
+  guint n_blocks = 64;
+  guint n_iterations;
+  gdouble elapsed;
+  guint32 i;
+
+  fft = pffft_new_setup (fft_size, PFFFT_COMPLEX);
+  image = pffft_aligned_malloc (fft_size * sizeof (HyScanComplexFloat));
+  data = pffft_aligned_malloc (n_blocks * fft_size * sizeof (HyScanComplexFloat));
+  forward = pffft_aligned_malloc (fft_size * sizeof (HyScanComplexFloat));
+  spectrum = pffft_aligned_malloc (fft_size * sizeof (HyScanComplexFloat));
+  work = pffft_aligned_malloc (fft_size * sizeof (HyScanComplexFloat));
+
+  for (i = 0; i < fft_size; i++)
+    {
+      image[i].re = (i < fft_size / 2) ? cos (0.1 * i) : 0.0;
+      image[i].im = (i < fft_size / 2) ? sin (0.1 * i) : 0.0;
+    }
+  for (i = 0; i < n_blocks * fft_size; i++)
+    {
+      data[i].re = sin (0.01 * i);
+      data[i].im = cos (0.01 * i);
+    }
+
+  pffft_transform (fft, (gfloat *) image, (gfloat *) image, (gfloat *) work, PFFFT_FORWARD);
+
+  /* Выполняем обработку не менее 0.2 секунды. */
+  timer = g_timer_new ();
+  n_iterations = 0;
+  do
+    {
+      for (i = 0; i < n_blocks; i++)
+        {
+          HyScanComplexFloat *block = data + i * fft_size;
+
+          /* Данные не изменяются, чтобы их значения были одинаковыми на
+           * всех итерациях. */
+          pffft_transform (fft, (gfloat *) block, (gfloat *) forward, (gfloat *) work, PFFFT_FORWARD);
+
+          memset (spectrum, 0, fft_size * sizeof (HyScanComplexFloat));
+          pffft_zconvolve_accumulate (fft, (gfloat *) forward, (gfloat *) image, (gfloat *) spectrum, 1.0f / fft_size);
+
+          if (reorder)
+            {
+              pffft_zreorder (fft, (gfloat *) spectrum, (gfloat *) forward, PFFFT_FORWARD);
+              pffft_transform_ordered (fft, (gfloat *) forward, (gfloat *) forward, (gfloat *) work, PFFFT_BACKWARD);
+            }
+          else
+            {
+              pffft_transform (fft, (gfloat *) spectrum, (gfloat *) forward, (gfloat *) work, PFFFT_BACKWARD);
+            }
+        }
+
+      n_iterations += 1;
+      elapsed = g_timer_elapsed (timer, NULL);
+    }
+  while (elapsed < 0.2);
+
+  g_timer_destroy (timer);
+  pffft_aligned_free (image);
+  pffft_aligned_free (data);
+  pffft_aligned_free (forward);
+  pffft_aligned_free (spectrum);
+  pffft_aligned_free (work);
+  pffft_destroy_setup (fft);
+
+  return n_iterations * n_blocks / elapsed;
+}
+
+/* Функция измеряет скорость обработки блоков свёртки прежним и текущим
+ * способом обратного преобразования для всех размеров FFT преобразования
+ * вплоть до max_fft_size. */
+static void
+convolution_benchmark (guint32 max_fft_size)
+{
+  guint32 fft_size;
+
+  for (fft_size = hyscan_convolution_get_fft_size (1);
+       (fft_size > 0) && (fft_size <= max_fft_size);
+       fft_size = hyscan_convolution_get_fft_size (fft_size + 1))
+    {
+      gdouble before = convolution_benchmark_run (fft_size, TRUE);
+      gdouble after = convolution_benchmark_run (fft_size, FALSE);
+
+      g_print ("fft size %7u: before %12.0f blocks/s, after %12.0f blocks/s, x%.2f\n",
+               fft_size, before, after, after / before);
+    }
+}
+
+/* Функция вычисляет свёртку (взаимную корреляцию) данных с образом прямым
+ * способом: y[n] = scale / M * sum (x[n + k] * conj (h[k])). Если real равен
+ * TRUE, используется только действительная часть данных. */
+static HyScanComplexFloat *
+convolution_direct (const HyScanComplexFloat *data,
+                    guint32                   data_size,
+                    const HyScanComplexFloat *image,
+                    guint32                   image_size,
+                    gboolean                  real,
+                    gdouble                   scale)
+{
+  HyScanComplexFloat *result = g_new (HyScanComplexFloat, data_size);
+  guint32 i, j;
+
+  for (i = 0; i < data_size; i++)
+    {
+      gdouble re = 0.0;
+      gdouble im = 0.0;
+
+      for (j = 0; (j < image_size) && (i + j < data_size); j++)
+        {
+          gdouble data_re = data[i + j].re;
+          gdouble data_im = real ? 0.0 : data[i + j].im;
+
+          re += data_re * image[j].re + data_im * image[j].im;
+          im += data_im * image[j].re - data_re * image[j].im;
+        }
+
+      result[i].re = scale * re / image_size;
+      result[i].im = scale * im / image_size;
+    }
+
+  return result;
+}
+
+/* Асинхронное задание свёртки. */
+typedef struct
+{
+  guint  job;
+  guint *n_done;
+} ConvolutionAsyncJob;
+
+/* Функция проверяет порядок завершения асинхронных заданий свёртки. */
+static void
+convolution_async_ready (GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+  ConvolutionAsyncJob *job = user_data;
+  GError *error = NULL;
+
+  if (!hyscan_convolution_convolve_finish (HYSCAN_CONVOLUTION (source), result, &error))
+    g_error ("async convolution error: %s", error->message);
+
+  if (job->job != *job->n_done)
+    g_error ("async convolution order mismatch");
+
+  *job->n_done += 1;
+}
+
+/* Функция добавляет к данным копию ЛЧМ сигнала с задержкой delay отсчётов
+ * и амплитудой amplitude. Задержка может быть дробной. Если data равен
+ * NULL, функция только рассчитывает отсчёты сигнала в массиве image. Частота
+ * сигнала меняется от -0.1 до 0.1 частоты дискретизации (или наоборот, если
+ * down равен TRUE). */
+static void
+convolution_peaks_signal (HyScanComplexFloat *data,
+                          guint32             data_size,
+                          guint32             image_size,
+                          gdouble             delay,
+                          gdouble             amplitude,
+                          gboolean            down)
+{
+  gdouble rate = (down ? -0.2 : 0.2) / image_size;
+  gdouble start = down ? 0.1 : -0.1;
+  guint32 i;
+
+  for (i = 0; i < data_size; i++)
+    {
+      gdouble time = i - delay;
+      gdouble phase;
+
+      if ((time < 0.0) || (time >= image_size))
+        continue;
+
+      phase = 2.0 * G_PI * (start * time + 0.5 * rate * time * time);
+      data[i].re += amplitude * cos (phase);
+      data[i].im += amplitude * sin (phase);
+    }
+}
+
+/* Функция сравнивает пики. Структура пика содержит выравнивание, поэтому
+ * сравниваются её поля. */
+static gboolean
+convolution_peaks_equal (const HyScanConvolutionPeak *peaks1,
+                         const HyScanConvolutionPeak *peaks2,
+                         guint                        n_peaks)
+{
+  guint i;
+
+  for (i = 0; i < n_peaks; i++)
+    {
+      if ((peaks1[i].offset != peaks2[i].offset) || (peaks1[i].amplitude != peaks2[i].amplitude))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Функция проверяет пик, найденный функцией hyscan_convolution_find_peaks.
+ * Допустимая ошибка амплитуды пропорциональна допустимой ошибке положения. */
+static void
+convolution_peaks_expect (const HyScanConvolutionPeak *peak,
+                          gdouble                      offset,
+                          gdouble                      amplitude,
+                          gdouble                      tolerance,
+                          const gchar                 *name)
+{
+  if ((fabs (peak->offset - offset) > tolerance) || (fabs (peak->amplitude - amplitude) > 0.2 * tolerance))
+    {
+      g_error ("%s: wrong peak %.4f (%.4f), expected %.4f (%.4f)",
+               name, peak->offset, peak->amplitude, offset, amplitude);
+    }
+}
+
+/* Функция проверяет поиск пиков свёртки: точность уточнения положения пика
+ * при дробной задержке сигнала, пики на границах блоков, в начале и конце
+ * строки, близко расположенные пики и пакетный поиск. Образ разбивает
+ * строку на несколько блоков, шаг между которыми определяется функцией
+ * hyscan_convolution_get_optimal_fft_size. */
+static void
+convolution_peaks_check (void)
+{
+  const guint32 image_size = 1000;
+  const guint32 max_fft_size = 4096;
+  const guint32 n_points = 16384;
+  const gdouble tolerance = 0.02;
+
+  const gdouble fractions[] = { 0.0, 0.13, 0.25, 0.37, 0.5, 0.62, 0.81, 0.97 };
+  const HyScanConvolutionPeakInterpolation modes[] = { HYSCAN_CONVOLUTION_PEAK_GAUSSIAN,
+                                                       HYSCAN_CONVOLUTION_PEAK_PARABOLIC };
+
+  HyScanConvolution *convolution;
+  HyScanConvolutionPeak peaks[12];
+  HyScanConvolutionPeak single[4];
+  HyScanComplexFloat *image;
+  HyScanComplexFloat *lines[3];
+  guint indexes[3] = { 0, 1, 0 };
+  gdouble max_error = 0.0;
+  guint n_found[3];
+  guint32 hop_size;
+  guint32 line_size;
+  guint i, j, k;
+
+  convolution = hyscan_convolution_new ();
+  hyscan_convolution_set_max_fft_size (convolution, max_fft_size);
+  hyscan_convolution_get_optimal_fft_size (image_size, n_points, max_fft_size, &hop_size);
+
+  /* Образы ЛЧМ сигналов с возрастающей и убывающей частотой. */
+  image = g_new0 (HyScanComplexFloat, image_size);
+  convolution_peaks_signal (image, image_size, image_size, 0.0, 1.0, FALSE);
+  hyscan_convolution_set_image_td (convolution, 0, image, image_size);
+  memset (image, 0, image_size * sizeof (HyScanComplexFloat));
+  convolution_peaks_signal (image, image_size, image_size, 0.0, 1.0, TRUE);
+  hyscan_convolution_set_image_td (convolution, 1, image, image_size);
+
+  for (i = 0; i < 3; i++)
+    lines[i] = g_new0 (HyScanComplexFloat, n_points);
+
+  /* Дробная задержка сигнала. Пик располагается внутри блока, в начале и
+     в конце блока. */
+  for (i = 0; i < G_N_ELEMENTS (fractions); i++)
+    {
+      gdouble delays[3] = { 5000.0, 2 * hop_size, 3 * hop_size - 1 };
+
+      for (j = 0; j < G_N_ELEMENTS (delays); j++)
+        {
+          gdouble delay = delays[j] + fractions[i];
+
+          memset (lines[0], 0, n_points * sizeof (HyScanComplexFloat));
+          convolution_peaks_signal (lines[0], n_points, image_size, delay, 1.0, FALSE);
+
+          for (k = 0; k < G_N_ELEMENTS (modes); k++)
+            {
+              if (!hyscan_convolution_find_peaks (convolution, 0, lines[0], n_points, 1.0, modes[k],
+                                                  peaks, 1, n_found))
+                {
+                  g_error ("can't find peaks");
+                }
+
+              if (n_found[0] != 1)
+                g_error ("fractional peak not found");
+
+              convolution_peaks_expect (&peaks[0], delay, 1.0, tolerance, "fractional");
+              max_error = MAX (max_error, fabs (peaks[0].offset - delay));
+            }
+        }
+    }
+
+  g_message ("fractional peak error %.4f", max_error);
+
+  /* Пики в начале и в конце блоков, а также соседние пики по разные
+     стороны границы блока. Боковые лепестки соседних пиков смещают их
+     друг относительно друга, поэтому для них допустимая ошибка больше.
+     Пики должны быть упорядочены по убыванию амплитуды, при ограничении
+     их числа остаются наибольшие. */
+  {
+    gdouble delays[5] = { hop_size, 2 * hop_size - 1, 3 * hop_size - 20, 3 * hop_size + 20, 4 * hop_size + 100 };
+    gdouble amplitudes[5] = { 0.6, 0.9, 1.0, 0.8, 0.7 };
+    guint order[5] = { 2, 1, 3, 4, 0 };
+
+    memset (lines[0], 0, n_points * sizeof (HyScanComplexFloat));
+    for (i = 0; i < 5; i++)
+      convolution_peaks_signal (lines[0], n_points, image_size, delays[i], amplitudes[i], FALSE);
+
+    for (i = 0; i < G_N_ELEMENTS (modes); i++)
+      {
+        if (!hyscan_convolution_find_peaks (convolution, 0, lines[0], n_points, 1.0, modes[i],
+                                            peaks, 5, n_found))
+          {
+            g_error ("can't find peaks");
+          }
+
+        if (n_found[0] != 5)
+          g_error ("boundary peaks: found %u peaks", n_found[0]);
+
+        for (j = 0; j < 5; j++)
+          {
+            gboolean pair = (order[j] == 2) || (order[j] == 3);
+
+            convolution_peaks_expect (&peaks[j], delays[order[j]], amplitudes[order[j]],
+                                      pair ? 0.25 : tolerance, "boundary");
+          }
+
+        if (!hyscan_convolution_find_peaks (convolution, 0, lines[0], n_points, 1.0, modes[i],
+                                            single, 2, n_found))
+          {
+            g_error ("can't find peaks");
+          }
+
+        if ((n_found[0] != 2) || !convolution_peaks_equal (single, peaks, 2))
+          g_error ("boundary peaks: wrong largest peaks");
+      }
+  }
+
+  /* Пики в крайних отсчётах строки не ищутся: у них нет одного из соседних
+     отсчётов. Для проверки используется образ из одного отсчёта, с которым
+     результат свёртки совпадает с данными. Строка состоит из двух полных
+     блоков и последнего блока из одного отсчёта. Пик в предпоследнем
+     отсчёте находится на границе блоков. */
+  {
+    HyScanComplexFloat impulse = { 1.0, 0.0 };
+    gdouble positions[4];
+    gboolean found[4] = { FALSE, TRUE, TRUE, FALSE };
+
+    hyscan_convolution_set_image_td (convolution, 2, &impulse, 1);
+    hyscan_convolution_get_optimal_fft_size (1, n_points, max_fft_size, &hop_size);
+    line_size = 2 * hop_size + 1;
+
+    positions[0] = 0;
+    positions[1] = 1;
+    positions[2] = line_size - 2;
+    positions[3] = line_size - 1;
+
+    for (i = 0; i < 4; i++)
+      {
+        guint32 position = positions[i];
+
+        memset (lines[0], 0, n_points * sizeof (HyScanComplexFloat));
+        lines[0][position].re = 1.0;
+        if (position > 0)
+          lines[0][position - 1].re = 0.5;
+        if (position + 1 < line_size)
+          lines[0][position + 1].re = 0.5;
+
+        if (!hyscan_convolution_find_peaks (convolution, 2, lines[0], line_size, 1.0,
+                                            HYSCAN_CONVOLUTION_PEAK_PARABOLIC, peaks, 1, n_found))
+          {
+            g_error ("can't find peaks");
+          }
+
+        /* Вне пика результат свёртки содержит только шум округления. */
+        if (found[i])
+          {
+            if (n_found[0] != 1)
+              g_error ("edge peaks: peak at %u not found", position);
+
+            convolution_peaks_expect (&peaks[0], position, 1.0, tolerance, "edge");
+          }
+        else if ((n_found[0] > 0) && (peaks[0].amplitude > 1e-3))
+          {
+            g_error ("edge peaks: peak at %.3f found", peaks[0].offset);
+          }
+      }
+  }
+
+  /* Пакетный поиск пиков совпадает с поиском в каждой строке отдельно. */
+  {
+    gdouble delays[3] = { 3000.25, 7000.5, 2 * hop_size + 0.75 };
+
+    for (i = 0; i < 3; i++)
+      {
+        memset (lines[i], 0, n_points * sizeof (HyScanComplexFloat));
+        convolution_peaks_signal (lines[i], n_points, image_size, delays[i], 1.0, indexes[i] == 1);
+      }
+
+    if (!hyscan_convolution_find_peaks_batch (convolution, indexes, (const HyScanComplexFloat * const *) lines,
+                                              3, n_points, 1.0, HYSCAN_CONVOLUTION_PEAK_GAUSSIAN,
+                                              peaks, 4, n_found))
+      {
+        g_error ("can't find peaks batch");
+      }
+
+    for (i = 0; i < 3; i++)
+      {
+        guint n_single;
+
+        if (!hyscan_convolution_find_peaks (convolution, indexes[i], lines[i], n_points, 1.0,
+                                            HYSCAN_CONVOLUTION_PEAK_GAUSSIAN, single, 4, &n_single))
+          {
+            g_error ("can't find peaks");
+          }
+
+        if ((n_found[i] != n_single) ||
+            !convolution_peaks_equal (peaks + 4 * i, single, n_single))
+          {
+            g_error ("batch peaks mismatch in line %u", i);
+          }
+
+        convolution_peaks_expect (&peaks[4 * i], delays[i], 1.0, tolerance, "batch");
+      }
+  }
+
+  g_object_unref (convolution);
+  g_free (image);
+  for (i = 0; i < 3; i++)
+    g_free (lines[i]);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -15,14 +462,28 @@ main (int    argc,
   gdouble discretization = 0.0;   /* Частота дискретизации. */
   gdouble conv_scale = 1.0;       /* Коэффициент масштабирования свёртки. */
   gdouble conv_error = 1.0;       /* Допустимая ошибка. */
+  guint max_fft_size = 0;         /* Максимальный размер FFT преобразования. */
+  gboolean real = FALSE;          /* Свёртка действительных данных. */
+  gboolean shared = FALSE;        /* Использовать общий образ свёртки. */
+  gboolean background = FALSE;    /* Подготовка образа в фоновом потоке. */
+  guint decimation = 1;           /* Коэффициент децимации. */
   gchar *signal = NULL;           /* Тип сигнала. */
+  gchar *output = NULL;           /* Тип результата свёртки. */
+  gboolean benchmark = FALSE;     /* Измерение скорости свёртки. */
+  gboolean reference = FALSE;     /* Сравнение с прямым вычислением свёртки. */
 
   HyScanConvolution *convolution;
   HyScanComplexFloat *image;
   HyScanComplexFloat *data;
+  HyScanComplexFloat *direct = NULL;
+  HyScanComplexFloat *decoy;
+  gfloat *real_data;
   gfloat *amplitude;
+  gfloat *envelope;
+  gdouble amplitude_scale;
   gdouble square1;
   gdouble square2;
+  gdouble peak_width = 0.0;
   guint image_size;
   guint data_size;
   guint i, j;
@@ -40,7 +501,15 @@ main (int    argc,
         { "duration", 't', 0, G_OPTION_ARG_DOUBLE, &duration, "Signal duration, s", NULL },
         { "scale", 'a', 0, G_OPTION_ARG_DOUBLE, &conv_scale, "Convolution scale", NULL },
         { "error", 'e', 0, G_OPTION_ARG_DOUBLE, &conv_error, "Admissible error, %", NULL },
-        { "signal", 's', 0, G_OPTION_ARG_STRING, &signal, "Signal type (tone, lfm)", NULL },
+        { "signal", 's', 0, G_OPTION_ARG_STRING, &signal, "Signal type (tone, lfm, hfm, nlfm, barker, mseq, costas)", NULL },
+        { "benchmark", 'b', 0, G_OPTION_ARG_NONE, &benchmark, "Benchmark convolution for all FFT sizes", NULL },
+        { "output", 'o', 0, G_OPTION_ARG_STRING, &output, "Output type (complex, out, gated, async, peaks, doppler, amplitude, db)", NULL },
+        { "max-fft-size", 'm', 0, G_OPTION_ARG_INT, &max_fft_size, "Maximum FFT size", NULL },
+        { "real", 'r', 0, G_OPTION_ARG_NONE, &real, "Convolve real part of data", NULL },
+        { "shared", 'p', 0, G_OPTION_ARG_NONE, &shared, "Use shared convolution image", NULL },
+        { "background", 'g', 0, G_OPTION_ARG_NONE, &background, "Prepare convolution image in background", NULL },
+        { "decimation", 'c', 0, G_OPTION_ARG_INT, &decimation, "Decimation factor", NULL },
+        { "reference", 'x', 0, G_OPTION_ARG_NONE, &reference, "Compare with direct convolution", NULL },
         { NULL }
       };
 
@@ -60,6 +529,12 @@ main (int    argc,
         return -1;
       }
 
+    if (benchmark)
+      {
+        convolution_benchmark ((max_fft_size > 0) ? max_fft_size : 65536);
+        return 0;
+      }
+
     if (signal == NULL)
       signal = g_strdup ("tone");
 
@@ -72,12 +547,18 @@ main (int    argc,
     if (bandwidth < 1.0)
       bandwidth = 0.2 * frequency;
 
+    if (decimation < 1)
+      decimation = 1;
+
     g_option_context_free (context);
     g_strfreev (args);
   }
 
   /* Объект выполнения свёртки. */
   convolution = hyscan_convolution_new ();
+  if (max_fft_size > 0)
+    hyscan_convolution_set_max_fft_size (convolution, max_fft_size);
+  hyscan_convolution_set_background_fft (convolution, background);
 
   /* Создаём образец сигнала для свёртки. */
   if (g_strcmp0 (signal, "tone") == 0)
@@ -95,6 +576,39 @@ main (int    argc,
                                        duration,
                                        &image_size);
     }
+  else if (g_strcmp0 (signal, "hfm") == 0)
+    {
+      image = hyscan_signal_image_hfm (discretization,
+                                       frequency - (bandwidth / 2.0),
+                                       frequency + (bandwidth / 2.0),
+                                       duration,
+                                       &image_size);
+      peak_width = 0.886 * discretization / bandwidth;
+    }
+  else if (g_strcmp0 (signal, "nlfm") == 0)
+    {
+      image = hyscan_signal_image_nlfm (discretization,
+                                        frequency - (bandwidth / 2.0),
+                                        frequency + (bandwidth / 2.0),
+                                        duration, 0.54,
+                                        &image_size);
+      peak_width = 1.30 * discretization / bandwidth;
+    }
+  else if (g_strcmp0 (signal, "barker") == 0)
+    {
+      image = hyscan_signal_image_barker (discretization, frequency, duration / 13, 13, &image_size);
+      peak_width = 0.586 * discretization * duration / 13;
+    }
+  else if (g_strcmp0 (signal, "mseq") == 0)
+    {
+      image = hyscan_signal_image_mseq (discretization, frequency, duration / 127, 7, &image_size);
+      peak_width = 0.586 * discretization * duration / 127;
+    }
+  else if (g_strcmp0 (signal, "costas") == 0)
+    {
+      image = hyscan_signal_image_costas (discretization, frequency - 50.0 / duration, duration / 10, 10, &image_size);
+      peak_width = 0.886 * discretization * duration / 100;
+    }
   else
     {
       g_error ("unsupported signal %s", signal);
@@ -106,14 +620,320 @@ main (int    argc,
   data_size = 4 * image_size;
   data = g_new0 (HyScanComplexFloat, data_size);
   amplitude = g_new0 (gfloat, data_size);
+  envelope = g_new0 (gfloat, data_size);
 
   /* Данные для свёртки. */
   for (i = 2 * image_size, j = 0; j < image_size; i++, j++)
     data[i] = image[j];
 
-  /* Выполняем свёртку. */
-  hyscan_convolution_set_image_td (convolution, 0, image, image_size);
-  hyscan_convolution_convolve (convolution, 0, data, data_size, conv_scale);
+  /* Результат прямого вычисления свёртки. Банк доплеровских образов
+     использует собственные образы, поэтому для него сравнение не
+     выполняется. */
+  if (reference && (g_strcmp0 (output, "doppler") != 0))
+    direct = convolution_direct (data, data_size, image, image_size, real, conv_scale);
+
+  /* Выполняем свёртку. Для действительных данных используем только
+     действительную часть сигнала, при этом амплитуда свёртки уменьшается
+     в два раза, т.к. с образом совпадает только положительная часть спектра. */
+  hyscan_convolution_set_image_td (convolution, 7, image, image_size);
+  decoy = g_new0 (HyScanComplexFloat, image_size);
+  if (shared)
+    {
+      HyScanConvolutionImage *fft_image;
+
+      fft_image = hyscan_convolution_image_new_td (image, image_size, max_fft_size);
+
+      /* При подготовке в фоновом потоке заменяем образы до завершения их
+         подготовки. Заменённые образы удаляются, их подготовка должна
+         отменяться или завершаться без ошибок. Иначе образ подготавливается
+         явно, до первой свёртки. */
+      if (background)
+        {
+          for (i = 0; i < 16; i++)
+            {
+              HyScanConvolutionImage *decoy_image;
+
+              decoy_image = hyscan_convolution_image_new_td (decoy, image_size, max_fft_size);
+              hyscan_convolution_set_image (convolution, 0, decoy_image);
+              g_object_unref (decoy_image);
+            }
+        }
+      else
+        {
+          if (hyscan_convolution_image_is_prepared (fft_image))
+            g_error ("image is prepared before use");
+
+          if (!hyscan_convolution_image_prepare (fft_image) ||
+              !hyscan_convolution_image_is_prepared (fft_image))
+            {
+              g_error ("can't prepare image");
+            }
+        }
+
+      /* Объект свёртки хранит собственную ссылку на образ. */
+      if (!hyscan_convolution_set_image (convolution, 0, fft_image))
+        g_error ("can't set shared image");
+
+      /* Ожидаем завершения подготовки образа в фоновом потоке. */
+      if (background)
+        {
+          for (i = 0; !hyscan_convolution_image_is_prepared (fft_image); i++)
+            {
+              if (i == 10000)
+                g_error ("image is not prepared in background");
+
+              g_usleep (1000);
+            }
+        }
+
+      g_object_unref (fft_image);
+    }
+  else
+    {
+      if (background)
+        {
+          for (i = 0; i < 16; i++)
+            hyscan_convolution_set_image_td (convolution, 0, decoy, image_size);
+        }
+
+      hyscan_convolution_set_image_td (convolution, 0, image, image_size);
+    }
+
+  /* Установка образа с номером 0 функцией hyscan_convolution_set_image_td
+     удаляет остальные образы, а функцией hyscan_convolution_set_image - нет. */
+  {
+    HyScanComplexFloat probe[64] = {{ 0 }};
+    gboolean exists;
+
+    exists = hyscan_convolution_convolve (convolution, 7, probe, 64, 1.0);
+    if (exists != shared)
+      g_error ("image 7 is %s after image 0 was set", exists ? "kept" : "removed");
+
+    hyscan_convolution_set_image_td (convolution, 7, NULL, 0);
+  }
+
+  if (real)
+    {
+      /* Выровненные данные: полные блоки преобразуются без копирования. */
+      real_data = pffft_aligned_malloc (data_size * sizeof (gfloat));
+      for (i = 0; i < data_size; i++)
+        real_data[i] = data[i].re;
+
+      hyscan_convolution_convolve_real (convolution, 0, real_data, data, data_size, conv_scale);
+      amplitude_scale = 0.5 * conv_scale;
+
+      pffft_aligned_free (real_data);
+    }
+  else if (decimation > 1)
+    {
+      /* Маска изменяет результат, поэтому при сравнении с прямым
+         вычислением свёртки она не используется. */
+      hyscan_convolution_convolve_decimate (convolution, 0, data, data, data_size,
+                                            decimation, (direct == NULL), conv_scale);
+      amplitude_scale = conv_scale;
+    }
+  else if (g_strcmp0 (output, "out") == 0)
+    {
+      HyScanComplexFloat *result = g_new0 (HyScanComplexFloat, data_size);
+
+      hyscan_convolution_convolve_out (convolution, 0, data, result, data_size, conv_scale);
+      memcpy (data, result, data_size * sizeof (HyScanComplexFloat));
+      amplitude_scale = conv_scale;
+
+      g_free (result);
+    }
+  else if (g_strcmp0 (output, "gated") == 0)
+    {
+      HyScanConvolutionGate gates[3];
+      HyScanComplexFloat *result;
+
+      /* Первый интервал охватывает весь отклик сигнала, вне его результат
+         свёртки равен нулю. Второй интервал расположен около пика и должен
+         совпадать с соответствующей частью первого. Третий интервал
+         находится в конце строки, отдельно от остальных. */
+      gates[0].start = image_size;
+      gates[0].end = 3 * image_size;
+      gates[1].start = 2 * image_size - 8;
+      gates[1].end = 2 * image_size + 8;
+      gates[2].start = data_size - 16;
+      gates[2].end = data_size;
+
+      result = g_new0 (HyScanComplexFloat, 2 * image_size + 32);
+      if (!hyscan_convolution_convolve_gated (convolution, 0, data, data_size, gates, 3, result, conv_scale))
+        g_error ("can't convolve gated data");
+
+      for (i = 0; i < 16; i++)
+        {
+          HyScanComplexFloat *full = result + (image_size - 8 + i);
+          HyScanComplexFloat *gate = result + (2 * image_size + i);
+
+          if ((fabs (full->re - gate->re) > 1e-4 * conv_scale) || (fabs (full->im - gate->im) > 1e-4 * conv_scale))
+            g_error ("gated convolution mismatch at %u", 2 * image_size - 8 + i);
+        }
+
+      for (i = 0; (direct != NULL) && (i < 16); i++)
+        {
+          HyScanComplexFloat *full = direct + (data_size - 16 + i);
+          HyScanComplexFloat *gate = result + (2 * image_size + 16 + i);
+
+          if (hypot (full->re - gate->re, full->im - gate->im) > 1e-4 * conv_scale)
+            g_error ("gated convolution mismatch at %u", data_size - 16 + i);
+        }
+
+      memset (data, 0, data_size * sizeof (HyScanComplexFloat));
+      memcpy (data + image_size, result, 2 * image_size * sizeof (HyScanComplexFloat));
+      memcpy (data + data_size - 16, result + 2 * image_size + 16, 16 * sizeof (HyScanComplexFloat));
+      amplitude_scale = conv_scale;
+
+      g_free (result);
+    }
+  else if (g_strcmp0 (output, "async") == 0)
+    {
+      HyScanComplexFloat *results[4];
+      ConvolutionAsyncJob jobs[4];
+      guint n_done = 0;
+
+      /* Ставим в очередь больше заданий, чем её размер. Задания сверх
+         размера очереди не принимаются, пока не будет получен результат
+         предыдущих. Все задания должны завершиться в порядке постановки. */
+      hyscan_convolution_set_queue_depth (convolution, 2);
+      for (i = 0; i < 4; i++)
+        {
+          jobs[i].job = i;
+          jobs[i].n_done = &n_done;
+          results[i] = g_new0 (HyScanComplexFloat, data_size);
+          if (hyscan_convolution_convolve_async (convolution, 0, data, results[i], data_size, conv_scale,
+                                                 NULL, convolution_async_ready, &jobs[i]) != (i < 2))
+            {
+              g_error ("async convolution queue overflow");
+            }
+        }
+
+      while (n_done < 2)
+        g_main_context_iteration (NULL, TRUE);
+
+      for (i = 2; i < 4; i++)
+        {
+          if (!hyscan_convolution_convolve_async (convolution, 0, data, results[i], data_size, conv_scale,
+                                                  NULL, convolution_async_ready, &jobs[i]))
+            {
+              g_error ("async convolution queue is full");
+            }
+        }
+
+      while (n_done < 4)
+        g_main_context_iteration (NULL, TRUE);
+
+      for (i = 1; i < 4; i++)
+        {
+          if (memcmp (results[0], results[i], data_size * sizeof (HyScanComplexFloat)) != 0)
+            g_error ("async convolution results mismatch");
+        }
+
+      memcpy (data, results[0], data_size * sizeof (HyScanComplexFloat));
+      amplitude_scale = conv_scale;
+
+      for (i = 0; i < 4; i++)
+        g_free (results[i]);
+    }
+  else if (g_strcmp0 (output, "peaks") == 0)
+    {
+      HyScanConvolutionPeak peaks[3];
+      guint n_found;
+
+      convolution_peaks_check ();
+
+      /* Наибольший пик свёртки должен находиться на 2 * signal_size. */
+      if (!hyscan_convolution_find_peaks (convolution, 0, data, data_size, conv_scale,
+                                          HYSCAN_CONVOLUTION_PEAK_GAUSSIAN, peaks, 3, &n_found))
+        g_error ("can't find peaks");
+
+      if ((n_found == 0) || (fabs (peaks[0].offset - 2 * image_size) > 0.5))
+        g_error ("wrong peak position %.3f", (n_found > 0) ? peaks[0].offset : -1.0);
+
+      g_message ("peak at %.3f, amplitude %.3f", peaks[0].offset, peaks[0].amplitude);
+
+      hyscan_convolution_convolve (convolution, 0, data, data_size, conv_scale);
+      amplitude_scale = conv_scale;
+    }
+  else if (g_strcmp0 (output, "doppler") == 0)
+    {
+      gdouble dopplers[5] = { 0.98, 0.99, 1.0, 1.01, 1.02 };
+      gdouble band = (g_strcmp0 (signal, "lfm") == 0) ? bandwidth : 0.0;
+      gfloat *map;
+      guint *best;
+
+      /* Банк образов с номерами 1 - 5, образ без доплеровского сдвига
+         имеет номер 3 и совпадает с основным образом. */
+      if (!hyscan_convolution_set_doppler_bank (convolution, 1, discretization,
+                                                frequency - (band / 2.0), frequency + (band / 2.0),
+                                                duration, dopplers, 5))
+        g_error ("can't set doppler bank");
+
+      map = g_new0 (gfloat, 5 * data_size);
+      best = g_new0 (guint, data_size);
+      if (!hyscan_convolution_convolve_bank (convolution, 1, 5, data, data_size, conv_scale, map, NULL, best))
+        g_error ("can't convolve doppler bank");
+
+      if (best[2 * image_size] != 2)
+        g_error ("wrong doppler index %u", best[2 * image_size]);
+
+      memcpy (envelope, map + 2 * data_size, data_size * sizeof (gfloat));
+      amplitude_scale = conv_scale;
+
+      g_free (map);
+      g_free (best);
+    }
+  else if (g_strcmp0 (output, "amplitude") == 0)
+    {
+      hyscan_convolution_convolve_amplitude (convolution, 0, data, envelope, data_size, conv_scale);
+      amplitude_scale = conv_scale;
+    }
+  else if (g_strcmp0 (output, "db") == 0)
+    {
+      hyscan_convolution_convolve_db (convolution, 0, data, envelope, data_size, conv_scale, -200.0);
+      for (i = 0; i < data_size; i++)
+        envelope[i] = pow (10.0, envelope[i] / 20.0);
+      amplitude_scale = conv_scale;
+    }
+  else
+    {
+      hyscan_convolution_convolve (convolution, 0, data, data_size, conv_scale);
+      amplitude_scale = conv_scale;
+    }
+
+  /* Амплитуда результата свёртки. */
+  if ((g_strcmp0 (output, "amplitude") != 0) && (g_strcmp0 (output, "db") != 0) &&
+      (g_strcmp0 (output, "doppler") != 0))
+    {
+      for (i = 0; i < (data_size + decimation - 1) / decimation; i++)
+        envelope[i] = sqrt (data[i].re * data[i].re + data[i].im * data[i].im);
+    }
+
+  /* Сравниваем результат с прямым вычислением свёртки. Комплексный результат
+     сравнивается целиком, для амплитуды сравнивается модуль. */
+  if (direct != NULL)
+    {
+      gboolean complex = (g_strcmp0 (output, "amplitude") != 0) && (g_strcmp0 (output, "db") != 0);
+      gdouble max_error = 0.0;
+
+      for (i = 0, j = 0; i < data_size; i += decimation, j++)
+        {
+          gdouble error;
+
+          if (complex)
+            error = hypot (data[j].re - direct[i].re, data[j].im - direct[i].im);
+          else
+            error = fabs (envelope[j] - hypot (direct[i].re, direct[i].im));
+
+          max_error = MAX (max_error, error);
+        }
+
+      if (max_error > 1e-4 * conv_scale)
+        g_error ("direct convolution mismatch %.3e", max_error);
+
+      g_message ("direct convolution error %.3e", max_error);
+    }
 
   /* Для тонального сигнала проверяем, что его свёртка совпадает с треугольником,
      начинающимся с signal_size, пиком на 2 * signal_size и спадающим до 3 * signal_size. */
@@ -123,53 +943,94 @@ main (int    argc,
         {
           if (j == 0)
             {
-              amplitude[i] = conv_scale;
+              amplitude[i] = amplitude_scale;
             }
           else
             {
-              amplitude[i + j] = conv_scale * (1.0 - (gfloat) j / image_size);
-              amplitude[i - j] = conv_scale * (1.0 - (gfloat) j / image_size);
+              amplitude[i + j] = amplitude_scale * (1.0 - (gfloat) j / image_size);
+              amplitude[i - j] = amplitude_scale * (1.0 - (gfloat) j / image_size);
             }
         }
     }
 
   /* Для ЛЧМ сигнала проверяем, что его свёртка совпадает с функцией sinc, симметричной
-     относительно 2 * signal_size. */
+     относительно 2 * signal_size. При сдвиге t перекрываются только (1 - t / T) части
+     сигналов, поэтому огибающая равна (1 - t / T) * sinc (pi * B * t * (1 - t / T)).
+     Для сигналов с большой базой это практически совпадает с sinc (pi * B * t), но для
+     коротких сигналов разница заметна. */
   else if (g_strcmp0 (signal, "lfm") == 0)
     {
       for (i = 2 * image_size, j = 0; j < image_size; j++)
         {
           gdouble time = j * (1.0 / discretization);
-          gdouble phase = 2.0 * G_PI * frequency * time;
-
-          phase = G_PI * time * bandwidth;
+          gdouble overlap = 1.0 - (gdouble) j / image_size;
+          gdouble phase = G_PI * time * bandwidth * overlap;
 
           if (j == 0)
             {
-              amplitude[i] = conv_scale;
+              amplitude[i] = amplitude_scale;
             }
           else
             {
-              amplitude[i + j] = conv_scale * fabs (sin (phase) / phase);
-              amplitude[i - j] = conv_scale * fabs (sin (phase) / phase);
+              amplitude[i + j] = amplitude_scale * overlap * fabs (sin (phase) / phase);
+              amplitude[i - j] = amplitude_scale * overlap * fabs (sin (phase) / phase);
             }
         }
 
     }
 
-  /* Разница между аналитическим видом свёртки и реально полученным. */
-  square1 = 0.0;
-  square2 = 0.0;
-  for (i = 0; i < data_size; i++)
+  /* Для остальных сигналов проверяем положение, амплитуду и ширину пика
+     свёртки по уровню -3 дБ. Пик должен находиться на 2 * signal_size. */
+  if (peak_width > 0.0)
     {
-      square1 += amplitude[i];
-      square2 += sqrt (data[i].re * data[i].re + data[i].im * data[i].im);
+      guint32 n_envelope = (data_size + decimation - 1) / decimation;
+      guint32 peak = 0;
+      gdouble left, right;
+      gdouble level;
+
+      for (i = 1; i < n_envelope; i++)
+        {
+          if (envelope[i] > envelope[peak])
+            peak = i;
+        }
+
+      if (peak * decimation != 2 * image_size)
+        g_error ("wrong peak position %u", peak * decimation);
+
+      if (fabs (envelope[peak] - amplitude_scale) > 0.01 * amplitude_scale)
+        g_error ("wrong peak amplitude %.3f", envelope[peak]);
+
+      /* Границы пика уточняются линейной интерполяцией. */
+      level = envelope[peak] / G_SQRT2;
+      for (i = peak; (i > 0) && (envelope[i - 1] > level); i--);
+      left = (i > 0) ? i - (envelope[i] - level) / (envelope[i] - envelope[i - 1]) : 0;
+      for (i = peak; (i + 1 < n_envelope) && (envelope[i + 1] > level); i++);
+      right = (i + 1 < n_envelope) ? i + (envelope[i] - level) / (envelope[i] - envelope[i + 1]) : i;
+
+      if (fabs ((right - left) * decimation - peak_width) > 0.1 * peak_width)
+        g_error ("wrong peak width %.1f, expected %.1f", (right - left) * decimation, peak_width);
+
+      g_message ("peak at %u, amplitude %.3f, width %.1f", peak * decimation, envelope[peak], (right - left) * decimation);
     }
 
-  if ((100.0 * (fabs (square1 - square2) / square1)) > conv_error)
-    g_error ("convolution error %.3f%% > %.3f%%", 100.0 * (fabs (square1 - square2) / square1), conv_error);
+  /* Разница между аналитическим видом свёртки и реально полученным. При
+     децимации сравниваются только отсчёты с шагом decimation. */
+  else
+    {
+      square1 = 0.0;
+      square2 = 0.0;
+      for (i = 0, j = 0; i < data_size; i += decimation, j++)
+        {
+          square1 += amplitude[i];
+          square2 += envelope[j];
+        }
+
+      if ((100.0 * (fabs (square1 - square2) / square1)) > conv_error)
+        g_error ("convolution error %.3f%% > %.3f%%", 100.0 * (fabs (square1 - square2) / square1), conv_error);
+
+      g_message ("convolution error %.3f%%", 100.0 * (fabs (square1 - square2) / square1));
+    }
 
-  g_message ("convolution error %.3f%%", 100.0 * (fabs (square1 - square2) / square1));
   g_message ("done");
 
   /* Удаляем объект свёртки. */
@@ -177,7 +1038,11 @@ main (int    argc,
 
   g_free (image);
   g_free (signal);
+  g_free (output);
   g_free (amplitude);
+  g_free (envelope);
+  g_free (direct);
+  g_free (decoy);
   g_free (data);
 
   return 0;
@@ -0,0 +1,172 @@
+/* ddc-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include <hyscan-ddc.h>
+#include <math.h>
+
+#define        DISC_FREQ       1000000.0
+#define        HETERODYNE      100000.0
+#define        N_POINTS        200000
+#define        MAX_PART        5000
+#define        MAX_ERROR       (1e-3)
+#define        MAX_PARTS_ERROR (1e-5)
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint decimations[] = {1, 2, 3, 8, 12, 40};
+  HyScanComplexFloat *output;
+  HyScanComplexFloat *whole;
+  gfloat *input;
+  HyScanDDC *ddc;
+  guint i;
+
+  g_random_set_seed (1);
+
+  input = g_new (gfloat, N_POINTS);
+  output = g_new (HyScanComplexFloat, N_POINTS);
+  whole = g_new (HyScanComplexFloat, N_POINTS);
+
+  ddc = hyscan_ddc_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (decimations); i++)
+    {
+      guint decimation = decimations[i];
+      gdouble data_rate = DISC_FREQ / decimation;
+      gdouble offset = 0.3 * data_rate;
+      gdouble interference = 0.7 * data_rate;
+      gdouble max_error = 0.0;
+      gdouble max_parts_error = 0.0;
+      gdouble delay;
+      guint32 n_out, n_whole;
+      guint32 start, n;
+      gdouble time;
+      GTimer *timer;
+
+      if (!hyscan_ddc_configure (ddc, DISC_FREQ, HETERODYNE, decimation))
+        g_error ("can't configure ddc");
+
+      if (hyscan_ddc_get_data_rate (ddc) != data_rate)
+        g_error ("data rate mismatch");
+
+      delay = hyscan_ddc_get_delay (ddc);
+
+      /* Полезный сигнал и помеха, которая при децимации попадает в полосу
+       * результата, если не будет подавлена фильтрами. */
+      for (n = 0; n < N_POINTS; n++)
+        {
+          gdouble t = n / DISC_FREQ;
+
+          input[n] = cos (2.0 * G_PI * (HETERODYNE + offset) * t);
+          if (decimation > 1)
+            input[n] += cos (2.0 * G_PI * (HETERODYNE + interference) * t);
+        }
+
+      /* Обработка частями случайного размера. */
+      for (start = 0, n_out = 0; start < N_POINTS; start += n)
+        {
+          guint32 n_expected;
+          guint32 n_processed;
+
+          n = g_random_int_range (1, MAX_PART);
+          n = MIN (n, N_POINTS - start);
+          n_expected = hyscan_ddc_get_output_size (ddc, n);
+          n_processed = hyscan_ddc_process (ddc, input + start, n, output + n_out);
+
+          if (n_processed != n_expected)
+            g_error ("output size mismatch: %u, expected %u", n_processed, n_expected);
+
+          n_out += n_processed;
+        }
+
+      if (n_out != (N_POINTS + decimation - 1) / decimation)
+        g_error ("total output size mismatch: %u", n_out);
+
+      /* Обработка одним вызовом. */
+      timer = g_timer_new ();
+      hyscan_ddc_reset (ddc);
+      n_whole = hyscan_ddc_process (ddc, input, N_POINTS, whole);
+      time = g_timer_elapsed (timer, NULL);
+      g_timer_destroy (timer);
+
+      if (n_whole != n_out)
+        g_error ("whole output size mismatch: %u", n_whole);
+
+      for (n = 0; n < n_out; n++)
+        {
+          gdouble phase = 2.0 * G_PI * offset * (n - delay) / data_rate;
+          gdouble re = cos (phase);
+          gdouble im = sin (phase);
+          gdouble error;
+
+          /* Без децимации остаётся зеркальная составляющая. */
+          if (decimation == 1)
+            {
+              gdouble mirror = -2.0 * G_PI * (2.0 * HETERODYNE + offset) * n / DISC_FREQ;
+
+              re += cos (mirror);
+              im += sin (mirror);
+            }
+
+          error = hypot (whole[n].re - output[n].re, whole[n].im - output[n].im);
+          max_parts_error = MAX (max_parts_error, error);
+
+          /* Пропускаем переходный процесс фильтров. */
+          if (n < 2.0 * delay + 2.0)
+            continue;
+
+          error = hypot (output[n].re - re, output[n].im - im);
+          max_error = MAX (max_error, error);
+        }
+
+      g_print ("decimation %u: delay %.2f, error %.2e, parts error %.2e, %.1f Msamples/s\n",
+               decimation, delay, max_error, max_parts_error, N_POINTS / time * 1e-6);
+
+      if (max_error > MAX_ERROR)
+        g_error ("output error too big");
+
+      if (max_parts_error > MAX_PARTS_ERROR)
+        g_error ("streaming error too big");
+    }
+
+  g_object_unref (ddc);
+
+  g_free (input);
+  g_free (output);
+  g_free (whole);
+
+  return 0;
+}
@@ -0,0 +1,252 @@
+/* filter-bank-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include <hyscan-filter-bank.h>
+#include <math.h>
+#include <string.h>
+
+#define        N_CHANNELS      5
+#define        N_POINTS        20000
+#define        MIN_PART        16
+#define        MAX_PART        10000
+#define        MAX_ERROR       (1e-4)
+
+/* Функция фильтрует один действительный поток прямым расчётом. */
+static void
+filter_reference (const gfloat       *input,
+                  gdouble            *output,
+                  guint               stride,
+                  const gfloat       *taps,
+                  guint               n_taps,
+                  const HyScanBiquad *sections,
+                  guint               n_sections)
+{
+  guint32 n;
+  guint k, s;
+
+  for (n = 0; n < N_POINTS; n++)
+    {
+      gdouble sum = 0.0;
+
+      if (n_taps == 0)
+        sum = input[n * stride];
+
+      for (k = 0; k < n_taps && k <= n; k++)
+        sum += taps[k] * (gdouble) input[(n - k) * stride];
+
+      output[n] = sum;
+    }
+
+  for (s = 0; s < n_sections; s++)
+    {
+      gdouble x1 = 0.0, x2 = 0.0, y1 = 0.0, y2 = 0.0;
+
+      for (n = 0; n < N_POINTS; n++)
+        {
+          gdouble x = output[n];
+          gdouble y = sections[s].b0 * x + sections[s].b1 * x1 + sections[s].b2 * x2 -
+                      sections[s].a1 * y1 - sections[s].a2 * y2;
+
+          x2 = x1;
+          x1 = x;
+          y2 = y1;
+          y1 = y;
+          output[n] = y;
+        }
+    }
+}
+
+/* Функция фильтрует данные частями случайного размера и возвращает
+ * относительную ошибку результата. */
+static gdouble
+filter_check (HyScanFilterBank   *bank,
+              gboolean            complex,
+              const gfloat       *taps,
+              guint               n_taps,
+              const HyScanBiquad *sections,
+              guint               n_sections,
+              gdouble            *speed)
+{
+  HyScanComplexFloat *complex_data[N_CHANNELS];
+  gfloat *real_data[N_CHANNELS];
+  gpointer data[N_CHANNELS];
+  gpointer parts[N_CHANNELS];
+  gdouble *reference;
+  gdouble max_error = 0.0;
+  gdouble max_value = 0.0;
+  guint n_streams = complex ? 2 * N_CHANNELS : N_CHANNELS;
+  guint stride = complex ? 2 : 1;
+  guint32 start, n;
+  GTimer *timer;
+  guint i;
+  guint c, s;
+
+  hyscan_filter_bank_set_fir (bank, taps, n_taps);
+  hyscan_filter_bank_set_iir (bank, sections, n_sections);
+
+  for (c = 0; c < N_CHANNELS; c++)
+    {
+      complex_data[c] = g_new (HyScanComplexFloat, N_POINTS);
+      real_data[c] = g_new (gfloat, N_POINTS);
+      data[c] = complex ? (gpointer) complex_data[c] : (gpointer) real_data[c];
+
+      for (n = 0; n < N_POINTS; n++)
+        {
+          complex_data[c][n].re = g_random_double_range (-1.0, 1.0);
+          complex_data[c][n].im = g_random_double_range (-1.0, 1.0);
+          real_data[c][n] = g_random_double_range (-1.0, 1.0);
+        }
+    }
+
+  reference = g_new (gdouble, n_streams * N_POINTS);
+  for (s = 0; s < n_streams; s++)
+    {
+      const gfloat *input = complex ? (gfloat *) complex_data[s / 2] + s % 2 : real_data[s];
+
+      filter_reference (input, reference + s * N_POINTS, stride, taps, n_taps, sections, n_sections);
+    }
+
+  /* Короткие части чередуются с длинными, чтобы длинный КИХ фильтр
+   * рассчитывался то во временной, то в частотной области. */
+  for (start = 0, i = 0; start < N_POINTS; start += n, i++)
+    {
+      n = g_random_int_range (1, (i % 2) ? MAX_PART : MIN_PART);
+      n = MIN (n, N_POINTS - start);
+
+      for (c = 0; c < N_CHANNELS; c++)
+        parts[c] = (gfloat *) data[c] + start * stride;
+
+      if (complex)
+        hyscan_filter_bank_process_complex (bank, (HyScanComplexFloat **) parts, n);
+      else
+        hyscan_filter_bank_process_real (bank, (gfloat **) parts, n);
+    }
+
+  for (s = 0; s < n_streams; s++)
+    {
+      const gfloat *output = complex ? (gfloat *) complex_data[s / 2] + s % 2 : real_data[s];
+
+      for (n = 0; n < N_POINTS; n++)
+        {
+          gdouble value = reference[s * N_POINTS + n];
+
+          max_error = MAX (max_error, fabs (output[n * stride] - value));
+          max_value = MAX (max_value, fabs (value));
+        }
+    }
+
+  /* Производительность при обработке одним вызовом. */
+  hyscan_filter_bank_reset (bank);
+  timer = g_timer_new ();
+  if (complex)
+    hyscan_filter_bank_process_complex (bank, (HyScanComplexFloat **) data, N_POINTS);
+  else
+    hyscan_filter_bank_process_real (bank, (gfloat **) data, N_POINTS);
+  *speed = n_streams * N_POINTS / g_timer_elapsed (timer, NULL) * 1e-6;
+  g_timer_destroy (timer);
+
+  for (c = 0; c < N_CHANNELS; c++)
+    {
+      g_free (complex_data[c]);
+      g_free (real_data[c]);
+    }
+  g_free (reference);
+
+  return max_error / max_value;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint n_taps[] = {0, 31, 301};
+  guint n_sections[] = {0, 2};
+  HyScanBiquad sections[2];
+  HyScanFilterBank *bank;
+  gdouble w0, alpha, a0;
+  gfloat *taps;
+  guint i, j, k;
+
+  g_random_set_seed (1);
+
+  /* ФНЧ Баттерворта второго порядка и фильтр постоянной составляющей. */
+  w0 = 2.0 * G_PI * 0.1;
+  alpha = sin (w0) / (2.0 * G_SQRT2 / 2.0);
+  a0 = 1.0 + alpha;
+  sections[0].b0 = (1.0 - cos (w0)) / 2.0 / a0;
+  sections[0].b1 = (1.0 - cos (w0)) / a0;
+  sections[0].b2 = (1.0 - cos (w0)) / 2.0 / a0;
+  sections[0].a1 = -2.0 * cos (w0) / a0;
+  sections[0].a2 = (1.0 - alpha) / a0;
+
+  sections[1].b0 = 1.0;
+  sections[1].b1 = -1.0;
+  sections[1].b2 = 0.0;
+  sections[1].a1 = -0.995;
+  sections[1].a2 = 0.0;
+
+  taps = g_new (gfloat, n_taps[G_N_ELEMENTS (n_taps) - 1]);
+  for (k = 0; k < n_taps[G_N_ELEMENTS (n_taps) - 1]; k++)
+    taps[k] = g_random_double_range (-0.1, 0.1);
+
+  bank = hyscan_filter_bank_new (N_CHANNELS);
+
+  for (i = 0; i < G_N_ELEMENTS (n_taps); i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (n_sections); j++)
+        {
+          gdouble complex_error, real_error;
+          gdouble complex_speed, real_speed;
+
+          if (n_taps[i] == 0 && n_sections[j] == 0)
+            continue;
+
+          complex_error = filter_check (bank, TRUE, taps, n_taps[i], sections, n_sections[j], &complex_speed);
+          real_error = filter_check (bank, FALSE, taps, n_taps[i], sections, n_sections[j], &real_speed);
+
+          g_print ("fir %u taps, iir %u sections: complex error %.2e, %.1f Msamples/s; "
+                   "real error %.2e, %.1f Msamples/s\n",
+                   n_taps[i], n_sections[j], complex_error, complex_speed, real_error, real_speed);
+
+          if ((complex_error > MAX_ERROR) || (real_error > MAX_ERROR))
+            g_error ("filter error too big");
+        }
+    }
+
+  g_object_unref (bank);
+  g_free (taps);
+
+  return 0;
+}
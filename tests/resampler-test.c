@@ -0,0 +1,178 @@
+/* resampler-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+
+#include <hyscan-resampler.h>
+#include <math.h>
+
+#define        N_POINTS        200000
+#define        MAX_PART        5000
+#define        MAX_ERROR       (1e-3)
+
+/* Функция обрабатывает данные частями случайного размера, проверяя число
+ * выходных отсчётов, затем повторно обрабатывает их одним вызовом и
+ * возвращает время этой обработки. */
+static gdouble
+resampler_run (HyScanResampler    *resampler,
+               HyScanComplexFloat *input,
+               HyScanComplexFloat *output,
+               gfloat             *real_input,
+               gfloat             *real_output,
+               guint32            *n_out)
+{
+  guint32 start, n;
+  GTimer *timer;
+  gdouble time;
+
+  for (start = 0, *n_out = 0; start < N_POINTS; start += n)
+    {
+      guint32 n_expected;
+      guint32 n_processed;
+
+      n = g_random_int_range (1, MAX_PART);
+      n = MIN (n, N_POINTS - start);
+
+      n_expected = hyscan_resampler_get_output_size (resampler, n);
+      if (input != NULL)
+        n_processed = hyscan_resampler_process_complex (resampler, input + start, n, output + *n_out);
+      else
+        n_processed = hyscan_resampler_process_real (resampler, real_input + start, n, real_output + *n_out);
+
+      if (n_processed != n_expected)
+        g_error ("output size mismatch: %u, expected %u", n_processed, n_expected);
+
+      *n_out += n_processed;
+    }
+
+  hyscan_resampler_reset (resampler);
+
+  timer = g_timer_new ();
+  if (input != NULL)
+    n = hyscan_resampler_process_complex (resampler, input, N_POINTS, output);
+  else
+    n = hyscan_resampler_process_real (resampler, real_input, N_POINTS, real_output);
+  time = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  hyscan_resampler_reset (resampler);
+
+  if (n != *n_out)
+    g_error ("whole output size mismatch: %u, expected %u", n, *n_out);
+
+  return time;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint ratios[][2] = {{1, 1}, {2, 1}, {1, 3}, {3, 2}, {2, 3}, {147, 160}, {160, 147}};
+  HyScanComplexFloat *input;
+  HyScanComplexFloat *output;
+  gfloat *real_input;
+  gfloat *real_output;
+  HyScanResampler *resampler;
+  guint i;
+
+  g_random_set_seed (1);
+
+  input = g_new (HyScanComplexFloat, N_POINTS);
+  real_input = g_new (gfloat, N_POINTS);
+  output = g_new (HyScanComplexFloat, 2 * N_POINTS);
+  real_output = g_new (gfloat, 2 * N_POINTS);
+
+  resampler = hyscan_resampler_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (ratios); i++)
+    {
+      guint interpolation = ratios[i][0];
+      guint decimation = ratios[i][1];
+      gdouble ratio = (gdouble) interpolation / decimation;
+      gdouble frequency = 0.3 * MIN (1.0, ratio);
+      gdouble max_error = 0.0;
+      gdouble max_real_error = 0.0;
+      gdouble time, real_time;
+      guint32 n_out, n_real_out;
+      gdouble delay;
+      guint32 n;
+
+      if (!hyscan_resampler_set_ratio (resampler, interpolation, decimation))
+        g_error ("can't set ratio");
+
+      delay = hyscan_resampler_get_delay (resampler);
+
+      for (n = 0; n < N_POINTS; n++)
+        {
+          input[n].re = cos (2.0 * G_PI * frequency * n);
+          input[n].im = sin (2.0 * G_PI * frequency * n);
+          real_input[n] = input[n].re;
+        }
+
+      time = resampler_run (resampler, input, output, NULL, NULL, &n_out);
+      real_time = resampler_run (resampler, NULL, NULL, real_input, real_output, &n_real_out);
+
+      if (n_out != n_real_out)
+        g_error ("real output size mismatch");
+
+      /* Пропускаем переходный процесс фильтра и отсчёты после конца данных. */
+      for (n = 2.0 * delay + 2.0; n + delay < (N_POINTS - 1) * ratio && n < n_out; n++)
+        {
+          gdouble phase = 2.0 * G_PI * frequency * (n - delay) / ratio;
+          gdouble error;
+
+          error = hypot (output[n].re - cos (phase), output[n].im - sin (phase));
+          max_error = MAX (max_error, error);
+
+          error = fabs (real_output[n] - cos (phase));
+          max_real_error = MAX (max_real_error, error);
+        }
+
+      g_print ("ratio %u/%u: %u points, delay %.2f, error %.2e, real error %.2e, "
+               "complex %.1f Msamples/s, real %.1f Msamples/s\n",
+               interpolation, decimation, n_out, delay, max_error, max_real_error,
+               N_POINTS / time * 1e-6, N_POINTS / real_time * 1e-6);
+
+      if ((max_error > MAX_ERROR) || (max_real_error > MAX_ERROR))
+        g_error ("output error too big");
+    }
+
+  g_object_unref (resampler);
+
+  g_free (input);
+  g_free (real_input);
+  g_free (output);
+  g_free (real_output);
+
+  return 0;
+}
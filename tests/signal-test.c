@@ -0,0 +1,452 @@
+/* signal-test.c
+ *
+ * Copyright 2020 Screen LLC
+ *
+ * This file is part of HyScanMath.
+ *
+ * HyScanMath is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanMath имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanMath на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-signal.h>
+#include <hyscan-signal-replica.h>
+#include <hyscan-convolution.h>
+#include <math.h>
+#include <string.h>
+
+#define        MAX_ERROR       (1e-6)
+#define        MAX_CONV_ERROR  (1e-4)
+
+/* Функция рассчитывает образ ЛЧМ сигнала прямым вычислением фазы. */
+static HyScanComplexFloat *
+signal_reference (gdouble discretization,
+                  gdouble start_frequency,
+                  gdouble end_frequency,
+                  gdouble duration,
+                  gdouble doppler,
+                  guint32 n_points)
+{
+  HyScanComplexFloat *image;
+  gdouble bandwidth = end_frequency - start_frequency;
+  guint32 i;
+
+  image = g_new0 (HyScanComplexFloat, n_points);
+
+  for (i = 0; i < n_points; i++)
+    {
+      gdouble time = doppler * i * (1.0 / discretization);
+      gdouble phase = 2.0 * G_PI * start_frequency * time + G_PI * bandwidth * time * time / duration;
+
+      image[i].re = cos (phase);
+      image[i].im = sin (phase);
+    }
+
+  return image;
+}
+
+/* Функция рассчитывает образ сигнала проверяемой функцией. */
+static HyScanComplexFloat *
+signal_image (gdouble  discretization,
+              gdouble  start_frequency,
+              gdouble  end_frequency,
+              gdouble  duration,
+              gdouble  doppler,
+              guint32 *n_points)
+{
+  if (doppler != 1.0)
+    {
+      return hyscan_signal_image_lfm_doppler (discretization, start_frequency, end_frequency,
+                                              duration, doppler, n_points);
+    }
+
+  if (start_frequency == end_frequency)
+    return hyscan_signal_image_tone (discretization, start_frequency, duration, n_points);
+
+  return hyscan_signal_image_lfm (discretization, start_frequency, end_frequency, duration, n_points);
+}
+
+/* Функция возвращает образ сигнала из кэша. */
+static HyScanSignalReplica *
+signal_replica (gdouble discretization,
+                gdouble start_frequency,
+                gdouble end_frequency,
+                gdouble duration,
+                gdouble doppler)
+{
+  if (doppler != 1.0)
+    return hyscan_signal_replica_doppler (discretization, start_frequency, end_frequency, duration, doppler);
+
+  if (start_frequency == end_frequency)
+    return hyscan_signal_replica_tone (discretization, start_frequency, duration);
+
+  return hyscan_signal_replica_lfm (discretization, start_frequency, end_frequency, duration);
+}
+
+/* Функция возвращает спектр сигнала из кэша. */
+static HyScanSignalReplica *
+signal_spectrum (gdouble discretization,
+                 gdouble start_frequency,
+                 gdouble end_frequency,
+                 gdouble duration,
+                 gdouble doppler,
+                 guint32 fft_size)
+{
+  if (doppler != 1.0)
+    return hyscan_signal_spectrum_doppler (discretization, start_frequency, end_frequency, duration, doppler, fft_size);
+
+  if (start_frequency == end_frequency)
+    return hyscan_signal_spectrum_tone (discretization, start_frequency, duration, fft_size);
+
+  return hyscan_signal_spectrum_lfm (discretization, start_frequency, end_frequency, duration, fft_size);
+}
+
+/* Функция сравнивает свёртку с образом во временной области и свёртку
+ * с его спектром. Возвращает относительную ошибку. */
+static gdouble
+signal_spectrum_check (const HyScanComplexFloat *image,
+                       guint32                   n_points,
+                       HyScanSignalReplica      *spectrum,
+                       GRand                    *rand)
+{
+  HyScanConvolution *convolution;
+  const HyScanComplexFloat *spectrum_data;
+  HyScanComplexFloat *data_td;
+  HyScanComplexFloat *data_fd;
+  guint32 fft_size;
+  guint32 data_size;
+  gdouble max_value = 0.0;
+  gdouble max_error = 0.0;
+  guint32 i;
+
+  spectrum_data = hyscan_signal_replica_get_data (spectrum, &fft_size);
+
+  convolution = hyscan_convolution_new ();
+  if (!hyscan_convolution_set_image_td (convolution, 0, image, n_points) ||
+      !hyscan_convolution_set_image_fd (convolution, 1, spectrum_data, fft_size))
+    {
+      g_error ("can't set convolution image");
+    }
+
+  data_size = 4 * fft_size;
+  data_td = g_new (HyScanComplexFloat, data_size);
+  data_fd = g_new (HyScanComplexFloat, data_size);
+  for (i = 0; i < data_size; i++)
+    {
+      data_td[i].re = data_fd[i].re = g_rand_double_range (rand, -1.0, 1.0);
+      data_td[i].im = data_fd[i].im = g_rand_double_range (rand, -1.0, 1.0);
+    }
+
+  if (!hyscan_convolution_convolve (convolution, 0, data_td, data_size, 1.0) ||
+      !hyscan_convolution_convolve (convolution, 1, data_fd, data_size, 1.0))
+    {
+      g_error ("can't convolve data");
+    }
+
+  for (i = 0; i < data_size; i++)
+    {
+      gdouble re = data_td[i].re - data_fd[i].re;
+      gdouble im = data_td[i].im - data_fd[i].im;
+
+      max_value = MAX (max_value, hypot (data_td[i].re, data_td[i].im));
+      max_error = MAX (max_error, hypot (re, im));
+    }
+
+  g_object_unref (convolution);
+  g_free (data_td);
+  g_free (data_fd);
+
+  return max_error / max_value;
+}
+
+/* Функция запрашивает образ ЛЧМ сигнала из отдельного потока. */
+static gpointer
+signal_replica_thread (gpointer data)
+{
+  return hyscan_signal_replica_lfm (1000000.0, 100000.0, 150000.0, 0.05);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gboolean benchmark = FALSE;
+  GRand *rand;
+  guint n;
+
+  /* Параметры сигналов: частота дискретизации, начальная и конечная
+   * частоты, длительность и доплеровский коэффициент. */
+  gdouble signals[][5] = { { 1000000.0, 100000.0, 100000.0, 0.1,   1.0   },
+                           { 1000000.0, 100000.0, 120000.0, 0.1,   1.0   },
+                           { 1000000.0, 120000.0,  80000.0, 0.1,   1.0   },
+                           {  150000.0,  -5000.0,   5000.0, 0.5,   1.0   },
+                           { 1000000.0,  37123.0,  37123.0, 1.0,   1.0   },
+                           { 1000000.0,  37123.0,  37123.0, 0.01,  1.0   },
+                           {   48000.0,   1000.0,  10000.0, 0.001, 1.0   },
+                           { 1000000.0, 100000.0, 120000.0, 0.1,   1.003 },
+                           { 1000000.0, 100000.0, 120000.0, 0.1,   0.997 } };
+
+  /* Разбор командной строки. */
+  {
+    gchar **args;
+    GError *error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] =
+      {
+        { "benchmark", 'b', 0, G_OPTION_ARG_NONE, &benchmark, "Benchmark signal generation", NULL },
+        { NULL }
+      };
+
+#ifdef G_OS_WIN32
+    args = g_win32_get_command_line ();
+#else
+    args = g_strdupv (argv);
+#endif
+
+    context = g_option_context_new ("");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, FALSE);
+    if (!g_option_context_parse_strv (context, &args, &error))
+      {
+        g_print ("%s\n", error->message);
+        return -1;
+      }
+
+    g_option_context_free (context);
+    g_strfreev (args);
+  }
+
+  rand = g_rand_new_with_seed (1);
+
+  for (n = 0; n < G_N_ELEMENTS (signals); n++)
+    {
+      gdouble discretization = signals[n][0];
+      gdouble start_frequency = signals[n][1];
+      gdouble end_frequency = signals[n][2];
+      gdouble duration = signals[n][3];
+      gdouble doppler = signals[n][4];
+      HyScanComplexFloat *image;
+      HyScanComplexFloat *reference;
+      HyScanSignalReplica *replica1;
+      HyScanSignalReplica *replica2;
+      HyScanSignalReplica *spectrum;
+      const HyScanComplexFloat *data;
+      guint32 replica_n_points;
+      guint32 fft_size;
+      gdouble conv_error = 0.0;
+      gdouble max_error = 0.0;
+      guint32 n_points;
+      guint32 i;
+
+      image = signal_image (discretization, start_frequency, end_frequency,
+                            duration, doppler, &n_points);
+      reference = signal_reference (discretization, start_frequency, end_frequency,
+                                    duration, doppler, n_points);
+
+      for (i = 0; i < n_points; i++)
+        {
+          gdouble re = image[i].re - reference[i].re;
+          gdouble im = image[i].im - reference[i].im;
+
+          max_error = MAX (max_error, sqrt (re * re + im * im));
+        }
+
+      /* Свёртка со спектром из кэша. */
+      fft_size = hyscan_convolution_get_fft_size (2 * n_points);
+      if (fft_size > 0)
+        {
+          spectrum = signal_spectrum (discretization, start_frequency, end_frequency,
+                                      duration, doppler, fft_size);
+          if (spectrum == NULL)
+            g_error ("can't get signal spectrum");
+
+          conv_error = signal_spectrum_check (image, n_points, spectrum, rand);
+          g_object_unref (spectrum);
+        }
+
+      g_print ("signal %.0f - %.0f Hz, %.3f s, doppler %.3f, %u points: error %.2e, spectrum error %.2e",
+               start_frequency, end_frequency, duration, doppler, n_points, max_error, conv_error);
+
+      if (benchmark)
+        {
+          GTimer *timer = g_timer_new ();
+          guint n_runs = MAX (1, 10000000 / n_points);
+          gdouble reference_time;
+          gdouble image_time;
+          guint j;
+
+          for (j = 0; j < n_runs; j++)
+            g_free (signal_reference (discretization, start_frequency, end_frequency,
+                                      duration, doppler, n_points));
+          reference_time = g_timer_elapsed (timer, NULL);
+
+          g_timer_start (timer);
+          for (j = 0; j < n_runs; j++)
+            g_free (signal_image (discretization, start_frequency, end_frequency,
+                                  duration, doppler, &n_points));
+          image_time = g_timer_elapsed (timer, NULL);
+
+          g_print (", reference %.3f ms, recurrence %.3f ms, speedup %.1f",
+                   1000.0 * reference_time / n_runs, 1000.0 * image_time / n_runs,
+                   reference_time / image_time);
+
+          g_timer_destroy (timer);
+        }
+
+      g_print ("\n");
+
+      if (max_error > MAX_ERROR)
+        g_error ("signal error %.2e", max_error);
+      if (conv_error > MAX_CONV_ERROR)
+        g_error ("spectrum error %.2e", conv_error);
+
+      /* Образ из кэша совпадает с рассчитанным и разделяется между
+       * пользователями. */
+      replica1 = signal_replica (discretization, start_frequency, end_frequency, duration, doppler);
+      replica2 = signal_replica (discretization, start_frequency, end_frequency, duration, doppler);
+      if (replica1 != replica2)
+        g_error ("replica is not shared");
+
+      data = hyscan_signal_replica_get_data (replica1, &replica_n_points);
+      if ((replica_n_points != n_points) || (memcmp (data, image, n_points * sizeof (HyScanComplexFloat)) != 0))
+        g_error ("replica mismatch");
+      if (((gsize) data % 16) != 0)
+        g_error ("replica is not aligned");
+
+      g_object_unref (replica1);
+      g_object_unref (replica2);
+
+      g_free (image);
+      g_free (reference);
+    }
+
+  /* Образ в буфере пользователя дополняется нулями или обрезается. */
+  {
+    HyScanComplexFloat *image;
+    HyScanComplexFloat *buffer;
+    guint32 n_points;
+    guint32 i;
+
+    image = hyscan_signal_image_nlfm (1000000.0, 90000.0, 110000.0, 0.01, 0.54, &n_points);
+    buffer = g_new (HyScanComplexFloat, 2 * n_points);
+    memset (buffer, 0xff, 2 * n_points * sizeof (HyScanComplexFloat));
+
+    if (hyscan_signal_fill_nlfm (1000000.0, 90000.0, 110000.0, 0.01, 0.54, NULL, 0) != n_points)
+      g_error ("fill size mismatch");
+
+    hyscan_signal_fill_nlfm (1000000.0, 90000.0, 110000.0, 0.01, 0.54, buffer, 2 * n_points);
+    if (memcmp (buffer, image, n_points * sizeof (HyScanComplexFloat)) != 0)
+      g_error ("fill mismatch");
+    for (i = n_points; i < 2 * n_points; i++)
+      {
+        if ((buffer[i].re != 0.0) || (buffer[i].im != 0.0))
+          g_error ("fill padding mismatch");
+      }
+
+    memset (buffer, 0xff, 2 * n_points * sizeof (HyScanComplexFloat));
+    hyscan_signal_fill_nlfm (1000000.0, 90000.0, 110000.0, 0.01, 0.54, buffer, n_points / 2);
+    if ((memcmp (buffer, image, (n_points / 2) * sizeof (HyScanComplexFloat)) != 0) ||
+        (buffer[n_points / 2].re == buffer[n_points / 2].re))
+      {
+        g_error ("fill truncation mismatch");
+      }
+
+    g_free (image);
+    g_free (buffer);
+  }
+
+  /* Неиспользуемый образ остаётся в кэше, пока не превышен лимит. При
+   * нулевом лимите используемый образ остаётся в кэше, неиспользуемый
+   * удаляется. */
+  {
+    HyScanSignalReplica *replica1;
+    HyScanSignalReplica *replica2;
+    gsize size1 = 10000 * sizeof (HyScanComplexFloat);
+    gsize size2 = 20000 * sizeof (HyScanComplexFloat);
+    gsize cache_size;
+
+    hyscan_signal_cache_set_size (0);
+    if (hyscan_signal_cache_get_size () != 0)
+      g_error ("unused replicas are not evicted");
+    hyscan_signal_cache_set_size (size1 + size2);
+
+    replica1 = hyscan_signal_replica_lfm (1000000.0, 100000.0, 120000.0, 0.01);
+    replica2 = hyscan_signal_replica_lfm (1000000.0, 100000.0, 120000.0, 0.02);
+    g_object_unref (replica2);
+
+    cache_size = hyscan_signal_cache_get_size ();
+    if (cache_size != size1 + size2)
+      g_error ("unused replica is evicted below the limit (%" G_GSIZE_FORMAT " bytes)", cache_size);
+
+    hyscan_signal_cache_set_size (0);
+
+    cache_size = hyscan_signal_cache_get_size ();
+    if (cache_size != size1)
+      g_error ("wrong cache size %" G_GSIZE_FORMAT " bytes", cache_size);
+
+    replica2 = hyscan_signal_replica_lfm (1000000.0, 100000.0, 120000.0, 0.01);
+    if (replica1 != replica2)
+      g_error ("used replica is evicted");
+
+    g_object_unref (replica1);
+    g_object_unref (replica2);
+
+    cache_size = hyscan_signal_cache_get_size ();
+    if (cache_size != 0)
+      g_error ("released replica is not evicted (%" G_GSIZE_FORMAT " bytes)", cache_size);
+  }
+
+  /* Образ, одновременно запрошенный из нескольких потоков, рассчитывается
+   * без блокировки кэша, но все потоки получают один и тот же объект. */
+  {
+    HyScanSignalReplica *replicas[8];
+    GThread *threads[8];
+
+    hyscan_signal_cache_set_size (64 * 1024 * 1024);
+
+    for (n = 0; n < G_N_ELEMENTS (threads); n++)
+      threads[n] = g_thread_new ("replica", signal_replica_thread, NULL);
+
+    for (n = 0; n < G_N_ELEMENTS (threads); n++)
+      replicas[n] = g_thread_join (threads[n]);
+
+    for (n = 0; n < G_N_ELEMENTS (threads); n++)
+      {
+        if ((replicas[n] == NULL) || (replicas[n] != replicas[0]))
+          g_error ("replica is not shared between threads");
+      }
+
+    for (n = 0; n < G_N_ELEMENTS (threads); n++)
+      g_object_unref (replicas[n]);
+  }
+
+  g_rand_free (rand);
+
+  g_message ("done");
+
+  return 0;
+}